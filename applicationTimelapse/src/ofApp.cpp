@@ -124,6 +124,7 @@ void ofApp::setup() {
 	}
 
 	this->cameraDevice->open();
+	this->cameraDevice->setDownloadMode(ofxCanon::Device::DownloadMode::DownloadToFile);
 	ofAddListener(this->cameraDevice->onUnrequestedPhotoReceived, this, & ofApp::callbackPhotoReceived);
 	this->newSession();
 }
@@ -171,6 +172,10 @@ void ofApp::takePhoto() {
 
 	this->cameraDevice->setDownloadEnabled(this->parameters.downloadPhoto.get());
 
+	// the photo is streamed straight into the session folder whilst downloading
+	this->cameraDevice->setDownloadFileTemplate(this->getSessionFolder() + "/{index}.jpg");
+	this->cameraDevice->setDownloadFileIndex(this->parameters.photoIndex.get());
+
 	//press shutter
 	if (this->parameters.downloadPhoto) {
 		EdsUInt32 saveTo = kEdsSaveTo_Host;
@@ -285,27 +290,8 @@ void ofApp::dragEvent(ofDragInfo dragInfo) {
 void ofApp::callbackPhotoReceived(ofxCanon::Device::PhotoCaptureResult & photoResult) {
 	if (photoResult) {
 		if (this->parameters.downloadPhoto) {
-			ofLoadImage(this->preview.getPixels(), *photoResult.encodedBuffer);
-
-			auto directoryName = this->getSessionFolder();
-
-			//make directory if it doesn't exist
-			{
-				ofDirectory::createDirectory(directoryName, true, true);
-			}
-
-			//save the file
-			{
-				string filenameTrunk = ofToString(this->parameters.photoIndex.get());
-				while (filenameTrunk.size() < 6) {
-					filenameTrunk = "0" + filenameTrunk;
-				}
-
-				ofFile file;
-				file.open(directoryName + "/" + filenameTrunk + ".jpg", ofFile::WriteOnly, true);
-				file << *photoResult.encodedBuffer;
-				file.close();
-			}
+			//the file has already been saved by the device during download
+			ofLoadImage(this->preview.getPixels(), photoResult.savedFilePath);
 
 			//increment photo index
 			{
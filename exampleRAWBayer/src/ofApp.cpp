@@ -122,13 +122,19 @@ void ofApp::takePhoto() {
 
 	auto result = future.get();
 	if (result) {
-		ofImageLoadSettings imageLoadSettings;
-		{
-			imageLoadSettings.freeImageFlags = RAW_UNPROCESSED;
+		// Take the sensor mosaic straight from a CR2 where we can, otherwise go through FreeImage
+		if (this->rawDecoder.decode(*result.encodedBuffer)) {
+			this->image.setFromPixels(this->rawDecoder.getPixels());
+		}
+		else {
+			ofImageLoadSettings imageLoadSettings;
+			{
+				imageLoadSettings.freeImageFlags = RAW_UNPROCESSED;
+			}
+			ofxCanon::loadImage(this->image.getPixels()
+				, *result.encodedBuffer
+				, imageLoadSettings);
 		}
-		ofLoadImage(this->image.getPixels()
-			, *result.encodedBuffer
-			, imageLoadSettings);
 
 		if (this->parameters.normalize) {
 			auto& pixels = this->image.getPixels();
@@ -32,6 +32,7 @@ public:
 	ofShortImage result;
 
 	shared_ptr<ofxCanon::Device> device;
+	ofxCanon::RawDecoder rawDecoder;
 
 	ofxCvGui::Builder gui;
 
@@ -39,6 +39,13 @@ void ofApp::draw() {
 			(int)camera.getFrameRate() << " cam-fps / " <<
 			(camera.getBandwidth() / (1 << 20)) << " MiB/s";
 		ofDrawBitmapString(status.str(), 10, 20);
+
+		auto loopStats = camera.getLoopStats();
+		stringstream loopStatus;
+		loopStatus << "camera thread : " << (int)(loopStats.busyFraction * 100.0f) << "% busy / " <<
+			loopStats.iterations << " iterations / " <<
+			loopStats.liveViewPollsNotReady << " of " << loopStats.liveViewPolls << " live view polls empty";
+		ofDrawBitmapString(loopStatus.str(), 10, 40);
 	}
 }
 
@@ -5,6 +5,19 @@
 #include "FreeImage.h"
 
 #include <future>
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE4_1__) || defined(__AVX__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64)))
+#	define MONO_DEBAYER_SSE
+#	include <smmintrin.h>
+#endif
+
+// processRawMono works in bands of rows with about this much scratch memory per colour plane
+#define MONO_DEBAYER_BAND_BYTES (1 << 20)
+#define MONO_DEBAYER_BYTES_PER_PIXEL 10 // two plane rows (16 bit), a masked row (16 bit) and a row sum (32 bit)
 
 enum class BayerColor {
 	Green = 0
@@ -25,6 +38,705 @@ BayerColor getBayerColor(int x, int y) {
 	}
 }
 
+#pragma mark Mono debayer kernel
+//----------
+// processRawMono works through the image in bands of rows, spread over OpenCV's thread pool. For each band it dilates
+// and blurs each colour plane in scratch rows sized to stay in cache, then applies the factors to the band in place.
+// Every step rounds exactly like the OpenCV functions it replaces (cv::dilate, cv::blur on 16 bit, then float
+// division / multiplication and saturate_cast back to 16 bit), so the result is identical to the full frame version.
+struct MonoDebayerScratch {
+	std::vector<uint16_t> planes[3][2]; // ping-pong rows per BayerColor
+	std::vector<uint16_t> masked; // mosaic rows with the other colours set to 0
+	std::vector<uint16_t> maxRow;
+	std::vector<uint16_t> zeroRow;
+	std::vector<uint32_t> rowSums;
+};
+
+// Unmodified mosaic rows which neighbouring bands read, copied before any band writes its results
+struct MonoDebayerSource {
+	const uint16_t * image;
+	size_t stride; // in pixels
+	int width;
+	int height;
+	int bandHeight;
+	int haloRows;
+	std::vector<uint16_t> boundaryRows; // haloRows either side of each boundary between bands
+
+	//----------
+	const uint16_t * getRow(int y, int bandStart, int bandEnd) const {
+		if (y >= bandStart && y < bandEnd) {
+			return this->image + y * this->stride;
+		}
+
+		// the boundary nearest to this row (the band's start or end)
+		auto boundary = y < bandStart ? bandStart : bandEnd;
+		auto boundaryIndex = boundary / this->bandHeight - 1;
+		auto rowInBoundary = y - (boundary - this->haloRows);
+		return this->boundaryRows.data() + ((size_t)boundaryIndex * 2 * this->haloRows + rowInBoundary) * this->width;
+	}
+};
+
+//----------
+// -1 : no sites of this colour on this row, 0 : sites on even x, 1 : sites on odd x (see getBayerColor)
+int getBayerSiteParity(BayerColor color, int y) {
+	switch (color) {
+	case BayerColor::Red:
+		return y % 2 == 0 ? 0 : -1;
+	case BayerColor::Blue:
+		return y % 2 == 1 ? 1 : -1;
+	case BayerColor::Green:
+	default:
+		return y % 2 == 0 ? 1 : 0;
+	}
+}
+
+//----------
+void maskBayerRow(const uint16_t * in, uint16_t * out, int width, int siteParity) {
+	if (siteParity < 0) {
+		std::fill(out, out + width, (uint16_t)0);
+		return;
+	}
+
+	int x = 0;
+#ifdef MONO_DEBAYER_SSE
+	auto mask = siteParity == 0
+		? _mm_set1_epi32(0x0000FFFF)
+		: _mm_set1_epi32((int)0xFFFF0000);
+	for (; x + 8 <= width; x += 8) {
+		auto values = _mm_loadu_si128((const __m128i *) (in + x));
+		_mm_storeu_si128((__m128i *) (out + x), _mm_and_si128(values, mask));
+	}
+#endif
+	for (; x < width; x++) {
+		out[x] = (x & 1) == siteParity ? in[x] : 0;
+	}
+}
+
+//----------
+// out[x] = max(in[x - 1], in[x], in[x + 1]), pixels outside the image are ignored
+void max3BayerRow(const uint16_t * in, uint16_t * out, int width) {
+	if (width == 1) {
+		out[0] = in[0];
+		return;
+	}
+
+	out[0] = std::max(in[0], in[1]);
+	int x = 1;
+#ifdef MONO_DEBAYER_SSE
+	for (; x + 9 <= width; x += 8) {
+		auto left = _mm_loadu_si128((const __m128i *) (in + x - 1));
+		auto centre = _mm_loadu_si128((const __m128i *) (in + x));
+		auto right = _mm_loadu_si128((const __m128i *) (in + x + 1));
+		_mm_storeu_si128((__m128i *) (out + x), _mm_max_epu16(_mm_max_epu16(left, centre), right));
+	}
+#endif
+	for (; x < width - 1; x++) {
+		out[x] = std::max(std::max(in[x - 1], in[x]), in[x + 1]);
+	}
+	out[width - 1] = std::max(in[width - 2], in[width - 1]);
+}
+
+//----------
+// out[x] = max(a[x], b[x], c[x])
+void max3BayerRows(const uint16_t * a, const uint16_t * b, const uint16_t * c, uint16_t * out, int width) {
+	int x = 0;
+#ifdef MONO_DEBAYER_SSE
+	for (; x + 8 <= width; x += 8) {
+		auto valuesA = _mm_loadu_si128((const __m128i *) (a + x));
+		auto valuesB = _mm_loadu_si128((const __m128i *) (b + x));
+		auto valuesC = _mm_loadu_si128((const __m128i *) (c + x));
+		_mm_storeu_si128((__m128i *) (out + x), _mm_max_epu16(_mm_max_epu16(valuesA, valuesB), valuesC));
+	}
+#endif
+	for (; x < width; x++) {
+		out[x] = std::max(std::max(a[x], b[x]), c[x]);
+	}
+}
+
+//----------
+// Sum of in[x - 1] + in[x] + in[x + 1], reflecting at the edges (cv::BORDER_REFLECT_101, as used by cv::blur)
+void sum3BayerRow(const uint16_t * in, uint32_t * out, int width) {
+	if (width == 1) {
+		out[0] = 3 * (uint32_t)in[0];
+		return;
+	}
+
+	out[0] = (uint32_t)in[0] + 2 * (uint32_t)in[1];
+	int x = 1;
+#ifdef MONO_DEBAYER_SSE
+	auto zero = _mm_setzero_si128();
+	for (; x + 9 <= width; x += 8) {
+		auto left = _mm_loadu_si128((const __m128i *) (in + x - 1));
+		auto centre = _mm_loadu_si128((const __m128i *) (in + x));
+		auto right = _mm_loadu_si128((const __m128i *) (in + x + 1));
+		auto sumLow = _mm_add_epi32(_mm_add_epi32(_mm_unpacklo_epi16(left, zero), _mm_unpacklo_epi16(centre, zero)), _mm_unpacklo_epi16(right, zero));
+		auto sumHigh = _mm_add_epi32(_mm_add_epi32(_mm_unpackhi_epi16(left, zero), _mm_unpackhi_epi16(centre, zero)), _mm_unpackhi_epi16(right, zero));
+		_mm_storeu_si128((__m128i *) (out + x), sumLow);
+		_mm_storeu_si128((__m128i *) (out + x + 4), sumHigh);
+	}
+#endif
+	for (; x < width - 1; x++) {
+		out[x] = (uint32_t)in[x - 1] + (uint32_t)in[x] + (uint32_t)in[x + 1];
+	}
+	out[width - 1] = 2 * (uint32_t)in[width - 2] + (uint32_t)in[width - 1];
+}
+
+//----------
+// out[x] = round((a[x] + b[x] + c[x]) / 9), i.e. the 3x3 mean of cv::blur on 16 bit images
+void mean3BayerRows(const uint32_t * a, const uint32_t * b, const uint32_t * c, uint16_t * out, int width) {
+	int x = 0;
+#ifdef MONO_DEBAYER_SSE
+	// Sums are at most 9 * 65535, so (sum + 4.5) / 9 in float is never closer than 0.05 to an integer and truncates correctly
+	auto offset = _mm_set1_ps(4.5f);
+	auto ninth = _mm_set1_ps(1.0f / 9.0f);
+	for (; x + 8 <= width; x += 8) {
+		auto sumLow = _mm_add_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i *) (a + x)), _mm_loadu_si128((const __m128i *) (b + x))), _mm_loadu_si128((const __m128i *) (c + x)));
+		auto sumHigh = _mm_add_epi32(_mm_add_epi32(_mm_loadu_si128((const __m128i *) (a + x + 4)), _mm_loadu_si128((const __m128i *) (b + x + 4))), _mm_loadu_si128((const __m128i *) (c + x + 4)));
+		auto meanLow = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_cvtepi32_ps(sumLow), offset), ninth));
+		auto meanHigh = _mm_cvttps_epi32(_mm_mul_ps(_mm_add_ps(_mm_cvtepi32_ps(sumHigh), offset), ninth));
+		_mm_storeu_si128((__m128i *) (out + x), _mm_packus_epi32(meanLow, meanHigh));
+	}
+#endif
+	for (; x < width; x++) {
+		out[x] = (uint16_t)((a[x] + b[x] + c[x] + 4) / 9);
+	}
+}
+
+//----------
+// Same as cv::saturate_cast<ushort>(float) : round to nearest even, NaN or beyond the range of int gives 0
+uint16_t saturateBayerValue(float value) {
+	if (!(value >= -2147483648.0f && value < 2147483648.0f)) {
+		return 0;
+	}
+	auto rounded = (int)std::nearbyint(value);
+	return (uint16_t)std::min(std::max(rounded, 0), 65535);
+}
+
+//----------
+// Multiply the sites of one colour by green / colour (the other pixels are green and keep their value)
+void applyBayerFactorRow(uint16_t * row, const uint16_t * green, const uint16_t * color, int width, int siteParity) {
+	int x = 0;
+#ifdef MONO_DEBAYER_SSE
+	auto zero = _mm_setzero_si128();
+	auto siteMask = siteParity == 0
+		? _mm_set1_epi32(0x0000FFFF)
+		: _mm_set1_epi32((int)0xFFFF0000);
+	for (; x + 8 <= width; x += 8) {
+		auto values = _mm_loadu_si128((const __m128i *) (row + x));
+		auto greenValues = _mm_loadu_si128((const __m128i *) (green + x));
+		auto colorValues = _mm_loadu_si128((const __m128i *) (color + x));
+
+		// cvtps rounds to nearest even and gives INT_MIN for NaN / inf, which packus saturates to 0 (as saturate_cast)
+		auto factorLow = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(greenValues, zero)), _mm_cvtepi32_ps(_mm_unpacklo_epi16(colorValues, zero)));
+		auto factorHigh = _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(greenValues, zero)), _mm_cvtepi32_ps(_mm_unpackhi_epi16(colorValues, zero)));
+		auto resultLow = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(values, zero)), factorLow));
+		auto resultHigh = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(values, zero)), factorHigh));
+		auto result = _mm_packus_epi32(resultLow, resultHigh);
+
+		result = _mm_or_si128(_mm_and_si128(siteMask, result), _mm_andnot_si128(siteMask, values));
+		_mm_storeu_si128((__m128i *) (row + x), result);
+	}
+#endif
+	for (; x < width; x++) {
+		if ((x & 1) == siteParity) {
+			auto factor = (float)green[x] / (float)color[x];
+			row[x] = saturateBayerValue((float)row[x] * factor);
+		}
+	}
+}
+
+//----------
+void processRawMonoBand(uint16_t * image, const MonoDebayerSource & source, int bandStart, int bandEnd, int dilateIterations, MonoDebayerScratch & scratch) {
+	auto width = source.width;
+	auto height = source.height;
+
+	// Each blur needs one more row either side
+	auto start = std::max(0, bandStart - dilateIterations);
+	auto end = std::min(height, bandEnd + dilateIterations);
+
+	// Masked rows start - 1 ... end (the dilation reads one row either side)
+	auto maskedStart = std::max(0, start - 1);
+	auto maskedEnd = std::min(height, end + 1);
+
+	scratch.masked.resize((size_t)(maskedEnd - maskedStart) * width);
+	scratch.maxRow.resize(width);
+	scratch.zeroRow.assign(width, 0);
+	scratch.rowSums.resize((size_t)(end - start) * width);
+
+	for (auto color : { BayerColor::Red, BayerColor::Green, BayerColor::Blue }) {
+		auto & plane = scratch.planes[(int)color][0];
+		auto & nextPlane = scratch.planes[(int)color][1];
+		plane.resize((size_t)(end - start) * width);
+		nextPlane.resize((size_t)(end - start) * width);
+
+		// extract the plane
+		for (int y = maskedStart; y < maskedEnd; y++) {
+			maskBayerRow(source.getRow(y, bandStart, bandEnd)
+				, scratch.masked.data() + (size_t)(y - maskedStart) * width
+				, width
+				, getBayerSiteParity(color, y));
+		}
+		auto getMaskedRow = [&](int y) {
+			return y < 0 || y >= height
+				? scratch.zeroRow.data()
+				: scratch.masked.data() + (size_t)(y - maskedStart) * width;
+		};
+
+		// dilate (3x3 cross for green, 3x3 box for red and blue)
+		for (int y = start; y < end; y++) {
+			auto out = plane.data() + (size_t)(y - start) * width;
+			if (color == BayerColor::Green) {
+				max3BayerRow(getMaskedRow(y), scratch.maxRow.data(), width);
+				max3BayerRows(scratch.maxRow.data(), getMaskedRow(y - 1), getMaskedRow(y + 1), out, width);
+			}
+			else {
+				max3BayerRows(getMaskedRow(y - 1), getMaskedRow(y), getMaskedRow(y + 1), scratch.maxRow.data(), width);
+				max3BayerRow(scratch.maxRow.data(), out, width);
+			}
+		}
+
+		// blur, the rows which are valid shrink by one at each side of the band (unless it's the image edge)
+		auto validStart = start;
+		auto validEnd = end;
+		for (int i = 0; i < dilateIterations; i++) {
+			for (int y = validStart; y < validEnd; y++) {
+				sum3BayerRow(plane.data() + (size_t)(y - start) * width
+					, scratch.rowSums.data() + (size_t)(y - start) * width
+					, width);
+			}
+
+			auto nextStart = validStart == 0 ? 0 : validStart + 1;
+			auto nextEnd = validEnd == height ? height : validEnd - 1;
+			auto reflect = [height](int y) {
+				if (height == 1) {
+					return 0;
+				}
+				return y < 0
+					? -y
+					: y >= height
+						? 2 * height - 2 - y
+						: y;
+			};
+			for (int y = nextStart; y < nextEnd; y++) {
+				mean3BayerRows(scratch.rowSums.data() + (size_t)(reflect(y - 1) - start) * width
+					, scratch.rowSums.data() + (size_t)(y - start) * width
+					, scratch.rowSums.data() + (size_t)(reflect(y + 1) - start) * width
+					, nextPlane.data() + (size_t)(y - start) * width
+					, width);
+			}
+
+			std::swap(plane, nextPlane);
+			validStart = nextStart;
+			validEnd = nextEnd;
+		}
+	}
+
+	// apply green / red on red sites and green / blue on blue sites
+	for (int y = bandStart; y < bandEnd; y++) {
+		auto color = y % 2 == 0 ? BayerColor::Red : BayerColor::Blue;
+		auto green = scratch.planes[(int)BayerColor::Green][0].data() + (size_t)(y - start) * width;
+		auto colorRow = scratch.planes[(int)color][0].data() + (size_t)(y - start) * width;
+		applyBayerFactorRow(image + y * source.stride, green, colorRow, width, getBayerSiteParity(color, y));
+	}
+}
+
+//----------
+void processRawMonoBands(uint16_t * image, size_t stride, int width, int height, int dilateIterations) {
+	if (width <= 0 || height <= 0) {
+		return;
+	}
+	dilateIterations = std::max(dilateIterations, 0);
+
+	MonoDebayerSource source;
+	source.image = image;
+	source.stride = stride;
+	source.width = width;
+	source.height = height;
+	source.haloRows = dilateIterations + 1;
+	source.bandHeight = std::max(MONO_DEBAYER_BAND_BYTES / (width * MONO_DEBAYER_BYTES_PER_PIXEL), 4 * source.haloRows);
+
+	// Keep a copy of the rows around each boundary, since the band on the other side reads them after they've been written
+	{
+		auto boundaryCount = (height - 1) / source.bandHeight;
+		source.boundaryRows.resize((size_t)boundaryCount * 2 * source.haloRows * width);
+		cv::parallel_for_(cv::Range(0, boundaryCount), [&](const cv::Range & boundaries) {
+			for (int boundaryIndex = boundaries.start; boundaryIndex < boundaries.end; boundaryIndex++) {
+				auto boundary = (boundaryIndex + 1) * source.bandHeight;
+				for (int i = 0; i < 2 * source.haloRows; i++) {
+					auto y = boundary - source.haloRows + i;
+					if (y >= 0 && y < height) {
+						std::copy(image + y * stride
+							, image + y * stride + width
+							, source.boundaryRows.begin() + ((size_t)boundaryIndex * 2 * source.haloRows + i) * width);
+					}
+				}
+			}
+		});
+	}
+
+	// A few runs of bands per thread, each run reuses one set of scratch rows
+	auto bandCount = (height + source.bandHeight - 1) / source.bandHeight;
+	auto stripeCount = std::min(bandCount, std::max(cv::getNumThreads(), 1) * 4);
+	cv::parallel_for_(cv::Range(0, bandCount), [&](const cv::Range & bands) {
+		MonoDebayerScratch scratch;
+		for (int band = bands.start; band < bands.end; band++) {
+			auto bandStart = band * source.bandHeight;
+			auto bandEnd = std::min(bandStart + source.bandHeight, height);
+			processRawMonoBand(image, source, bandStart, bandEnd, dilateIterations, scratch);
+		}
+	}, stripeCount);
+}
+
+#pragma mark Adaptive normalize kernel
+//----------
+// adaptiveNormalize finds the max and min around each pixel with separable running filters (van Herk / Gil-Werman),
+// which cost the same per pixel whatever the window size. cv::dilate / cv::erode with a 5x5 rectangle repeated n times
+// give the same as a (4n + 1) square window clipped to the image, so the result is identical to the iterated version.
+#define ADAPTIVE_NORMALIZE_MIN_STRIP_WIDTH 1024 // columns filtered together in the vertical pass (wider is quicker)
+#define ADAPTIVE_NORMALIZE_ROW_GROUP 8 // rows filtered together in the horizontal pass
+
+//----------
+inline void maxLanes(uint16_t * target, const uint16_t * source, int lanes) {
+	int lane = 0;
+#ifdef MONO_DEBAYER_SSE
+	for (; lane + 8 <= lanes; lane += 8) {
+		auto a = _mm_loadu_si128((const __m128i *)(target + lane));
+		auto b = _mm_loadu_si128((const __m128i *)(source + lane));
+		_mm_storeu_si128((__m128i *)(target + lane), _mm_max_epu16(a, b));
+	}
+#endif
+	for (; lane < lanes; lane++) {
+		target[lane] = std::max(target[lane], source[lane]);
+	}
+}
+
+//----------
+inline void minLanes(uint16_t * target, const uint16_t * source, int lanes) {
+	int lane = 0;
+#ifdef MONO_DEBAYER_SSE
+	for (; lane + 8 <= lanes; lane += 8) {
+		auto a = _mm_loadu_si128((const __m128i *)(target + lane));
+		auto b = _mm_loadu_si128((const __m128i *)(source + lane));
+		_mm_storeu_si128((__m128i *)(target + lane), _mm_min_epu16(a, b));
+	}
+#endif
+	for (; lane < lanes; lane++) {
+		target[lane] = std::min(target[lane], source[lane]);
+	}
+}
+
+//----------
+inline void maxLanes(uint8_t * target, const uint8_t * source, int lanes) {
+	int lane = 0;
+#ifdef MONO_DEBAYER_SSE
+	for (; lane + 16 <= lanes; lane += 16) {
+		auto a = _mm_loadu_si128((const __m128i *)(target + lane));
+		auto b = _mm_loadu_si128((const __m128i *)(source + lane));
+		_mm_storeu_si128((__m128i *)(target + lane), _mm_max_epu8(a, b));
+	}
+#endif
+	for (; lane < lanes; lane++) {
+		target[lane] = std::max(target[lane], source[lane]);
+	}
+}
+
+//----------
+inline void minLanes(uint8_t * target, const uint8_t * source, int lanes) {
+	int lane = 0;
+#ifdef MONO_DEBAYER_SSE
+	for (; lane + 16 <= lanes; lane += 16) {
+		auto a = _mm_loadu_si128((const __m128i *)(target + lane));
+		auto b = _mm_loadu_si128((const __m128i *)(source + lane));
+		_mm_storeu_si128((__m128i *)(target + lane), _mm_min_epu8(a, b));
+	}
+#endif
+	for (; lane < lanes; lane++) {
+		target[lane] = std::min(target[lane], source[lane]);
+	}
+}
+
+#ifdef MONO_DEBAYER_SSE
+//----------
+// 8 values widened to 16 bit
+__m128i loadAdaptiveNormalizeValues(const uint16_t * values) {
+	return _mm_loadu_si128((const __m128i *)values);
+}
+
+//----------
+__m128i loadAdaptiveNormalizeValues(const uint8_t * values) {
+	return _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i *)values));
+}
+#endif
+
+//----------
+// out = in * 255 / (max - min) as 8 bit, with float rounding and saturation like cv::Mat::convertTo
+template<typename T>
+void adaptiveNormalizeRow(const T * in, const T * maximum, const T * minimum, uint8_t * out, int width) {
+	int x = 0;
+#ifdef MONO_DEBAYER_SSE
+	// division by a 0 range gives inf / nan here, which convert to 0x80000000 and saturate to 0 (as cvRound does)
+	const auto scale = _mm_set1_ps(255.0f);
+	const auto zero = _mm_setzero_si128();
+	for (; x + 8 <= width; x += 8) {
+		auto values = loadAdaptiveNormalizeValues(in + x);
+		auto range = _mm_sub_epi16(loadAdaptiveNormalizeValues(maximum + x), loadAdaptiveNormalizeValues(minimum + x));
+		auto low = _mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(values, zero)), scale)
+			, _mm_cvtepi32_ps(_mm_unpacklo_epi16(range, zero)));
+		auto high = _mm_div_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(values, zero)), scale)
+			, _mm_cvtepi32_ps(_mm_unpackhi_epi16(range, zero)));
+		auto result = _mm_packs_epi32(_mm_cvtps_epi32(low), _mm_cvtps_epi32(high));
+		_mm_storel_epi64((__m128i *)(out + x), _mm_packus_epi16(result, result));
+	}
+#endif
+	for (; x < width; x++) {
+		auto range = maximum[x] - minimum[x];
+
+		// the float division gives inf / nan where the range is 0, which converts to 0
+		out[x] = range > 0
+			? cv::saturate_cast<uint8_t>((float)in[x] * 255.0f / (float)range)
+			: 0;
+	}
+}
+
+//----------
+// Gather rows into lanes (value x of every row together)
+template<typename T>
+void rowsToLanes(const T * const * rows, int lanes, T * values, int width) {
+	for (int x = 0; x < width; x++) {
+		for (int lane = 0; lane < lanes; lane++) {
+			values[x * lanes + lane] = rows[lane][x];
+		}
+	}
+}
+
+//----------
+// Scatter lanes back into rows
+template<typename T>
+void lanesToRows(const T * values, int lanes, T * const * rows, int width) {
+	for (int x = 0; x < width; x++) {
+		for (int lane = 0; lane < lanes; lane++) {
+			rows[lane][x] = values[x * lanes + lane];
+		}
+	}
+}
+
+#ifdef MONO_DEBAYER_SSE
+//----------
+// Swap rows and columns of an 8x8 block
+void transpose8x8(__m128i (&v)[8]) {
+	auto a0 = _mm_unpacklo_epi16(v[0], v[1]);
+	auto a1 = _mm_unpackhi_epi16(v[0], v[1]);
+	auto a2 = _mm_unpacklo_epi16(v[2], v[3]);
+	auto a3 = _mm_unpackhi_epi16(v[2], v[3]);
+	auto a4 = _mm_unpacklo_epi16(v[4], v[5]);
+	auto a5 = _mm_unpackhi_epi16(v[4], v[5]);
+	auto a6 = _mm_unpacklo_epi16(v[6], v[7]);
+	auto a7 = _mm_unpackhi_epi16(v[6], v[7]);
+	auto b0 = _mm_unpacklo_epi32(a0, a2);
+	auto b1 = _mm_unpackhi_epi32(a0, a2);
+	auto b2 = _mm_unpacklo_epi32(a1, a3);
+	auto b3 = _mm_unpackhi_epi32(a1, a3);
+	auto b4 = _mm_unpacklo_epi32(a4, a6);
+	auto b5 = _mm_unpackhi_epi32(a4, a6);
+	auto b6 = _mm_unpacklo_epi32(a5, a7);
+	auto b7 = _mm_unpackhi_epi32(a5, a7);
+	v[0] = _mm_unpacklo_epi64(b0, b4);
+	v[1] = _mm_unpackhi_epi64(b0, b4);
+	v[2] = _mm_unpacklo_epi64(b1, b5);
+	v[3] = _mm_unpackhi_epi64(b1, b5);
+	v[4] = _mm_unpacklo_epi64(b2, b6);
+	v[5] = _mm_unpackhi_epi64(b2, b6);
+	v[6] = _mm_unpacklo_epi64(b3, b7);
+	v[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+//----------
+void rowsToLanes(const uint16_t * const * rows, int lanes, uint16_t * values, int width) {
+	if (lanes != 8) {
+		rowsToLanes<uint16_t>(rows, lanes, values, width);
+		return;
+	}
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m128i v[8];
+		for (int lane = 0; lane < 8; lane++) {
+			v[lane] = _mm_loadu_si128((const __m128i *)(rows[lane] + x));
+		}
+		transpose8x8(v);
+		for (int i = 0; i < 8; i++) {
+			_mm_storeu_si128((__m128i *)(values + (x + i) * 8), v[i]);
+		}
+	}
+	for (; x < width; x++) {
+		for (int lane = 0; lane < 8; lane++) {
+			values[x * 8 + lane] = rows[lane][x];
+		}
+	}
+}
+
+//----------
+void lanesToRows(const uint16_t * values, int lanes, uint16_t * const * rows, int width) {
+	if (lanes != 8) {
+		lanesToRows<uint16_t>(values, lanes, rows, width);
+		return;
+	}
+	int x = 0;
+	for (; x + 8 <= width; x += 8) {
+		__m128i v[8];
+		for (int i = 0; i < 8; i++) {
+			v[i] = _mm_loadu_si128((const __m128i *)(values + (x + i) * 8));
+		}
+		transpose8x8(v);
+		for (int lane = 0; lane < 8; lane++) {
+			_mm_storeu_si128((__m128i *)(rows[lane] + x), v[lane]);
+		}
+	}
+	for (; x < width; x++) {
+		for (int lane = 0; lane < 8; lane++) {
+			rows[lane][x] = values[x * 8 + lane];
+		}
+	}
+}
+#endif
+
+//----------
+// Max and min of each lane over values i - radius to i + radius, clipped to 0...count - 1.
+// The lanes of value i are contiguous from maxInput + i * inputStep (likewise for minInput and the outputs).
+// FixedLanes lets the compiler work on a few lanes (e.g. a group of rows) without looping.
+template<typename T, int FixedLanes = 0>
+void runningMaxMin(const T * maxInput, const T * minInput, size_t inputStep
+	, T * maxOutput, T * minOutput, size_t outputStep
+	, int count, int lanes, int radius, std::vector<T> & running) {
+	if (FixedLanes > 0) {
+		lanes = FixedLanes;
+	}
+
+	// The values are padded with radius either side and split into blocks the size of the window. The suffix runs
+	// backwards through each block and the prefix forwards, so the window starting at padded p is suffix[p] and
+	// prefix[p + 2 * radius]. The suffixes are kept in the outputs until they're replaced by the result.
+	const T lowest = 0;
+	const T highest = std::numeric_limits<T>::max();
+	const int blockSize = 2 * radius + 1;
+	const int paddedCount = count + 2 * radius;
+	running.resize((size_t)lanes * 2);
+	auto maxRunning = running.data();
+	auto minRunning = running.data() + lanes;
+
+	// Each block starts from nothing, and takes in the values which are inside the image
+	auto restart = [&]() {
+		std::fill(maxRunning, maxRunning + lanes, lowest);
+		std::fill(minRunning, minRunning + lanes, highest);
+	};
+	auto accumulate = [&](int p) {
+		auto i = p - radius;
+		if (i >= 0 && i < count) {
+			maxLanes(maxRunning, maxInput + i * inputStep, lanes);
+			minLanes(minRunning, minInput + i * inputStep, lanes);
+		}
+	};
+
+	// Suffixes (only those which start a window are kept)
+	for (int blockStart = 0; blockStart < count; blockStart += blockSize) {
+		auto blockEnd = std::min(blockStart + blockSize, paddedCount);
+		restart();
+		for (int p = blockEnd - 1; p >= blockStart; p--) {
+			accumulate(p);
+			if (p < count) {
+				std::copy(maxRunning, maxRunning + lanes, maxOutput + p * outputStep);
+				std::copy(minRunning, minRunning + lanes, minOutput + p * outputStep);
+			}
+		}
+	}
+
+	// Prefixes, each ending the window which starts 2 * radius before
+	for (int blockStart = 0; blockStart < paddedCount; blockStart += blockSize) {
+		auto blockEnd = std::min(blockStart + blockSize, paddedCount);
+		restart();
+		for (int p = blockStart; p < blockEnd; p++) {
+			accumulate(p);
+			auto i = p - 2 * radius;
+			if (i >= 0) {
+				maxLanes(maxOutput + i * outputStep, maxRunning, lanes);
+				minLanes(minOutput + i * outputStep, minRunning, lanes);
+			}
+		}
+	}
+}
+
+//----------
+// output = input * 255 / (max - min) over the window, as 8 bit
+template<typename T>
+void adaptiveNormalizeImage(const cv::Mat & input, cv::Mat & output, int radius) {
+	const int width = input.cols;
+	const int height = input.rows;
+
+	// Vertical pass in strips of columns (one per thread), into frames of column max / min (kept for the next call)
+	thread_local cv::Mat columnMaximumBuffer;
+	thread_local cv::Mat columnMinimumBuffer;
+	columnMaximumBuffer.create(height, width, input.type());
+	columnMinimumBuffer.create(height, width, input.type());
+	auto columnMaximum = columnMaximumBuffer; // (headers of our thread's buffers for the workers)
+	auto columnMinimum = columnMinimumBuffer;
+	auto stripCount = std::max(std::min(cv::getNumThreads(), width / ADAPTIVE_NORMALIZE_MIN_STRIP_WIDTH), 1);
+	auto stripWidth = (width + stripCount - 1) / stripCount;
+	cv::parallel_for_(cv::Range(0, stripCount), [&](const cv::Range & strips) {
+		std::vector<T> running;
+		for (int strip = strips.start; strip < strips.end; strip++) {
+			auto x = strip * stripWidth;
+			runningMaxMin(input.ptr<T>() + x, input.ptr<T>() + x, input.step1()
+				, columnMaximum.ptr<T>() + x, columnMinimum.ptr<T>() + x, columnMaximum.step1()
+				, height, std::min(stripWidth, width - x), radius, running);
+		}
+	}, stripCount);
+
+	// Horizontal pass in groups of rows, with the rows of a group as lanes. The division is fused in.
+	output.create(height, width, CV_8UC1);
+	auto groupCount = (height + ADAPTIVE_NORMALIZE_ROW_GROUP - 1) / ADAPTIVE_NORMALIZE_ROW_GROUP;
+	cv::parallel_for_(cv::Range(0, groupCount), [&](const cv::Range & groups) {
+		std::vector<T> running;
+		std::vector<T> lanesIn[2];
+		std::vector<T> lanesOut[2];
+		std::vector<T> results[2];
+		for (auto buffer : { &lanesIn[0], &lanesIn[1], &lanesOut[0], &lanesOut[1], &results[0], &results[1] }) {
+			buffer->resize((size_t)width * ADAPTIVE_NORMALIZE_ROW_GROUP);
+		}
+
+		for (int group = groups.start; group < groups.end; group++) {
+			auto y = group * ADAPTIVE_NORMALIZE_ROW_GROUP;
+			auto lanes = std::min(ADAPTIVE_NORMALIZE_ROW_GROUP, height - y);
+			const T * maxRows[ADAPTIVE_NORMALIZE_ROW_GROUP];
+			const T * minRows[ADAPTIVE_NORMALIZE_ROW_GROUP];
+			T * maxResults[ADAPTIVE_NORMALIZE_ROW_GROUP];
+			T * minResults[ADAPTIVE_NORMALIZE_ROW_GROUP];
+			for (int lane = 0; lane < lanes; lane++) {
+				maxRows[lane] = columnMaximum.ptr<T>(y + lane);
+				minRows[lane] = columnMinimum.ptr<T>(y + lane);
+				maxResults[lane] = results[0].data() + lane * width;
+				minResults[lane] = results[1].data() + lane * width;
+			}
+
+			rowsToLanes(maxRows, lanes, lanesIn[0].data(), width);
+			rowsToLanes(minRows, lanes, lanesIn[1].data(), width);
+			if (lanes == ADAPTIVE_NORMALIZE_ROW_GROUP) {
+				runningMaxMin<T, ADAPTIVE_NORMALIZE_ROW_GROUP>(lanesIn[0].data(), lanesIn[1].data(), lanes
+					, lanesOut[0].data(), lanesOut[1].data(), lanes
+					, width, lanes, radius, running);
+			}
+			else {
+				runningMaxMin(lanesIn[0].data(), lanesIn[1].data(), lanes
+					, lanesOut[0].data(), lanesOut[1].data(), lanes
+					, width, lanes, radius, running);
+			}
+			lanesToRows(lanesOut[0].data(), lanes, maxResults, width);
+			lanesToRows(lanesOut[1].data(), lanes, minResults, width);
+
+			for (int lane = 0; lane < lanes; lane++) {
+				adaptiveNormalizeRow(input.ptr<T>(y + lane), maxResults[lane], minResults[lane], output.ptr<uint8_t>(y + lane), width);
+			}
+		}
+	});
+}
+
 namespace ofxMachineVision {
 	namespace Device {
 		//----------
@@ -43,6 +755,7 @@ namespace ofxMachineVision {
 			this->customParameters.normalizePercentile = make_shared<ofxMachineVision::Parameter<float>>(ofParameter<float>("Normalize %", 0.99, 0, 1));
 			this->customParameters.normalizeIgnoreTop = make_shared<ofxMachineVision::Parameter<float>>(ofParameter<float>("Normalize ignore top %", 0.01, 0, 1));
 			this->customParameters.normalizeTo = make_shared<ofxMachineVision::Parameter<float>>(ofParameter<float>("Normalize to", 0.5, 0, 1));
+			this->customParameters.normalizeMethod = make_shared<ofxMachineVision::Parameter<int>>(ofParameter<int>("Normalize method", (int)NormalizeMethod::Histogram, (int)NormalizeMethod::Histogram, (int)NormalizeMethod::Sampled));
 			this->customParameters.adaptiveNormalize = make_shared<ofxMachineVision::Parameter<bool>>(ofParameter<bool>("Adaptive normalize", false));
 			this->customParameters.adaptiveNormalizeWindowSize = make_shared<ofxMachineVision::Parameter<float>>(ofParameter<float>("Adaptive normalize window size", 0.2f));
 
@@ -59,6 +772,7 @@ namespace ofxMachineVision {
 					, this->customParameters.normalizePercentile
 					, this->customParameters.normalizeIgnoreTop
 					, this->customParameters.normalizeTo
+					, this->customParameters.normalizeMethod
 					, this->customParameters.adaptiveNormalize
 					, this->customParameters.adaptiveNormalizeWindowSize
 				});
@@ -233,7 +947,8 @@ namespace ofxMachineVision {
 					normalize(frame->getPixels()
 						, this->customParameters.normalizePercentile->getParameterTyped<float>()->get()
 						, this->customParameters.normalizeIgnoreTop->getParameterTyped<float>()->get()
-						, this->customParameters.normalizeTo->getParameterTyped<float>()->get());
+						, this->customParameters.normalizeTo->getParameterTyped<float>()->get()
+						, (NormalizeMethod)this->customParameters.normalizeMethod->getParameterTyped<int>()->get());
 				}
 			}
 
@@ -241,25 +956,39 @@ namespace ofxMachineVision {
 			else {
 				ofShortPixels rawPixels;
 
-				// Load the raw pixels from the image 
-				ofImageLoadSettings imageLoadSettings;
-				{
-					imageLoadSettings.freeImageFlags = RAW_UNPROCESSED;
-				}
 				auto buffer = this->camera->getPhotoCaptureResult().encodedBuffer;
 				if (!buffer) {
 					throw(ofxMachineVision::Exception("No buffer available from camera"));
 				}
-				ofLoadImage(rawPixels
-					, *buffer
-					, imageLoadSettings);
+
+				// Take the sensor mosaic straight from a CR2 (rawPixels is a view onto the decoder's buffer)
+				if (ofxCanon::RawDecoder::getFormat(buffer->getData(), buffer->size()) == ofxCanon::RawDecoder::Format::CR2
+					&& this->rawDecoder.decode(*buffer)) {
+					auto & mosaicPixels = this->rawDecoder.getPixels();
+					rawPixels.setFromExternalPixels(mosaicPixels.getData()
+						, mosaicPixels.getWidth()
+						, mosaicPixels.getHeight()
+						, OF_PIXELS_GRAY);
+				}
+
+				// Otherwise load the raw pixels from the image through FreeImage
+				else {
+					ofImageLoadSettings imageLoadSettings;
+					{
+						imageLoadSettings.freeImageFlags = RAW_UNPROCESSED;
+					}
+					ofxCanon::loadImage(rawPixels
+						, *buffer
+						, imageLoadSettings);
+				}
 
 				//normalize before processing
 				if (this->customParameters.normalize->getParameterTyped<bool>()->get()) {
 					normalize(rawPixels
 						, this->customParameters.normalizePercentile->getParameterTyped<float>()->get()
 						, this->customParameters.normalizeIgnoreTop->getParameterTyped<float>()->get()
-						, this->customParameters.normalizeTo->getParameterTyped<float>()->get());
+						, this->customParameters.normalizeTo->getParameterTyped<float>()->get()
+						, (NormalizeMethod)this->customParameters.normalizeMethod->getParameterTyped<int>()->get());
 				}
 
 				//perform the process of mono debayering based on neighborhood white balance
@@ -297,139 +1026,19 @@ namespace ofxMachineVision {
 
 		//----------
 		void Canon::processRawMono(const cv::Mat & image, int dilateIterations) {
-			auto width = image.cols;
-			auto height = image.rows;
-
-			//create masks for red, green, blue planes
-			cv::Mat redMask(height, width, CV_8U);
-			cv::Mat greenMask(height, width, CV_8U);
-			cv::Mat blueMask(height, width, CV_8U);
-			{
-				redMask.setTo(cv::Scalar(0));
-				greenMask.setTo(cv::Scalar(0));
-				blueMask.setTo(cv::Scalar(0));
-
-				auto redOut = redMask.data;
-				auto greenOut = greenMask.data;
-				auto blueOut = blueMask.data;
-
-				for (size_t y = 0; y < height; ++y) {
-					for (size_t x = 0; x < width; ++x) {
-						auto color = getBayerColor(x, y);
-						switch (color) {
-						case BayerColor::Red:
-							*redOut = 255;
-							break;
-						case BayerColor::Green:
-							*greenOut = 255;
-							break;
-						case BayerColor::Blue:
-							*blueOut = 255;
-							break;
-						}
-
-						redOut++;
-						greenOut++;
-						blueOut++;
-					}
-				}
+			if (image.empty()) {
+				return;
 			}
-
-			//extract red, green, blue planes
-			cv::Mat redPlane(height, width, CV_16U);
-			cv::Mat greenPlane(height, width, CV_16U);
-			cv::Mat bluePlane(height, width, CV_16U);
-			{
-				redPlane.setTo(cv::Scalar(0));
-				greenPlane.setTo(cv::Scalar(0));
-				bluePlane.setTo(cv::Scalar(0));
-
-				cv::copyTo(image, redPlane, redMask);
-				cv::copyTo(image, greenPlane, greenMask);
-				cv::copyTo(image, bluePlane, blueMask);
-			}
-
-			//dilate the planes
-			{
-				auto crossKernel = cv::getStructuringElement(cv::MORPH_CROSS, cv::Size(3, 3));
-				auto boxKernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
-				auto doRed = std::async(std::launch::async, [&]() {
-					cv::dilate(redPlane, redPlane, boxKernel);
-					});
-				auto doGreen = std::async(std::launch::async, [&]() {
-					cv::dilate(greenPlane, greenPlane, crossKernel);
-					});
-				auto doBlue = std::async(std::launch::async, [&]() {
-					cv::dilate(bluePlane, bluePlane, boxKernel);
-					});
-
-				doRed.wait();
-				doGreen.wait();
-				doBlue.wait();
-			}
-
-			//take local maxima for the color planes
-			{
-				auto kernelSize = cv::Size(3, 3);
-				for (int i = 0; i < dilateIterations; i++) {
-					auto doRed = std::async(std::launch::async, [&]() {
-						cv::blur(redPlane, redPlane, kernelSize);
-						});
-
-					auto doGreen = std::async(std::launch::async, [&]() {
-						cv::blur(greenPlane, greenPlane, kernelSize);
-						});
-
-					auto doBlue = std::async(std::launch::async, [&]() {
-						cv::blur(bluePlane, bluePlane, kernelSize);
-						});
-
-					doRed.wait();
-					doGreen.wait();
-					doBlue.wait();
-				}
-			}
-
-			//promote resolution to float for each plane
-			cv::Mat redPlaneFloat, greenPlaneFloat, bluePlaneFloat;
-			{
-				auto doRed = std::async(std::launch::async, [&]() {
-					redPlane.convertTo(redPlaneFloat, CV_32F);
-					});
-				auto doGreen = std::async(std::launch::async, [&]() {
-					greenPlane.convertTo(greenPlaneFloat, CV_32F);
-					});
-				auto doBlue = std::async(std::launch::async, [&]() {
-					bluePlane.convertTo(bluePlaneFloat, CV_32F);
-					});
-
-				doRed.wait();
-				doGreen.wait();
-				doBlue.wait();
+			if (image.type() != CV_16UC1) {
+				throw(ofxMachineVision::Exception("processRawMono requires a 16 bit single channel image"));
 			}
 
-			//create factors as planes
-			cv::Mat redFactor, blueFactor;
-			{
-				redFactor = greenPlaneFloat / redPlaneFloat;
-				blueFactor = greenPlaneFloat / bluePlaneFloat;
-			}
-
-			//mask copy the factors back into a combined factor plane
-			cv::Mat factor(height, width, CV_32F);
-			{
-				factor.setTo(cv::Scalar(1.0f));
-				cv::copyTo(redFactor, factor, redMask);
-				cv::copyTo(blueFactor, factor, blueMask);
-			}
-
-			//apply the factor plane and copy back into the original image
-			{
-				cv::Mat resultFloat;
-				image.convertTo(resultFloat, CV_32F);
-				resultFloat = resultFloat.mul(factor);
-				resultFloat.convertTo(image, CV_16U);
-			}
+			// The dilate, blur, divide and multiply steps run fused in cache sized bands, in place
+			processRawMonoBands((uint16_t *)image.data
+				, image.step1()
+				, image.cols
+				, image.rows
+				, dilateIterations);
 		}
 
 		//---------
@@ -438,37 +1047,22 @@ namespace ofxMachineVision {
 				throw(ofxMachineVision::Exception("Empty image passed into adaptiveNormalize"));
 			}
 
-			//get minimum and maximum images
+			// The window is the area a 5x5 box dilated / eroded this many times would cover
 			auto kernelSize = 5;
-			auto boxKernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(kernelSize, kernelSize));
 			int iterations = (float)input.cols * windowSize / kernelSize;
-			auto maximum = input.clone();
-			auto minimum = input.clone();
-			auto doMaximum = std::thread([&]() {
-				cv::dilate(maximum
-					, maximum
-					, boxKernel
-					, cv::Point(-1, -1)
-					, iterations);
-				});
-			auto doMinimum = std::thread([&]() {
-				cv::erode(minimum
-					, minimum
-					, boxKernel
-					, cv::Point(-1, -1)
-					, iterations);
-				});
-			doMinimum.join();
-			doMaximum.join();
-
-			cv::Mat range = maximum - minimum;
-			cv::Mat floatRange;
-			cv::Mat floatInput;
-			range.convertTo(floatRange, CV_32F);
-			input.convertTo(floatInput, CV_32F);
-			cv::Mat floatOutput = floatInput * 255.0f / floatRange;
+			auto radius = std::max(iterations, 0) * (kernelSize / 2);
+
 			cv::Mat output;
-			floatOutput.convertTo(output, CV_8U);
+			switch (input.type()) {
+			case CV_8UC1:
+				adaptiveNormalizeImage<uint8_t>(input, output, radius);
+				break;
+			case CV_16UC1:
+				adaptiveNormalizeImage<uint16_t>(input, output, radius);
+				break;
+			default:
+				throw(ofxMachineVision::Exception("adaptiveNormalize requires an 8 or 16 bit single channel image"));
+			}
 			return output;
 		}
 	}
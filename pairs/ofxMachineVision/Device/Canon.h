@@ -40,8 +40,14 @@ namespace ofxMachineVision {
 
 			static cv::Mat adaptiveNormalize(cv::Mat input, float windowSize);
 
+			enum class NormalizeMethod : int {
+				Histogram = 0, // histogram of every 16th pixel, rescale by lookup table (8 and 16 bit)
+				Exact, // histogram of all pixels, rescale by lookup table (8 and 16 bit)
+				Sampled // sort every 16th pixel, rescale by multiply (any pixel type)
+			};
+
 			template<typename PixelsType>
-			static void normalize(ofPixels_<PixelsType>& pixels, float percentile, float ignoreTop, float normalizeTo);
+			static void normalize(ofPixels_<PixelsType>& pixels, float percentile, float ignoreTop, float normalizeTo, NormalizeMethod = NormalizeMethod::Histogram);
 			//
 			//--
 
@@ -50,6 +56,7 @@ namespace ofxMachineVision {
 			bool markFrameNew;
 			chrono::system_clock::time_point openTime;
 			shared_ptr<ofxCanon::Simple> camera;
+			ofxCanon::RawDecoder rawDecoder;
 
 			struct {
 				shared_ptr<ofxMachineVision::Parameter<int>> iso;
@@ -62,6 +69,7 @@ namespace ofxMachineVision {
 				shared_ptr<ofxMachineVision::Parameter<float>> normalizePercentile;
 				shared_ptr<ofxMachineVision::Parameter<float>> normalizeIgnoreTop;
 				shared_ptr<ofxMachineVision::Parameter<float>> normalizeTo;
+				shared_ptr<ofxMachineVision::Parameter<int>> normalizeMethod;
 				shared_ptr<ofxMachineVision::Parameter<bool>> adaptiveNormalize;
 				shared_ptr<ofxMachineVision::Parameter<float>> adaptiveNormalizeWindowSize;
 			} customParameters;
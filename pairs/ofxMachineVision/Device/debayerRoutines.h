@@ -3,8 +3,61 @@
 namespace ofxMachineVision {
 	namespace Device {
 
+		// Bins for the histogram / lookup table paths of normalize (0 if PixelsType isn't 8 or 16 bit integer)
 		template<typename PixelsType>
-		void Canon::normalize(ofPixels_<PixelsType>& pixels, float percentile, float ignoreTop, float normalizeTo) {
+		constexpr size_t getNormalizeBinCount() {
+			return std::is_integral<PixelsType>::value && sizeof(PixelsType) <= 2
+				? (size_t)1 << (8 * sizeof(PixelsType))
+				: 0;
+		}
+
+		//----------
+		// Find the value at percentile amongst every stride'th value of data from start to end (exact for those values)
+		template<typename PixelsType>
+		PixelsType findPercentileByHistogram(const PixelsType * data, size_t start, size_t end, size_t stride, float percentile) {
+			const auto binCount = getNormalizeBinCount<PixelsType>();
+			auto sampleCount = (end - start + stride - 1) / stride;
+
+			// histograms are kept per thread so they're only allocated once
+			thread_local std::vector<uint32_t> histogram;
+			histogram.assign(binCount, 0);
+			auto totals = histogram.data(); // (the workers would see their own thread_local)
+			std::mutex histogramMutex;
+
+			auto stripeCount = std::max(cv::getNumThreads(), 1);
+			cv::parallel_for_(cv::Range(0, (int)stripeCount), [&](const cv::Range & stripes) {
+				thread_local std::vector<uint32_t> stripeHistogram;
+				stripeHistogram.assign(binCount, 0);
+				for (int stripe = stripes.start; stripe < stripes.end; stripe++) {
+					auto sampleBegin = sampleCount * stripe / stripeCount;
+					auto sampleEnd = sampleCount * (stripe + 1) / stripeCount;
+					auto source = data + start + sampleBegin * stride;
+					for (auto i = sampleBegin; i < sampleEnd; i++, source += stride) {
+						stripeHistogram[*source]++;
+					}
+				}
+
+				std::lock_guard<std::mutex> lock(histogramMutex);
+				for (size_t bin = 0; bin < binCount; bin++) {
+					totals[bin] += stripeHistogram[bin];
+				}
+			}, stripeCount);
+
+			// same index as sorting the values would give
+			size_t percentileIndex = ((float)sampleCount - 1) * percentile;
+			size_t count = 0;
+			for (size_t bin = 0; bin < binCount; bin++) {
+				count += histogram[bin];
+				if (count > percentileIndex) {
+					return (PixelsType)bin;
+				}
+			}
+			return std::numeric_limits<PixelsType>::max();
+		}
+
+		//----------
+		template<typename PixelsType>
+		void Canon::normalize(ofPixels_<PixelsType>& pixels, float percentile, float ignoreTop, float normalizeTo, NormalizeMethod method) {
 			if (percentile > 1.0f || percentile < 0.0f) {
 				throw(ofxMachineVision::Exception("Percentile parameter is out of range"));
 			}
@@ -26,21 +79,68 @@ namespace ofxMachineVision {
 				// do it ourselves otherwise
 
 				auto data = pixels.getData();
+				const auto binCount = getNormalizeBinCount<PixelsType>();
+				if (binCount == 0) {
+					// e.g. float pixels
+					method = NormalizeMethod::Sampled;
+				}
 
-				std::vector<PixelsType> values;
-
-				// skip to every 16th pixel to speed up
-				for (size_t i = ignoreTop * (float)pixels.size(); i < pixels.size(); i += 16) {
-					values.push_back(data[i]);
+				// skip to every 16th pixel to speed up (unless Exact)
+				size_t sampleStart = ignoreTop * (float)pixels.size();
+				size_t sampleStride = method == NormalizeMethod::Exact ? 1 : 16;
+				size_t sampleCount = sampleStart < pixels.size()
+					? (pixels.size() - sampleStart + sampleStride - 1) / sampleStride
+					: 0;
+				if (sampleCount == 0) {
+					throw(ofxMachineVision::Exception("No pixels to normalize"));
 				}
 
-				std::sort(values.begin(), values.end());
+				PixelsType maxValue;
+				if (method == NormalizeMethod::Sampled) {
+					std::vector<PixelsType> values(sampleCount);
+					cv::parallel_for_(cv::Range(0, (int)sampleCount), [&](const cv::Range & range) {
+						for (int i = range.start; i < range.end; i++) {
+							values[i] = data[sampleStart + (size_t)i * sampleStride];
+						}
+					});
 
-				auto maxValue = values.at(((float)values.size() - 1) * percentile);
+					// only the value at the percentile needs to be in its sorted position
+					size_t percentileIndex = ((float)values.size() - 1) * percentile;
+					std::nth_element(values.begin(), values.begin() + percentileIndex, values.end());
+					maxValue = values.at(percentileIndex);
+				}
+				else {
+					maxValue = findPercentileByHistogram(data, sampleStart, pixels.size(), sampleStride, percentile);
+				}
+
+				if (maxValue <= 0) {
+					// nothing to scale by
+					return;
+				}
 
 				float normFactor = (float)std::numeric_limits<PixelsType>::max() / (float)maxValue * normalizeTo;
-				for (size_t i = 0; i < pixels.size(); i++) {
-					data[i] = (PixelsType)(min((float)data[i] * normFactor, (float) std::numeric_limits<PixelsType>::max()));
+				auto rowSize = pixels.getWidth() * pixels.getNumChannels();
+
+				if (binCount > 0) {
+					// every possible value is rescaled once into a lookup table
+					thread_local std::vector<PixelsType> lookupTable;
+					lookupTable.resize(binCount);
+					for (size_t value = 0; value < binCount; value++) {
+						lookupTable[value] = (PixelsType)(min((float)value * normFactor, (float)std::numeric_limits<PixelsType>::max()));
+					}
+					auto lookup = lookupTable.data();
+					cv::parallel_for_(cv::Range(0, (int)pixels.getHeight()), [&](const cv::Range & rows) {
+						for (size_t i = rows.start * rowSize; i < rows.end * rowSize; i++) {
+							data[i] = lookup[(size_t)data[i]];
+						}
+					});
+				}
+				else {
+					cv::parallel_for_(cv::Range(0, (int)pixels.getHeight()), [&](const cv::Range & rows) {
+						for (size_t i = rows.start * rowSize; i < rows.end * rowSize; i++) {
+							data[i] = (PixelsType)(min((float)data[i] * normFactor, (float)std::numeric_limits<PixelsType>::max()));
+						}
+					});
 				}
 			}
 		}
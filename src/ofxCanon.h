@@ -3,4 +3,8 @@
 #include "ofxCanon/Initializer.h"
 #include "ofxCanon/Device.h"
 #include "ofxCanon/Simple.h"
+#include "ofxCanon/Burst.h"
+#include "ofxCanon/Rig.h"
+#include "ofxCanon/CaptureTimingReport.h"
 #include "ofxCanon/RemoteDevice.h"
+#include "ofxCanon/RawDecoder.h"
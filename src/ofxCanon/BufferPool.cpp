@@ -0,0 +1,96 @@
+#include "BufferPool.h"
+
+using namespace std;
+
+// Allocations are rounded up to this so that photos of slightly different sizes can share blocks
+#define BUFFER_POOL_GRANULARITY (1024 * 1024)
+
+namespace ofxCanon {
+	//----------
+	BufferPool::BufferPool(size_t maxPooledBytes)
+	: maxPooledBytes(maxPooledBytes) {
+
+	}
+
+	//----------
+	BufferPool::Block BufferPool::acquire(size_t size) {
+		{
+			unique_lock<mutex> lock(this->idleBlocksMutex);
+
+			// Smallest idle block which fits, but don't tie up a much larger block for a small file
+			auto findBlock = this->idleBlocks.lower_bound(size);
+			if (findBlock != this->idleBlocks.end()
+				&& findBlock->first <= size * 2 + BUFFER_POOL_GRANULARITY) {
+				auto block = move(findBlock->second);
+				this->idleBlocks.erase(findBlock);
+				this->stats.pooledBytes -= block.capacity;
+				this->stats.pooledBlocks--;
+				this->stats.hits++;
+				return block;
+			}
+
+			this->stats.misses++;
+		}
+
+		Block block;
+		block.capacity = (size / BUFFER_POOL_GRANULARITY + 1) * BUFFER_POOL_GRANULARITY;
+		block.data.reset(new char[block.capacity]);
+		return block;
+	}
+
+	//----------
+	void BufferPool::release(Block && block) {
+		if (!block.data) {
+			return;
+		}
+
+		unique_lock<mutex> lock(this->idleBlocksMutex);
+		if (block.capacity > this->maxPooledBytes) {
+			// Would never fit, let it go
+			return;
+		}
+
+		// Make room by dropping the smallest idle blocks first
+		this->trim(this->maxPooledBytes - block.capacity);
+
+		this->stats.pooledBytes += block.capacity;
+		this->stats.pooledBlocks++;
+		auto capacity = block.capacity;
+		this->idleBlocks.emplace(capacity, move(block));
+	}
+
+	//----------
+	size_t BufferPool::getMaxPooledBytes() const {
+		unique_lock<mutex> lock(this->idleBlocksMutex);
+		return this->maxPooledBytes;
+	}
+
+	//----------
+	void BufferPool::setMaxPooledBytes(size_t maxPooledBytes) {
+		unique_lock<mutex> lock(this->idleBlocksMutex);
+		this->maxPooledBytes = maxPooledBytes;
+		this->trim(maxPooledBytes);
+	}
+
+	//----------
+	BufferPool::Stats BufferPool::getStats() const {
+		unique_lock<mutex> lock(this->idleBlocksMutex);
+		return this->stats;
+	}
+
+	//----------
+	void BufferPool::clear() {
+		unique_lock<mutex> lock(this->idleBlocksMutex);
+		this->trim(0);
+	}
+
+	//----------
+	void BufferPool::trim(size_t maxPooledBytes) {
+		while (this->stats.pooledBytes > maxPooledBytes && !this->idleBlocks.empty()) {
+			auto smallest = this->idleBlocks.begin();
+			this->stats.pooledBytes -= smallest->first;
+			this->stats.pooledBlocks--;
+			this->idleBlocks.erase(smallest);
+		}
+	}
+}
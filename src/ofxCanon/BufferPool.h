@@ -0,0 +1,51 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+
+namespace ofxCanon {
+	/*
+		A pool of memory blocks which photos are downloaded into.
+
+		Blocks are handed out by acquire() and come back through release() when the
+		EncodedBuffer which holds them is destroyed. The next download of a similar
+		size then reuses the block rather than growing a fresh memory stream.
+
+		Idle blocks are kept up to maxPooledBytes, beyond that they are freed.
+		The pool is thread safe (buffers are often released outside the camera thread).
+	*/
+	class BufferPool {
+	public:
+		struct Block {
+			std::unique_ptr<char[]> data;
+			size_t capacity = 0;
+		};
+
+		struct Stats {
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			size_t pooledBytes = 0; // idle bytes held by the pool
+			size_t pooledBlocks = 0;
+		};
+
+		BufferPool(size_t maxPooledBytes = 256 * 1024 * 1024);
+
+		Block acquire(size_t size);
+		void release(Block &&);
+
+		size_t getMaxPooledBytes() const;
+		void setMaxPooledBytes(size_t);
+
+		Stats getStats() const;
+		void clear();
+	protected:
+		void trim(size_t maxPooledBytes); // call whilst holding the lock
+
+		std::multimap<size_t, Block> idleBlocks; // by capacity
+		size_t maxPooledBytes;
+		Stats stats;
+		mutable std::mutex idleBlocksMutex;
+	};
+}
@@ -0,0 +1,141 @@
+#include "Burst.h"
+
+using namespace std;
+
+namespace ofxCanon {
+	//----------
+	Burst::Burst(const Device::BurstSettings & settings)
+	: settings(settings) {
+		if (this->settings.capacity < 1) {
+			this->settings.capacity = 1;
+		}
+	}
+
+	//----------
+	const Device::BurstSettings & Burst::getSettings() const {
+		return this->settings;
+	}
+
+	//----------
+	bool Burst::receive(Device::PhotoCaptureResult & photo) {
+		unique_lock<mutex> lock(this->burstMutex);
+		this->burstChanged.wait(lock, [this]() {
+			return !this->photos.empty() || this->closed;
+		});
+
+		if (this->photos.empty()) {
+			return false;
+		}
+
+		photo = move(this->photos.front());
+		this->photos.pop_front();
+		return true;
+	}
+
+	//----------
+	bool Burst::tryReceive(Device::PhotoCaptureResult & photo) {
+		unique_lock<mutex> lock(this->burstMutex);
+		if (this->photos.empty()) {
+			return false;
+		}
+
+		photo = move(this->photos.front());
+		this->photos.pop_front();
+		return true;
+	}
+
+	//----------
+	void Burst::stop() {
+		// onStop is called under the lock, so the device can't detach (close) whilst we're calling it
+		unique_lock<mutex> lock(this->burstMutex);
+		if (this->stopRequested) {
+			return;
+		}
+		this->stopRequested = true;
+		if (this->onStop) {
+			this->onStop();
+		}
+	}
+
+	//----------
+	bool Burst::isStopRequested() const {
+		unique_lock<mutex> lock(this->burstMutex);
+		return this->stopRequested;
+	}
+
+	//----------
+	bool Burst::isFinished() const {
+		unique_lock<mutex> lock(this->burstMutex);
+		return this->closed && this->photos.empty();
+	}
+
+	//----------
+	Burst::Stats Burst::getStats() const {
+		unique_lock<mutex> lock(this->burstMutex);
+		auto stats = this->stats;
+		stats.queueLength = this->photos.size();
+		if (stats.framesTaken > 1) {
+			auto duration = chrono::duration_cast<chrono::microseconds>(this->lastFrameTime - this->firstFrameTime);
+			if (duration.count() > 0) {
+				stats.framesPerSecond = (float)(stats.framesTaken - 1) * 1e6f / (float)duration.count();
+			}
+		}
+		return stats;
+	}
+
+	//----------
+	void Burst::frameTaken() {
+		unique_lock<mutex> lock(this->burstMutex);
+		auto now = Clock::now();
+		if (this->stats.framesTaken == 0) {
+			this->firstFrameTime = now;
+		}
+		this->lastFrameTime = now;
+		this->stats.framesTaken++;
+	}
+
+	//----------
+	bool Burst::isFull() const {
+		unique_lock<mutex> lock(this->burstMutex);
+		return this->photos.size() >= this->settings.capacity;
+	}
+
+	//----------
+	void Burst::push(Device::PhotoCaptureResult && photo) {
+		{
+			unique_lock<mutex> lock(this->burstMutex);
+			this->photos.push_back(move(photo));
+			this->stats.framesDelivered++;
+			this->stats.maxQueueLength = max(this->stats.maxQueueLength, this->photos.size());
+		}
+		this->burstChanged.notify_all();
+	}
+
+	//----------
+	void Burst::frameDropped() {
+		unique_lock<mutex> lock(this->burstMutex);
+		this->stats.framesDropped++;
+	}
+
+	//----------
+	void Burst::frameFailed() {
+		unique_lock<mutex> lock(this->burstMutex);
+		this->stats.framesFailed++;
+	}
+
+	//----------
+	void Burst::close() {
+		{
+			unique_lock<mutex> lock(this->burstMutex);
+			this->closed = true;
+			this->onStop = nullptr;
+		}
+		this->burstChanged.notify_all();
+	}
+
+	//----------
+	void Burst::setOnStop(function<void()> && onStop) {
+		unique_lock<mutex> lock(this->burstMutex);
+		this->onStop = move(onStop);
+	}
+}
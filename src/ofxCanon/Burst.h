@@ -0,0 +1,75 @@
+#pragma once
+
+#include "Device.h"
+
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+
+namespace ofxCanon {
+	/*
+		The photos of one continuous drive mode burst (see Device::startBurst).
+
+		Photos are pushed by the camera thread as they are downloaded, and can be received
+		from any thread while the camera is still shooting.
+
+		The channel holds at most BurstSettings::capacity photos. If the consumer falls behind,
+		further photos are cancelled on the camera (never transferred) and counted as framesDropped,
+		so a long burst never buffers more than capacity photos.
+	*/
+	class Burst {
+	public:
+		struct Stats {
+			uint64_t framesTaken = 0; // photos announced by the camera
+			uint64_t framesDelivered = 0; // photos pushed into the channel
+			uint64_t framesDropped = 0; // photos cancelled because the channel was full
+			uint64_t framesFailed = 0; // photos which failed to download
+			size_t queueLength = 0; // photos waiting to be received
+			size_t maxQueueLength = 0;
+			float framesPerSecond = 0.0f; // of photos taken, from the first to the last
+		};
+
+		Burst(const Device::BurstSettings &);
+
+		const Device::BurstSettings & getSettings() const;
+
+		// Blocks until a photo is available. Returns false once the burst has finished and every photo has been received
+		bool receive(Device::PhotoCaptureResult &);
+		bool tryReceive(Device::PhotoCaptureResult &);
+
+		// Release the shutter (can be called from any thread). Photos already taken are still delivered.
+		void stop();
+
+		bool isStopRequested() const;
+		bool isFinished() const; // shutter released, all photos have arrived and been received
+
+		Stats getStats() const;
+	protected:
+		friend class Device;
+		typedef std::chrono::high_resolution_clock Clock;
+
+		// Called by the camera thread
+		void frameTaken();
+		bool isFull() const;
+		void push(Device::PhotoCaptureResult &&);
+		void frameDropped();
+		void frameFailed();
+		void close();
+		void setOnStop(std::function<void()> &&);
+
+		Device::BurstSettings settings;
+
+		std::deque<Device::PhotoCaptureResult> photos;
+		bool closed = false;
+		bool stopRequested = false;
+		std::function<void()> onStop; // wakes the camera thread
+
+		Stats stats;
+		Clock::time_point firstFrameTime;
+		Clock::time_point lastFrameTime;
+
+		mutable std::mutex burstMutex;
+		std::condition_variable burstChanged;
+	};
+}
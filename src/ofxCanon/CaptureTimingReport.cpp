@@ -0,0 +1,300 @@
+#include "CaptureTimingReport.h"
+
+#include "ofFileUtils.h"
+
+#include <algorithm>
+#include <map>
+#include <sstream>
+
+using namespace std;
+
+namespace ofxCanon {
+	//----------
+	string CaptureTimingReport::Statistics::toString() const {
+		stringstream ss;
+		ss.precision(3);
+		ss << fixed
+			<< "n=" << this->count
+			<< " min=" << this->min
+			<< " p50=" << this->p50
+			<< " p90=" << this->p90
+			<< " p99=" << this->p99
+			<< " max=" << this->max
+			<< " mean=" << this->mean;
+		return ss.str();
+	}
+
+	//----------
+	void CaptureTimingReport::add(uint64_t shotIndex, size_t cameraIndex, const Device::CaptureTiming & timing) {
+		this->samples.push_back({ shotIndex, cameraIndex, timing });
+	}
+
+	//----------
+	void CaptureTimingReport::add(const Rig::CaptureResult & captureResult) {
+		for (const auto & cameraResult : captureResult.cameraResults) {
+			if (cameraResult.captureResult) {
+				this->add(captureResult.captureIndex, cameraResult.cameraIndex, cameraResult.captureResult.timing);
+			}
+		}
+	}
+
+	//----------
+	void CaptureTimingReport::clear() {
+		this->samples.clear();
+	}
+
+	//----------
+	size_t CaptureTimingReport::size() const {
+		return this->samples.size();
+	}
+
+	//----------
+	CaptureTimingReport::Statistics CaptureTimingReport::getStatistics(Latency latency) const {
+		vector<float> values;
+		for (const auto & sample : this->samples) {
+			float value;
+			if (getLatency(sample, latency, value)) {
+				values.push_back(value);
+			}
+		}
+		return getStatistics(move(values));
+	}
+
+	//----------
+	CaptureTimingReport::Statistics CaptureTimingReport::getStatistics(Latency latency, size_t cameraIndex) const {
+		vector<float> values;
+		for (const auto & sample : this->samples) {
+			float value;
+			if (sample.cameraIndex == cameraIndex && getLatency(sample, latency, value)) {
+				values.push_back(value);
+			}
+		}
+		return getStatistics(move(values));
+	}
+
+	//----------
+	CaptureTimingReport::Statistics CaptureTimingReport::getSkewStatistics(Event event) const {
+		typedef Device::CaptureTiming::Clock Clock;
+
+		// earliest and latest time of the event in each shot
+		map<uint64_t, pair<Clock::time_point, Clock::time_point>> shotRanges;
+		for (const auto & sample : this->samples) {
+			Clock::time_point time;
+			if (!getTime(sample, event, time)) {
+				continue;
+			}
+
+			auto findShot = shotRanges.find(sample.shotIndex);
+			if (findShot == shotRanges.end()) {
+				shotRanges.emplace(sample.shotIndex, make_pair(time, time));
+			}
+			else {
+				findShot->second.first = std::min(findShot->second.first, time);
+				findShot->second.second = std::max(findShot->second.second, time);
+			}
+		}
+
+		vector<float> values;
+		for (const auto & shotRange : shotRanges) {
+			values.push_back(toMilliseconds(shotRange.second.second - shotRange.second.first));
+		}
+		return getStatistics(move(values));
+	}
+
+	//----------
+	string CaptureTimingReport::getSummary() const {
+		stringstream ss;
+		ss << "Latency (ms) :" << endl;
+		for (auto latency : { CommandLatency, TransferLatency, DownloadQueueTime, DownloadDuration, TotalLatency }) {
+			ss << "\t" << toString(latency) << " : " << this->getStatistics(latency).toString() << endl;
+		}
+		ss << "Skew across cameras (ms) :" << endl;
+		for (auto event : { CommandIssued, CommandReturned, TransferRequested, DownloadCompleted }) {
+			ss << "\t" << toString(event) << " : " << this->getSkewStatistics(event).toString() << endl;
+		}
+		return ss.str();
+	}
+
+	//----------
+	string CaptureTimingReport::toCSV() const {
+		typedef Device::CaptureTiming::Clock Clock;
+
+		// the reference time for each shot is the earliest command
+		map<uint64_t, Clock::time_point> shotStarts;
+		for (const auto & sample : this->samples) {
+			Clock::time_point time;
+			if (!getTime(sample, CommandIssued, time) && !getTime(sample, TransferRequested, time)) {
+				continue;
+			}
+			auto findShot = shotStarts.find(sample.shotIndex);
+			if (findShot == shotStarts.end()) {
+				shotStarts.emplace(sample.shotIndex, time);
+			}
+			else {
+				findShot->second = std::min(findShot->second, time);
+			}
+		}
+
+		stringstream ss;
+		ss.precision(3);
+		ss << fixed;
+		ss << "shot,camera";
+		for (auto event : { CommandIssued, CommandReturned, TransferRequested, DownloadCompleted }) {
+			ss << "," << toString(event) << "_ms";
+		}
+		ss << endl;
+
+		for (const auto & sample : this->samples) {
+			ss << sample.shotIndex << "," << sample.cameraIndex;
+			auto findShot = shotStarts.find(sample.shotIndex);
+			for (auto event : { CommandIssued, CommandReturned, TransferRequested, DownloadCompleted }) {
+				ss << ",";
+				Clock::time_point time;
+				if (findShot != shotStarts.end() && getTime(sample, event, time)) {
+					ss << toMilliseconds(time - findShot->second);
+				}
+			}
+			ss << endl;
+		}
+
+		return ss.str();
+	}
+
+	//----------
+	bool CaptureTimingReport::saveCSV(const string & path) const {
+		auto csv = this->toCSV();
+		ofBuffer buffer;
+		buffer.set(csv.c_str(), csv.size());
+		return ofBufferToFile(path, buffer);
+	}
+
+	//----------
+	string CaptureTimingReport::toString(Latency latency) {
+		switch (latency) {
+		case CommandLatency:
+			return "CommandLatency";
+		case TransferLatency:
+			return "TransferLatency";
+		case DownloadQueueTime:
+			return "DownloadQueueTime";
+		case DownloadDuration:
+			return "DownloadDuration";
+		case TotalLatency:
+			return "TotalLatency";
+		default:
+			return "Unknown";
+		}
+	}
+
+	//----------
+	string CaptureTimingReport::toString(Event event) {
+		switch (event) {
+		case CommandIssued:
+			return "CommandIssued";
+		case CommandReturned:
+			return "CommandReturned";
+		case TransferRequested:
+			return "TransferRequested";
+		case DownloadCompleted:
+			return "DownloadCompleted";
+		default:
+			return "Unknown";
+		}
+	}
+
+	//----------
+	bool CaptureTimingReport::getLatency(const Sample & sample, Latency latency, float & milliseconds) {
+		const auto & timing = sample.timing;
+		auto isSet = [](const Device::CaptureTiming::Clock::time_point & time) {
+			return time != Device::CaptureTiming::Clock::time_point();
+		};
+
+		switch (latency) {
+		case CommandLatency:
+			if (!timing.hasCommand() || !isSet(timing.commandReturned)) {
+				return false;
+			}
+			milliseconds = toMilliseconds(timing.commandReturned - timing.commandIssued);
+			return true;
+		case TransferLatency:
+			if (!timing.hasCommand() || !isSet(timing.transferRequested)) {
+				return false;
+			}
+			milliseconds = toMilliseconds(timing.transferRequested - timing.commandIssued);
+			return true;
+		case DownloadQueueTime:
+			if (!isSet(timing.transferRequested) || !isSet(timing.downloadStarted)) {
+				return false;
+			}
+			milliseconds = toMilliseconds(timing.downloadStarted - timing.transferRequested);
+			return true;
+		case DownloadDuration:
+			if (!isSet(timing.downloadStarted) || !isSet(timing.downloadCompleted)) {
+				return false;
+			}
+			milliseconds = toMilliseconds(timing.downloadCompleted - timing.downloadStarted);
+			return true;
+		case TotalLatency:
+			if (!timing.hasCommand() || !isSet(timing.downloadCompleted)) {
+				return false;
+			}
+			milliseconds = toMilliseconds(timing.downloadCompleted - timing.commandIssued);
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	//----------
+	bool CaptureTimingReport::getTime(const Sample & sample, Event event, Device::CaptureTiming::Clock::time_point & time) {
+		switch (event) {
+		case CommandIssued:
+			time = sample.timing.commandIssued;
+			break;
+		case CommandReturned:
+			time = sample.timing.commandReturned;
+			break;
+		case TransferRequested:
+			time = sample.timing.transferRequested;
+			break;
+		case DownloadCompleted:
+			time = sample.timing.downloadCompleted;
+			break;
+		default:
+			return false;
+		}
+		return time != Device::CaptureTiming::Clock::time_point();
+	}
+
+	//----------
+	CaptureTimingReport::Statistics CaptureTimingReport::getStatistics(vector<float> && values) {
+		Statistics statistics;
+		if (values.empty()) {
+			return statistics;
+		}
+
+		sort(values.begin(), values.end());
+
+		// linear interpolation between closest ranks
+		auto percentile = [&values](float fraction) {
+			auto position = fraction * (float) (values.size() - 1);
+			auto lower = (size_t) position;
+			auto upper = std::min(lower + 1, values.size() - 1);
+			auto weight = position - (float) lower;
+			return values[lower] * (1.0f - weight) + values[upper] * weight;
+		};
+
+		statistics.count = values.size();
+		statistics.min = values.front();
+		statistics.max = values.back();
+		double sum = 0.0;
+		for (auto value : values) {
+			sum += value;
+		}
+		statistics.mean = (float) (sum / (double) values.size());
+		statistics.p50 = percentile(0.5f);
+		statistics.p90 = percentile(0.9f);
+		statistics.p99 = percentile(0.99f);
+		return statistics;
+	}
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "Device.h"
+#include "Rig.h"
+
+#include <string>
+#include <vector>
+
+namespace ofxCanon {
+	/*
+		Collects the CaptureTiming of many photos (e.g. each camera of a rig over many shots),
+		to see how far apart the cameras really fired and where the time goes.
+
+		All results are in milliseconds.
+
+		Latencies (getStatistics) are per photo, measured from the capture command being issued :
+			CommandLatency : until the capture command returned
+			TransferLatency : until the camera announced the photo (closest we get to the exposure time)
+			DownloadQueueTime : from the announcement until the camera thread started downloading
+			DownloadDuration : download start until download complete
+			TotalLatency : until the photo was downloaded
+
+		Skews (getSkewStatistics) are per shot, across cameras : the time between the earliest
+		and the latest camera reaching an event in the same shot.
+	*/
+	class CaptureTimingReport {
+	public:
+		enum Latency {
+			CommandLatency,
+			TransferLatency,
+			DownloadQueueTime,
+			DownloadDuration,
+			TotalLatency
+		};
+
+		enum Event {
+			CommandIssued,
+			CommandReturned,
+			TransferRequested,
+			DownloadCompleted
+		};
+
+		struct Statistics {
+			size_t count = 0;
+			float min = 0.0f;
+			float max = 0.0f;
+			float mean = 0.0f;
+			float p50 = 0.0f;
+			float p90 = 0.0f;
+			float p99 = 0.0f;
+
+			std::string toString() const;
+		};
+
+		void add(uint64_t shotIndex, size_t cameraIndex, const Device::CaptureTiming &);
+		void add(const Rig::CaptureResult &); // adds every successful camera
+		void clear();
+
+		size_t size() const;
+
+		Statistics getStatistics(Latency) const;
+		Statistics getStatistics(Latency, size_t cameraIndex) const; // e.g. to find a slow camera
+		Statistics getSkewStatistics(Event) const;
+
+		std::string getSummary() const;
+
+		// One row per photo. Times are in ms relative to the earliest command issued in that shot
+		std::string toCSV() const;
+		bool saveCSV(const std::string & path) const;
+
+		static std::string toString(Latency);
+		static std::string toString(Event);
+	protected:
+		struct Sample {
+			uint64_t shotIndex;
+			size_t cameraIndex;
+			Device::CaptureTiming timing;
+		};
+
+		static bool getLatency(const Sample &, Latency, float & milliseconds);
+		static bool getTime(const Sample &, Event, Device::CaptureTiming::Clock::time_point &);
+		static Statistics getStatistics(std::vector<float> && values);
+
+		std::vector<Sample> samples;
+	};
+}
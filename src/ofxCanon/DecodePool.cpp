@@ -0,0 +1,277 @@
+#include "DecodePool.h"
+
+#include "ofImage.h"
+
+using namespace std;
+
+namespace ofxCanon {
+	//----------
+	template<typename DurationType>
+	void addTimingSample(float & smoothedMilliseconds, const DurationType & duration) {
+		auto milliseconds = toMilliseconds(duration);
+		if (smoothedMilliseconds == 0.0f) {
+			smoothedMilliseconds = milliseconds;
+		}
+		else {
+			smoothedMilliseconds = smoothedMilliseconds * 0.9f + milliseconds * 0.1f;
+		}
+	}
+
+	//----------
+	DecodePool::DecodePool(size_t threadCount) {
+		if (threadCount < 1) {
+			threadCount = 1;
+		}
+		for (size_t i = 0; i < threadCount; i++) {
+			this->threads.emplace_back([this]() {
+				this->workerLoop();
+			});
+		}
+	}
+
+	//----------
+	DecodePool::~DecodePool() {
+		{
+			unique_lock<mutex> lock(this->jobsMutex);
+			this->closeThreads = true;
+		}
+		this->jobsChanged.notify_all();
+
+		for (auto & thread : this->threads) {
+			if (thread.joinable()) {
+				thread.join();
+			}
+		}
+	}
+
+	//----------
+	size_t DecodePool::getThreadCount() const {
+		return this->threads.size();
+	}
+
+	//----------
+	void DecodePool::addLiveView(shared_ptr<EncodedBuffer> encodedBuffer, int orientationMode) {
+		if (!encodedBuffer) {
+			return;
+		}
+
+		{
+			unique_lock<mutex> lock(this->jobsMutex);
+			if (this->liveViewJob.isPending()) {
+				// The previous frame was never started, drop it in favour of this one
+				this->stats.liveViewFramesSuperseded++;
+				this->liveViewJob.clear();
+			}
+			this->liveViewJob.index = ++this->nextLiveViewIndex;
+			this->liveViewJob.encodedBuffer = encodedBuffer;
+			this->liveViewJob.maxSize = this->liveViewMaxSize;
+			this->liveViewJob.orientationMode = orientationMode;
+			this->liveViewJob.timeAdded = Clock::now();
+		}
+		this->jobsChanged.notify_one();
+	}
+
+	//----------
+	void DecodePool::addLiveView(ofBuffer && buffer, int orientationMode) {
+		if (buffer.size() == 0) {
+			return;
+		}
+
+		// The dropped buffer is freed outside the lock
+		ofBuffer supersededBuffer;
+		{
+			unique_lock<mutex> lock(this->jobsMutex);
+			if (this->liveViewJob.isPending()) {
+				this->stats.liveViewFramesSuperseded++;
+				swap(supersededBuffer, this->liveViewJob.buffer);
+				this->liveViewJob.clear();
+			}
+			this->liveViewJob.index = ++this->nextLiveViewIndex;
+			swap(this->liveViewJob.buffer, buffer);
+			this->liveViewJob.maxSize = this->liveViewMaxSize;
+			this->liveViewJob.orientationMode = orientationMode;
+			this->liveViewJob.timeAdded = Clock::now();
+		}
+		this->jobsChanged.notify_one();
+	}
+
+	//----------
+	void DecodePool::addPhoto(const Device::PhotoCaptureResult & captureResult, int orientationMode) {
+		{
+			unique_lock<mutex> lock(this->jobsMutex);
+			PhotoJob photoJob;
+			photoJob.index = this->nextPhotoIndex++;
+			photoJob.captureResult = captureResult;
+			photoJob.orientationMode = orientationMode;
+			photoJob.timeAdded = Clock::now();
+			this->photoJobs.push_back(move(photoJob));
+		}
+		this->jobsChanged.notify_one();
+	}
+
+	//----------
+	bool DecodePool::receiveLiveView(ofPixels & pixels) {
+		unique_lock<mutex> lock(this->jobsMutex);
+		if (!this->liveViewResultIsNew) {
+			return false;
+		}
+
+		// Swap so that the pixel allocations are recycled between frames
+		swap(pixels, this->liveViewResult);
+		this->liveViewResultIsNew = false;
+		return true;
+	}
+
+	//----------
+	bool DecodePool::receivePhoto(DecodedPhoto & decodedPhoto) {
+		unique_lock<mutex> lock(this->jobsMutex);
+		auto findPhoto = this->decodedPhotos.find(this->nextPhotoToReceive);
+		if (findPhoto == this->decodedPhotos.end()) {
+			// Either nothing is ready, or an earlier photo is still decoding
+			return false;
+		}
+
+		decodedPhoto = move(findPhoto->second);
+		this->decodedPhotos.erase(findPhoto);
+		this->nextPhotoToReceive++;
+		return true;
+	}
+
+	//----------
+	void DecodePool::setLiveViewMaxSize(int liveViewMaxSize) {
+		unique_lock<mutex> lock(this->jobsMutex);
+		this->liveViewMaxSize = max(liveViewMaxSize, 0);
+	}
+
+	//----------
+	int DecodePool::getLiveViewMaxSize() const {
+		unique_lock<mutex> lock(this->jobsMutex);
+		return this->liveViewMaxSize;
+	}
+
+	//----------
+	DecodePool::Stats DecodePool::getStats() const {
+		unique_lock<mutex> lock(this->jobsMutex);
+		auto stats = this->stats;
+		stats.photoQueueDepth = this->photoJobs.size();
+		stats.photosWaitingToBeReceived = this->decodedPhotos.size();
+		stats.liveViewFramePending = this->liveViewJob.isPending();
+		return stats;
+	}
+
+	//----------
+	void DecodePool::workerLoop() {
+		// Each worker keeps its own live view pixels, which are recycled through swaps
+		ofPixels liveViewPixels;
+
+		while (true) {
+			PhotoJob photoJob;
+			LiveViewJob liveViewJob;
+			bool isPhotoJob = false;
+
+			{
+				unique_lock<mutex> lock(this->jobsMutex);
+				this->jobsChanged.wait(lock, [this]() {
+					return this->closeThreads
+						|| !this->photoJobs.empty()
+						|| this->liveViewJob.isPending();
+				});
+
+				if (this->closeThreads) {
+					break;
+				}
+
+				// Photos go first since they can't be dropped
+				if (!this->photoJobs.empty()) {
+					photoJob = move(this->photoJobs.front());
+					this->photoJobs.pop_front();
+					this->stats.photosDecoding++;
+					isPhotoJob = true;
+				}
+				else {
+					liveViewJob = move(this->liveViewJob);
+					this->liveViewJob.clear();
+				}
+			}
+
+			if (isPhotoJob) {
+				this->decodePhoto(photoJob);
+			}
+			else {
+				this->decodeLiveView(liveViewJob, liveViewPixels);
+			}
+		}
+	}
+
+	//----------
+	void DecodePool::decodeLiveView(LiveViewJob & liveViewJob, ofPixels & pixels) {
+		ofImageLoadSettings loadSettings;
+		if (liveViewJob.maxSize > 0) {
+			// FreeImage passes this to libjpeg as a requested size (other formats ignore it)
+			loadSettings.freeImageFlags = liveViewJob.maxSize << 16;
+		}
+
+		auto decodeStart = Clock::now();
+		bool success = liveViewJob.encodedBuffer
+			? loadImage(pixels, *liveViewJob.encodedBuffer, loadSettings)
+			: loadImage(pixels, liveViewJob.buffer.getData(), liveViewJob.buffer.size(), loadSettings);
+		if (!success) {
+			return;
+		}
+		if (liveViewJob.orientationMode != 0) {
+			pixels.rotate90(liveViewJob.orientationMode);
+		}
+		auto decodeEnd = Clock::now();
+
+		// Release the stream before we take the lock
+		liveViewJob.clear();
+
+		unique_lock<mutex> lock(this->jobsMutex);
+		if (liveViewJob.index > this->liveViewResultIndex) {
+			if (this->liveViewResultIsNew) {
+				// The previous result was never received
+				this->stats.liveViewFramesSuperseded++;
+			}
+			swap(pixels, this->liveViewResult);
+			this->liveViewResultIndex = liveViewJob.index;
+			this->liveViewResultIsNew = true;
+		}
+		else {
+			// Another worker finished a newer frame first
+			this->stats.liveViewFramesSuperseded++;
+		}
+
+		this->stats.liveViewFramesDecoded++;
+		addTimingSample(this->stats.liveViewDecodeTime, decodeEnd - decodeStart);
+		addTimingSample(this->stats.liveViewLatency, decodeEnd - liveViewJob.timeAdded);
+	}
+
+	//----------
+	void DecodePool::decodePhoto(PhotoJob & photoJob) {
+		DecodedPhoto decodedPhoto;
+		decodedPhoto.captureResult = photoJob.captureResult;
+
+		auto decodeStart = Clock::now();
+		{
+			const auto & captureResult = photoJob.captureResult;
+			if (captureResult.encodedBuffer) {
+				decodedPhoto.success = loadImage(decodedPhoto.pixels, *captureResult.encodedBuffer);
+			}
+			else if (!captureResult.savedFilePath.empty()) {
+				decodedPhoto.success = ofLoadImage(decodedPhoto.pixels, captureResult.savedFilePath);
+			}
+
+			if (decodedPhoto.success && photoJob.orientationMode != 0) {
+				decodedPhoto.pixels.rotate90(photoJob.orientationMode);
+			}
+		}
+		auto decodeEnd = Clock::now();
+
+		unique_lock<mutex> lock(this->jobsMutex);
+		this->decodedPhotos.emplace(photoJob.index, move(decodedPhoto));
+		this->stats.photosDecoding--;
+		this->stats.photosDecoded++;
+		addTimingSample(this->stats.photoDecodeTime, decodeEnd - decodeStart);
+		addTimingSample(this->stats.photoLatency, decodeEnd - photoJob.timeAdded);
+	}
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "Device.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <vector>
+
+namespace ofxCanon {
+	/*
+		Decodes live view frames and photos on a fixed set of worker threads, so that
+		the camera thread only needs to transfer bytes.
+
+		Live view : only the latest frame matters. If a new frame arrives whilst the previous
+			one is still waiting to be decoded, the older frame is dropped (see liveViewFramesSuperseded).
+			Frames can also come as an ofBuffer (e.g. photo previews from a RemoteDevice), and JPEGs can
+			be decoded at a reduced size (see setLiveViewMaxSize).
+
+		Photos : every photo is decoded, and photos are received in the order they were added
+			(even if a later photo finishes decoding first).
+
+		Results are collected with receiveLiveView / receivePhoto (e.g. from the main thread).
+	*/
+	class DecodePool {
+	public:
+		struct DecodedPhoto {
+			Device::PhotoCaptureResult captureResult;
+			ofPixels pixels;
+			bool success = false;
+		};
+
+		struct Stats {
+			size_t photoQueueDepth = 0; // photos waiting to be decoded
+			size_t photosDecoding = 0; // photos currently being decoded
+			size_t photosWaitingToBeReceived = 0;
+			bool liveViewFramePending = false;
+
+			uint64_t liveViewFramesDecoded = 0;
+			uint64_t liveViewFramesSuperseded = 0; // dropped before decoding, or decoded but replaced before being received
+			uint64_t photosDecoded = 0;
+
+			// Smoothed timings in milliseconds
+			// 'Decode' is time spent decoding, 'Latency' is from being added until the result is ready
+			float liveViewDecodeTime = 0.0f;
+			float liveViewLatency = 0.0f;
+			float photoDecodeTime = 0.0f;
+			float photoLatency = 0.0f;
+		};
+
+		DecodePool(size_t threadCount = 2);
+		~DecodePool();
+
+		size_t getThreadCount() const;
+
+		void addLiveView(std::shared_ptr<EncodedBuffer>, int orientationMode = 0);
+		void addLiveView(ofBuffer &&, int orientationMode = 0);
+		void addPhoto(const Device::PhotoCaptureResult &, int orientationMode = 0);
+
+		bool receiveLiveView(ofPixels &);
+		bool receivePhoto(DecodedPhoto &);
+
+		// Decode live view JPEGs scaled down by 1/2, 1/4 or 1/8 (in the decoder, so it's also faster)
+		// to roughly this many pixels on the longest side. 0 (default) decodes at full size.
+		void setLiveViewMaxSize(int);
+		int getLiveViewMaxSize() const;
+
+		Stats getStats() const;
+	protected:
+		typedef std::chrono::high_resolution_clock Clock;
+
+		struct LiveViewJob {
+			uint64_t index = 0;
+			std::shared_ptr<EncodedBuffer> encodedBuffer;
+			ofBuffer buffer; // used if there's no encodedBuffer
+			int maxSize = 0;
+			int orientationMode = 0;
+			Clock::time_point timeAdded;
+
+			bool isPending() const {
+				return this->encodedBuffer || this->buffer.size() > 0;
+			}
+			void clear() {
+				this->encodedBuffer.reset();
+				this->buffer.clear();
+			}
+		};
+
+		struct PhotoJob {
+			uint64_t index = 0;
+			Device::PhotoCaptureResult captureResult;
+			int orientationMode = 0;
+			Clock::time_point timeAdded;
+		};
+
+		void workerLoop();
+		void decodeLiveView(LiveViewJob &, ofPixels &);
+		void decodePhoto(PhotoJob &);
+
+		std::vector<std::thread> threads;
+		bool closeThreads = false;
+
+		mutable std::mutex jobsMutex;
+		std::condition_variable jobsChanged;
+
+		// jobs
+		std::deque<PhotoJob> photoJobs;
+		LiveViewJob liveViewJob; // see isPending
+		int liveViewMaxSize = 0;
+		uint64_t nextPhotoIndex = 0;
+		uint64_t nextLiveViewIndex = 0;
+
+		// results
+		ofPixels liveViewResult;
+		uint64_t liveViewResultIndex = 0;
+		bool liveViewResultIsNew = false;
+		std::map<uint64_t, DecodedPhoto> decodedPhotos;
+		uint64_t nextPhotoToReceive = 0;
+
+		Stats stats;
+	};
+}
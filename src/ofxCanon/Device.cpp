@@ -1,12 +1,42 @@
 #include "Device.h"
 
 #include "Initializer.h"
+#include "Burst.h"
 
 #include "ofImage.h"
 
 using namespace std;
 
+// EdsDownload can be called repeatedly to transfer a file in parts
+// Each part except the last must be a multiple of 512 bytes
+#define DOWNLOAD_CHUNK_SIZE ((EdsUInt64) 4 * 1024 * 1024)
+
 namespace ofxCanon {
+	//----------
+	shared_ptr<Device::PhotoMetadata> readMetadata(EdsStreamRef stream) {
+		EdsImageRef imageRef = NULL;
+		shared_ptr<Device::PhotoMetadata> metaData;
+		try {
+			ERROR_THROW(EdsCreateImageRef(stream, &imageRef)
+				, "Create image reference from incoming stream for metadata purposes (Unsupported for CR2 on some camera models especially in x64)");
+			vector<EdsRational> value(3);
+			ERROR_THROW(EdsGetPropertyData(imageRef, kEdsPropID_FocalLength, 0, sizeof(EdsRational) * 3, value.data())
+				, "Get focal length data from image");
+			metaData = make_shared<Device::PhotoMetadata>();
+			metaData->focalLength.minimumFocalLength = rationalToFloat(value[1]);
+			metaData->focalLength.currentFocalLength = rationalToFloat(value[0]);
+			metaData->focalLength.maximumFocalLength = rationalToFloat(value[2]);
+		}
+		catch (EdsError) {
+			//this generally happens when the image is RAW and the SDK can't process it
+		}
+
+		if (imageRef != NULL) {
+			EdsRelease(imageRef);
+		}
+		return metaData;
+	}
+
 	//----------
 	Device::Device(EdsCameraRef camera) {
 		this->camera = camera;
@@ -68,6 +98,9 @@ namespace ofxCanon {
 
 		this->cameraThreadId = std::this_thread::get_id();
 
+		//options may differ between sessions (e.g. if the lens or mode were changed)
+		this->invalidateOptions();
+
 		ERROR_GOTO_FAIL(EdsOpenSession(this->camera)
 			, "Open session");
 
@@ -102,6 +135,9 @@ namespace ofxCanon {
 
 	//----------
 	void Device::close() {
+		this->cancelCapturesInFlight();
+		this->finishBurst();
+
 		if (this->isOpen) {
 			ERROR_GOTO_FAIL(EdsCloseSession(this->camera)
 				, "Close session");
@@ -112,39 +148,88 @@ namespace ofxCanon {
 
 	//----------
 	void Device::update() {
-		//perform outstanding actions in queue
-		{
+		//perform outstanding actions in queue (highest priority first) until we run out of budget
+		auto updateStart = chrono::high_resolution_clock::now();
+		size_t actionsPerformed = 0;
+
+		while (true) {
 			Action action;
-			if (this->actionQueue.tryReceive(action)) {
-				action();
+			{
+				unique_lock<mutex> lock(this->actionQueueMutex);
+
+				bool overBudget = actionsPerformed > 0
+					&& ((this->maxActionsPerUpdate > 0 && actionsPerformed >= this->maxActionsPerUpdate)
+						|| (this->maxTimePerUpdate.count() > 0 && chrono::high_resolution_clock::now() - updateStart >= this->maxTimePerUpdate));
+
+				for (int priority = 0; priority < ActionPriorityCount; priority++) {
+					auto & actionQueue = this->actionQueues[priority];
+					if (actionQueue.empty()) {
+						continue;
+					}
+
+					if (overBudget) {
+						// leave the rest for the next update
+						this->actionQueueStats.updatesOverBudget++;
+						break;
+					}
+
+					auto & queuedAction = actionQueue.front();
+					auto waitTime = (float) chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - queuedAction.timeQueued).count() / 1000.0f;
+					auto & averageWaitTime = this->actionQueueStats.averageWaitTime[priority];
+					averageWaitTime = averageWaitTime == 0.0f
+						? waitTime
+						: averageWaitTime * 0.9f + waitTime * 0.1f;
+					this->actionQueueStats.maxWaitTime = max(this->actionQueueStats.maxWaitTime, waitTime);
+
+					action = move(queuedAction.action);
+					actionQueue.pop_front();
+					this->actionQueueStats.actionsPerformed++;
+					break;
+				}
 			}
+
+			if (!action) {
+				break;
+			}
+			action();
+			actionsPerformed++;
 		}
+
+		this->updateBurst();
 	}
 
 	//----------
 	future<Device::PhotoCaptureResult> Device::takePhotoAsync() {
 		EdsError error = EDS_ERR_OK;
 
-		if (this->captureStatus == CaptureStatus::WaitingForPhotoDownload) {
-			//we're already capturing, return a failed capture future
+		if (this->pendingCaptures.size() >= this->maxCapturesInFlight || this->activeBurst.burst) {
+			//too many photos still to come (or a burst is running), return a failed capture future
 			error = EDS_ERR_DEVICE_BUSY;
 		}
 		else {
-			this->captureStatus = CaptureStatus::WaitingForPhotoDownload;
+			PendingCapture pendingCapture;
 
 			//press shutter
 			{
+				pendingCapture.timing.commandIssued = CaptureTiming::Clock::now();
 				error = EdsSendCommand(this->camera, kEdsCameraCommand_TakePicture, 0);
+				pendingCapture.timing.commandReturned = CaptureTiming::Clock::now();
 				if (error != EDS_ERR_OK) {
 					goto failNewCapture;
 				}
 			}
 
-			this->capturePromise = make_unique<promise<PhotoCaptureResult>>();
-			return this->capturePromise->get_future();
+			this->captureStatus = CaptureStatus::WaitingForPhotoDownload;
+			{
+				auto future = pendingCapture.promise.get_future();
+				this->pendingCaptures.push_back(move(pendingCapture));
+				return future;
+			}
 
 		failNewCapture:
-			this->captureStatus = CaptureStatus::CaptureFailed;
+			if (this->pendingCaptures.empty()) {
+				this->captureStatus = CaptureStatus::CaptureFailed;
+			}
 			goto fail;
 		}
 
@@ -152,15 +237,178 @@ namespace ofxCanon {
 		//return failed future
 		promise<PhotoCaptureResult> promiseWeCantKeep;
 		auto future = promiseWeCantKeep.get_future();
-		PhotoCaptureResult result = {
-			nullptr,
-			nullptr,
-			error
-		};
+		PhotoCaptureResult result;
+		result.errorReturned = error;
 		promiseWeCantKeep.set_value(result);
 		return future;
 	}
 
+	//----------
+	void Device::setMaxCapturesInFlight(size_t maxCapturesInFlight) {
+		this->maxCapturesInFlight = max(maxCapturesInFlight, (size_t) 1);
+	}
+
+	//----------
+	size_t Device::getMaxCapturesInFlight() const {
+		return this->maxCapturesInFlight;
+	}
+
+	//----------
+	size_t Device::getCapturesInFlight() const {
+		return this->pendingCaptures.size();
+	}
+
+	//----------
+	void Device::cancelCapturesInFlight() {
+		while (!this->pendingCaptures.empty()) {
+			auto pendingCapture = move(this->pendingCaptures.front());
+			this->pendingCaptures.pop_front();
+
+			PhotoCaptureResult result;
+			result.errorReturned = EDS_ERR_OPERATION_CANCELLED;
+			result.timing = pendingCapture.timing;
+			pendingCapture.promise.set_value(result);
+		}
+
+		if (this->captureStatus == CaptureStatus::WaitingForPhotoDownload) {
+			this->captureStatus = CaptureStatus::CaptureFailed;
+		}
+	}
+
+	//----------
+	shared_ptr<Burst> Device::startBurst(const BurstSettings & settings) {
+		if (!this->pendingCaptures.empty() || this->activeBurst.burst) {
+			logError("Start burst (a capture is already in progress)", EDS_ERR_DEVICE_BUSY);
+			return nullptr;
+		}
+
+		EdsUInt32 previousDriveMode = 0;
+		ERROR_GOTO_FAIL(EdsGetPropertyData(this->camera, kEdsPropID_DriveMode, 0, sizeof(previousDriveMode), &previousDriveMode)
+			, "Get drive mode");
+
+		ERROR_GOTO_FAIL(EdsSetPropertyData(this->camera, kEdsPropID_DriveMode, 0, sizeof(settings.driveMode), &settings.driveMode)
+			, "Set drive mode");
+
+		{
+			auto parameter = settings.autoFocus
+				? kEdsCameraCommand_ShutterButton_Completely
+				: kEdsCameraCommand_ShutterButton_Completely_NonAF;
+			auto error = EdsSendCommand(this->camera, kEdsCameraCommand_PressShutterButton, parameter);
+			if (error != EDS_ERR_OK) {
+				logError("Press shutter button", error);
+				WARNING(EdsSetPropertyData(this->camera, kEdsPropID_DriveMode, 0, sizeof(previousDriveMode), &previousDriveMode)
+					, "Restore drive mode");
+				return nullptr;
+			}
+		}
+
+		{
+			auto burst = make_shared<Burst>(settings);
+			burst->setOnStop([this]() {
+				this->interruptWaitForActions();
+			});
+
+			auto now = chrono::high_resolution_clock::now();
+			this->activeBurst.burst = burst;
+			this->activeBurst.shutterHeld = true;
+			this->activeBurst.previousDriveMode = previousDriveMode;
+			this->activeBurst.framesTaken = 0;
+			this->activeBurst.startTime = now;
+			this->activeBurst.lastEventTime = now;
+			return burst;
+		}
+
+	fail:
+		return nullptr;
+	}
+
+	//----------
+	void Device::stopBurst() {
+		if (this->activeBurst.burst) {
+			this->activeBurst.burst->stop();
+		}
+	}
+
+	//----------
+	shared_ptr<Burst> Device::getBurst() const {
+		return this->activeBurst.burst;
+	}
+
+	//----------
+	bool Device::burstFrameTaken(EdsDirectoryItemRef directoryItem) {
+		auto & burst = this->activeBurst.burst;
+		this->activeBurst.lastEventTime = chrono::high_resolution_clock::now();
+
+		const auto & settings = burst->getSettings();
+		if (settings.frameCount > 0 && this->activeBurst.framesTaken >= settings.frameCount) {
+			// the camera took a few more before it saw the shutter release
+			WARNING(EdsDownloadCancel(directoryItem)
+				, "Cancel download beyond burst frame count");
+			return false;
+		}
+
+		this->activeBurst.framesTaken++;
+		burst->frameTaken();
+
+		if (settings.frameCount > 0 && this->activeBurst.framesTaken >= settings.frameCount) {
+			this->releaseBurstShutter();
+		}
+
+		if (burst->isFull()) {
+			// the consumer is behind, don't transfer this photo at all
+			WARNING(EdsDownloadCancel(directoryItem)
+				, "Cancel download of dropped burst photo");
+			burst->frameDropped();
+			return false;
+		}
+
+		return true;
+	}
+
+	//----------
+	void Device::updateBurst() {
+		if (!this->activeBurst.burst) {
+			return;
+		}
+
+		auto now = chrono::high_resolution_clock::now();
+		if (this->activeBurst.shutterHeld) {
+			auto duration = this->activeBurst.burst->getSettings().duration;
+			if (this->activeBurst.burst->isStopRequested()
+				|| (duration.count() > 0 && now - this->activeBurst.startTime >= duration)) {
+				this->releaseBurstShutter();
+			}
+		}
+		else if (now - this->activeBurst.lastEventTime >= this->activeBurst.burst->getSettings().tailTimeout) {
+			// no more photos are coming
+			this->finishBurst();
+		}
+	}
+
+	//----------
+	void Device::releaseBurstShutter() {
+		if (!this->activeBurst.shutterHeld) {
+			return;
+		}
+		this->activeBurst.shutterHeld = false;
+		this->activeBurst.lastEventTime = chrono::high_resolution_clock::now();
+
+		WARNING(EdsSendCommand(this->camera, kEdsCameraCommand_PressShutterButton, kEdsCameraCommand_ShutterButton_OFF)
+			, "Release shutter button");
+		WARNING(EdsSetPropertyData(this->camera, kEdsPropID_DriveMode, 0, sizeof(this->activeBurst.previousDriveMode), &this->activeBurst.previousDriveMode)
+			, "Restore drive mode");
+	}
+
+	//----------
+	void Device::finishBurst() {
+		if (!this->activeBurst.burst) {
+			return;
+		}
+		this->releaseBurstShutter();
+		this->activeBurst.burst->close();
+		this->activeBurst.burst.reset();
+	}
+
 	//----------
 	void Device::takePhotoToMemoryCard() const {
 		//Set the save-to location to camera
@@ -178,6 +426,17 @@ namespace ofxCanon {
 
 	//----------
 	bool Device::getLiveView(ofPixels & pixels) const {
+		auto encodedBuffer = this->getLiveViewEncoded();
+		if (!encodedBuffer) {
+			return false;
+		}
+
+		// Decode directly from the stream's memory
+		return loadImage(pixels, *encodedBuffer);
+	}
+
+	//----------
+	shared_ptr<EncodedBuffer> Device::getLiveViewEncoded() const {
 		try {
 			if (!this->liveViewEnabled) {
 				ofLogError("ofxCanon") << "Cannot call getLiveView. Please call setLiveViewEnabled(true).";
@@ -188,14 +447,20 @@ namespace ofxCanon {
 			ERROR_THROW(EdsCreateMemoryStream(0, &encodedStream)
 				, "Create memory stream for encoded live view image");
 
+			// The buffer takes ownership of the stream (released if we fail before returning it)
+			auto buffer = make_shared<EncodedBuffer>(encodedStream);
+
 			EdsEvfImageRef evfImage = NULL;
 			ERROR_THROW(EdsCreateEvfImageRef(encodedStream, &evfImage)
 				, "Create EVF iamge reference");
 
 			{
 				auto result = EdsDownloadEvfImage(this->camera, evfImage);
+				if (result != EDS_ERR_OK) {
+					EdsRelease(evfImage);
+				}
 				if (result == EDS_ERR_OBJECT_NOTREADY) {
-					return false;
+					return nullptr;
 				}
 				else {
 					ERROR_THROW(result
@@ -203,20 +468,14 @@ namespace ofxCanon {
 				}
 			}
 
-			auto buffer = getBuffer(encodedStream);
-
-			ofLoadImage(pixels, *buffer);
-
-			ERROR_THROW(EdsRelease(encodedStream)
-				, "Release live view stream");
 			ERROR_THROW(EdsRelease(evfImage)
 				, "Release live view image");
 
-			return true;
+			return buffer;
 		}
 		catch (EdsError) {
 			ofLogError("ofxCanon") << "Poll live view failed";
-			return false;
+			return nullptr;
 		}
 	}
 
@@ -267,19 +526,19 @@ namespace ofxCanon {
 	}
 
 	//----------
-	void Device::performInCameraThread(Action && action) {
+	void Device::performInCameraThread(Action && action, ActionPriority priority) {
 		if (std::this_thread::get_id() == this->cameraThreadId) {
 			// We're already in the camera thread
 			action();
 		}
 		else {
 			// We're calling from another thread, queue the action for later
-			this->actionQueue.send(move(action));
+			this->queueAction(move(action), priority);
 		}
 	}
 
 	//----------
-	void Device::performInCameraThreadBlocking(Action && action) {
+	void Device::performInCameraThreadBlocking(Action && action, ActionPriority priority) {
 		if (this_thread::get_id() == this->cameraThreadId) {
 			// We're already in the camera thread
 			action();
@@ -294,7 +553,7 @@ namespace ofxCanon {
 			};
 
 			//send the action to be performed
-			this->actionQueue.send(move(wrappedAction));
+			this->queueAction(move(wrappedAction), priority);
 
 			// Wait for the return
 			int returnedValue;
@@ -302,6 +561,78 @@ namespace ofxCanon {
 		}
 	}
 
+	//----------
+	bool Device::waitForActions(chrono::microseconds timeout) {
+		auto hasActions = [this]() {
+			for (const auto & actionQueue : this->actionQueues) {
+				if (!actionQueue.empty()) {
+					return true;
+				}
+			}
+			return false;
+		};
+
+		unique_lock<mutex> lock(this->actionQueueMutex);
+		this->actionQueueChanged.wait_for(lock, timeout, [this, &hasActions]() {
+			return hasActions() || this->waitForActionsInterrupted;
+		});
+		this->waitForActionsInterrupted = false;
+		return hasActions();
+	}
+
+	//----------
+	void Device::interruptWaitForActions() {
+		{
+			unique_lock<mutex> lock(this->actionQueueMutex);
+			this->waitForActionsInterrupted = true;
+		}
+		this->actionQueueChanged.notify_all();
+	}
+
+	//----------
+	void Device::setActionBudget(size_t maxActionsPerUpdate, chrono::microseconds maxTimePerUpdate) {
+		unique_lock<mutex> lock(this->actionQueueMutex);
+		this->maxActionsPerUpdate = maxActionsPerUpdate;
+		this->maxTimePerUpdate = maxTimePerUpdate;
+	}
+
+	//----------
+	size_t Device::getMaxActionsPerUpdate() const {
+		unique_lock<mutex> lock(this->actionQueueMutex);
+		return this->maxActionsPerUpdate;
+	}
+
+	//----------
+	chrono::microseconds Device::getMaxTimePerUpdate() const {
+		unique_lock<mutex> lock(this->actionQueueMutex);
+		return this->maxTimePerUpdate;
+	}
+
+	//----------
+	Device::ActionQueueStats Device::getActionQueueStats() const {
+		unique_lock<mutex> lock(this->actionQueueMutex);
+		auto stats = this->actionQueueStats;
+		for (int priority = 0; priority < ActionPriorityCount; priority++) {
+			stats.queueLength[priority] = this->actionQueues[priority].size();
+		}
+		return stats;
+	}
+
+	//----------
+	void Device::queueAction(Action && action, ActionPriority priority) {
+		{
+			unique_lock<mutex> lock(this->actionQueueMutex);
+			this->actionQueues[priority].push_back({ move(action), chrono::high_resolution_clock::now() });
+
+			size_t queueLength = 0;
+			for (const auto & actionQueue : this->actionQueues) {
+				queueLength += actionQueue.size();
+			}
+			this->actionQueueStats.maxQueueLength = max(this->actionQueueStats.maxQueueLength, queueLength);
+		}
+		this->actionQueueChanged.notify_all();
+	}
+
 	//----------
 	void Device::setDownloadEnabled(bool downloadEnabled) {
 		this->downloadEnabled = downloadEnabled;
@@ -313,26 +644,129 @@ namespace ofxCanon {
 	}
 
 	//----------
-	void Device::download(EdsDirectoryItemRef directoryItem) {
+	shared_ptr<BufferPool> Device::getDownloadPool() const {
+		return this->downloadPool;
+	}
+
+	//----------
+	void Device::setDownloadMode(DownloadMode downloadMode) {
+		this->downloadMode = downloadMode;
+	}
+
+	//----------
+	Device::DownloadMode Device::getDownloadMode() const {
+		return this->downloadMode;
+	}
+
+	//----------
+	void Device::setDownloadFileTemplate(const string & downloadFileTemplate) {
+		this->downloadFileTemplate = downloadFileTemplate;
+	}
+
+	//----------
+	const string & Device::getDownloadFileTemplate() const {
+		return this->downloadFileTemplate;
+	}
+
+	//----------
+	void Device::setDownloadFileIndex(int downloadFileIndex) {
+		this->downloadFileIndex = downloadFileIndex;
+	}
+
+	//----------
+	int Device::getDownloadFileIndex() const {
+		return this->downloadFileIndex;
+	}
+
+	//----------
+	void Device::setDownloadSink(const DownloadSink & downloadSink) {
+		this->downloadSink = downloadSink;
+	}
+
+	//----------
+	void Device::download(EdsDirectoryItemRef directoryItem, CaptureTiming::Clock::time_point transferRequested) {
 		if (!this->downloadEnabled) {
 			// e.g. just save to memory card
 			return;
 		}
 
+		// photos which aren't for a takePhotoAsync capture belong to the burst (if one is running)
+		bool forBurst = this->pendingCaptures.empty() && this->activeBurst.burst;
+		if (forBurst && !this->burstFrameTaken(directoryItem)) {
+			return;
+		}
+
 		PhotoCaptureResult photoCaptureAsyncResult;
+		if (!this->pendingCaptures.empty()) {
+			// this is the photo for the oldest capture we're waiting on
+			photoCaptureAsyncResult.timing = this->pendingCaptures.front().timing;
+		}
+		photoCaptureAsyncResult.timing.transferRequested = transferRequested;
+		photoCaptureAsyncResult.timing.downloadStarted = CaptureTiming::Clock::now();
 		try {
 			EdsDirectoryItemInfo directoryItemInfo;
-			EdsStreamRef encodedStream = NULL;
+			shared_ptr<EncodedBuffer> buffer;
+			shared_ptr<PhotoMetadata> metaData;
 
 			ERROR_THROW(EdsGetDirectoryItemInfo(directoryItem, &directoryItemInfo)
 				, "Get directory item info");
 
+			// NOTE : The Canon SDK does not provide decoding of RAW images for all its cameras, especially in 64bit
+			// Therefore we use freeimage to perform this function (i.e. openFrameworks' built in functions),
+			//	which do not offer functions such as getting the lens properties.
+
 			//download image
+			switch (this->downloadMode) {
+			case DownloadMode::DownloadToFile:
 			{
-				ERROR_THROW(EdsCreateMemoryStream(0, &encodedStream)
+				auto path = this->getDownloadFilePath(directoryItemInfo);
+				ofDirectory::createDirectory(ofFilePath::getEnclosingDirectory(path, false), false, true);
+
+				// The SDK writes directly into the file, so the photo never sits fully in memory
+				EdsStreamRef fileStream = NULL;
+				ERROR_THROW(EdsCreateFileStream(path.c_str(), kEdsFileCreateDisposition_CreateAlways, kEdsAccess_ReadWrite, &fileStream)
+					, "Create file stream for " + path);
+				auto error = EdsDownload(directoryItem, directoryItemInfo.size, fileStream);
+				if (error == EDS_ERR_OK) {
+					metaData = readMetadata(fileStream);
+				}
+				EdsRelease(fileStream);
+				ERROR_THROW(error
+					, "Download directory item to file");
+
+				photoCaptureAsyncResult.savedFilePath = path;
+				this->downloadFileIndex++;
+				break;
+			}
+			case DownloadMode::DownloadToSink:
+			{
+				this->downloadToSink(directoryItem, directoryItemInfo);
+				break;
+			}
+			case DownloadMode::DownloadToMemory:
+			default:
+			{
+				EdsStreamRef encodedStream = NULL;
+
+				// Reuse a block from a previous download rather than growing a new memory stream
+				auto block = this->downloadPool->acquire((size_t)directoryItemInfo.size);
+				ERROR_THROW(EdsCreateMemoryStreamFromPointer(block.data.get(), directoryItemInfo.size, &encodedStream)
 					, "Create memory stream for encoded image");
+
+				// The buffer owns the stream from here on (so it's also released if the download fails)
+				// The photo data is never copied out of the stream's memory.
+				buffer = make_shared<EncodedBuffer>(encodedStream, move(block), this->downloadPool);
+
 				ERROR_THROW(EdsDownload(directoryItem, directoryItemInfo.size, encodedStream)
 					, "Download directory item");
+
+				//attempt to read metadata from the image reference
+				metaData = readMetadata(encodedStream);
+				break;
+			}
+			}
+
+			{
 				ERROR_THROW(EdsDownloadComplete(directoryItem)
 					, "Download complete");
 				
@@ -344,68 +778,99 @@ namespace ofxCanon {
 				//	, "Delete directory item");
 			}
 
-			// NOTE : The Canon SDK does not provide decoding of RAW images for all its cameras, especially in 64bit
-			// Therefore we use freeimage to perform this function (i.e. openFrameworks' built in functions),
-			//	which do not offer functions such as getting the lens properties.
-
-			auto buffer = getBuffer(encodedStream);
-
-			//attempt to read metadata from the image reference
-			EdsImageRef imageRef = NULL;
-			shared_ptr<PhotoMetadata> metaData;
-			{
-				try {
-					ERROR_THROW(EdsCreateImageRef(encodedStream, &imageRef)
-						, "Create image reference from incoming stream for metadata purposes (Unsupported for CR2 on some camera models especially in x64)");
-					vector<EdsRational> value(3);
-					ERROR_THROW(EdsGetPropertyData(imageRef, kEdsPropID_FocalLength, 0, sizeof(EdsRational) * 3, value.data())
-						, "Get focal length data from image");
-					metaData = make_shared<PhotoMetadata>();
-					metaData->focalLength.minimumFocalLength = rationalToFloat(value[1]);
-					metaData->focalLength.currentFocalLength = rationalToFloat(value[0]);
-					metaData->focalLength.maximumFocalLength = rationalToFloat(value[2]);
-
-					ERROR_THROW(EdsRelease(imageRef)
-						, "Release downloaded image");
-				}
-				catch (EdsError) {
-					//this generally happens when the image is RAW and the SDK can't process it
-				}
-			}
-
-			//release the objects
-			ERROR_THROW(EdsRelease(encodedStream)
-				, "Release encoded stream");
-
 			photoCaptureAsyncResult.errorReturned = EDS_ERR_OK;
 			photoCaptureAsyncResult.encodedBuffer = buffer;
 			photoCaptureAsyncResult.metaData = metaData;
+			photoCaptureAsyncResult.timing.downloadCompleted = CaptureTiming::Clock::now();
 
 			//if we've got an async listener waiting for a photo
-			if (this->capturePromise) {
+			if (!this->pendingCaptures.empty()) {
 				this->hasDownloadedFirstPhoto = true;
-				this->captureStatus = CaptureStatus::CaptureSucceeded;
 
-				this->capturePromise->set_value(photoCaptureAsyncResult);
-				this->capturePromise.reset();
+				auto pendingCapture = move(this->pendingCaptures.front());
+				this->pendingCaptures.pop_front();
+				this->captureStatus = this->pendingCaptures.empty()
+					? CaptureStatus::CaptureSucceeded
+					: CaptureStatus::WaitingForPhotoDownload;
+
+				pendingCapture.promise.set_value(photoCaptureAsyncResult);
+			}
+			else if (forBurst) {
+				this->activeBurst.burst->push(move(photoCaptureAsyncResult));
 			}
 			else {
 				this->onUnrequestedPhotoReceived.notify(this, photoCaptureAsyncResult);
 			}
 		}
 		catch (EdsError error) {
-			this->captureStatus = CaptureStatus::CaptureFailed;
-
 			//if we've got an async listener waiting for a photo
-			if (this->capturePromise) {
+			if (!this->pendingCaptures.empty()) {
 				photoCaptureAsyncResult.errorReturned = error;
+				photoCaptureAsyncResult.timing.downloadCompleted = CaptureTiming::Clock::now();
 
-				this->capturePromise->set_value(photoCaptureAsyncResult);
-				this->capturePromise.reset();
+				auto pendingCapture = move(this->pendingCaptures.front());
+				this->pendingCaptures.pop_front();
+				this->captureStatus = this->pendingCaptures.empty()
+					? CaptureStatus::CaptureFailed
+					: CaptureStatus::WaitingForPhotoDownload;
+
+				pendingCapture.promise.set_value(photoCaptureAsyncResult);
+			}
+			else {
+				this->captureStatus = CaptureStatus::CaptureFailed;
+				if (forBurst) {
+					this->activeBurst.burst->frameFailed();
+				}
 			}
 		}
 	}
 
+	//----------
+	void Device::downloadToSink(EdsDirectoryItemRef directoryItem, const EdsDirectoryItemInfo & directoryItemInfo) {
+		if (!this->downloadSink) {
+			logError("Download to sink (no sink has been set)", EDS_ERR_INVALID_PARAMETER);
+			throw((EdsError)EDS_ERR_INVALID_PARAMETER);
+		}
+
+		// Each chunk is downloaded into the same block of memory (which comes from / returns to the download pool)
+		EdsStreamRef chunkStream = NULL;
+		auto block = this->downloadPool->acquire((size_t)DOWNLOAD_CHUNK_SIZE);
+		ERROR_THROW(EdsCreateMemoryStreamFromPointer(block.data.get(), DOWNLOAD_CHUNK_SIZE, &chunkStream)
+			, "Create memory stream for download chunk");
+		EncodedBuffer chunkBuffer(chunkStream, move(block), this->downloadPool);
+
+		EdsUInt64 offset = 0;
+		while (offset < directoryItemInfo.size) {
+			auto chunkSize = min(DOWNLOAD_CHUNK_SIZE, directoryItemInfo.size - offset);
+
+			ERROR_THROW(EdsSeek(chunkStream, 0, kEdsSeek_Begin)
+				, "Rewind download chunk stream");
+			ERROR_THROW(EdsDownload(directoryItem, chunkSize, chunkStream)
+				, "Download directory item chunk");
+
+			if (!this->downloadSink(directoryItemInfo, chunkBuffer.getData(), (size_t)chunkSize, offset)) {
+				WARNING(EdsDownloadCancel(directoryItem)
+					, "Cancel download");
+				logError("Download to sink (cancelled by sink)", EDS_ERR_OPERATION_CANCELLED);
+				throw((EdsError)EDS_ERR_OPERATION_CANCELLED);
+			}
+
+			offset += chunkSize;
+		}
+	}
+
+	//----------
+	string Device::getDownloadFilePath(const EdsDirectoryItemInfo & directoryItemInfo) const {
+		auto cameraFileName = string(directoryItemInfo.szFileName);
+
+		auto path = this->downloadFileTemplate;
+		ofStringReplace(path, "{index}", ofToString(this->downloadFileIndex, 6, '0'));
+		ofStringReplace(path, "{name}", ofFilePath::removeExt(cameraFileName));
+		ofStringReplace(path, "{ext}", ofToLower(ofFilePath::getFileExt(cameraFileName)));
+
+		return ofToDataPath(path, true);
+	}
+
 	//----------
 	void Device::lensChanged() {
 		auto lensStatus = this->getProperty<EdsUInt32>(kEdsPropID_LensStatus);
@@ -433,6 +898,51 @@ namespace ofxCanon {
 		parameter.enableEvents();
 	}
 
+	//----------
+	void Device::markPropertyDirty(EdsPropertyID propertyID) {
+		{
+			unique_lock<mutex> lock(this->dirtyPropertiesMutex);
+			this->propertyEventStats.eventsReceived++;
+
+			if (find(this->dirtyProperties.begin(), this->dirtyProperties.end(), propertyID) != this->dirtyProperties.end()) {
+				// Already waiting to be polled
+				this->propertyEventStats.eventsMerged++;
+				return;
+			}
+
+			this->dirtyProperties.push_back(propertyID);
+			if (this->dirtyProperties.size() > 1) {
+				// A poll is already queued
+				return;
+			}
+		}
+
+		// Always queue (even on the camera thread, where events arrive during EdsGetEvent) so that repeated events merge before the poll
+		this->queueAction([this]() {
+			this->pollDirtyProperties();
+		}, LowPriority);
+	}
+
+	//----------
+	void Device::pollDirtyProperties() {
+		vector<EdsPropertyID> propertyIDs;
+		{
+			unique_lock<mutex> lock(this->dirtyPropertiesMutex);
+			swap(propertyIDs, this->dirtyProperties);
+			this->propertyEventStats.propertiesPolled += propertyIDs.size();
+		}
+
+		for (auto propertyID : propertyIDs) {
+			this->pollProperty(propertyID);
+		}
+	}
+
+	//----------
+	Device::PropertyEventStats Device::getPropertyEventStats() const {
+		unique_lock<mutex> lock(this->dirtyPropertiesMutex);
+		return this->propertyEventStats;
+	}
+
 	//----------
 	void Device::pollProperty(EdsPropertyID propertyID) {
 		switch (propertyID) {
@@ -557,54 +1067,64 @@ namespace ofxCanon {
 	}
 
 	//----------
-	vector<int> Device::getISOOptions() const {
-		vector<int> options;
+	template<typename T>
+	const Device::CachedOptions<T> & Device::getCachedOptions(CachedOptions<T> & cachedOptions, EdsPropertyID propertyID, T (*decode)(EdsUInt32)) const {
+		if (!cachedOptions.valid) {
+			cachedOptions.options.clear();
+			cachedOptions.sortedOptions.clear();
 
-		EdsPropertyDesc propertyDescription;
+			EdsPropertyDesc propertyDescription;
 
-		ERROR_GOTO_FAIL(EdsGetPropertyDesc(this->camera, kEdsPropID_ISOSpeed, &propertyDescription)
-			, "Get property description");
+			ERROR_GOTO_FAIL(EdsGetPropertyDesc(this->camera, propertyID, &propertyDescription)
+				, "Get property description");
 
-		for (int i = 0; i < propertyDescription.numElements; i++) {
-			options.push_back(decodeISO(propertyDescription.propDesc[i]));
+			for (int i = 0; i < propertyDescription.numElements; i++) {
+				cachedOptions.options.push_back(decode(propertyDescription.propDesc[i]));
+			}
+			// Leave out Auto / Bulb (decoded as 0) so that findClosest never rounds to them
+			for (const auto & option : cachedOptions.options) {
+				if (option != 0) {
+					cachedOptions.sortedOptions.push_back(option);
+				}
+			}
+			sort(cachedOptions.sortedOptions.begin(), cachedOptions.sortedOptions.end());
+			cachedOptions.valid = true;
 		}
 
 	fail:
-		return options;
+		return cachedOptions;
 	}
 
 	//----------
-	vector<float> Device::getApertureOptions() const {
-		vector<float> options;
-
-		EdsPropertyDesc propertyDescription;
-
-		ERROR_GOTO_FAIL(EdsGetPropertyDesc(this->camera, kEdsPropID_Av, &propertyDescription)
-			, "Get property description");
-
-		for (int i = 0; i < propertyDescription.numElements; i++) {
-			options.push_back(decodeAperture(propertyDescription.propDesc[i]));
+	void Device::invalidateOptions(EdsPropertyID propertyID) {
+		unique_lock<mutex> lock(this->optionsMutex);
+		if (propertyID == kEdsPropID_ISOSpeed || propertyID == kEdsPropID_Unknown) {
+			this->ISOOptions.valid = false;
+		}
+		if (propertyID == kEdsPropID_Av || propertyID == kEdsPropID_Unknown) {
+			this->apertureOptions.valid = false;
+		}
+		if (propertyID == kEdsPropID_Tv || propertyID == kEdsPropID_Unknown) {
+			this->shutterSpeedOptions.valid = false;
 		}
-
-	fail:
-		return options;
 	}
 
 	//----------
-	vector<float> Device::getShutterSpeedOptions() const {
-		vector<float> options;
-
-		EdsPropertyDesc propertyDescription;
-
-		ERROR_GOTO_FAIL(EdsGetPropertyDesc(this->camera, kEdsPropID_Tv, &propertyDescription)
-			, "Get property description");
+	vector<int> Device::getISOOptions() const {
+		unique_lock<mutex> lock(this->optionsMutex);
+		return this->getCachedOptions(this->ISOOptions, kEdsPropID_ISOSpeed, decodeISO).options;
+	}
 
-		for (int i = 0; i < propertyDescription.numElements; i++) {
-			options.push_back(decodeShutterSpeed(propertyDescription.propDesc[i]));
-		}
+	//----------
+	vector<float> Device::getApertureOptions() const {
+		unique_lock<mutex> lock(this->optionsMutex);
+		return this->getCachedOptions(this->apertureOptions, kEdsPropID_Av, decodeAperture).options;
+	}
 
-	fail:
-		return options;
+	//----------
+	vector<float> Device::getShutterSpeedOptions() const {
+		unique_lock<mutex> lock(this->optionsMutex);
+		return this->getCachedOptions(this->shutterSpeedOptions, kEdsPropID_Tv, decodeShutterSpeed).options;
 	}
 
 	//----------
@@ -614,25 +1134,32 @@ namespace ofxCanon {
 
 	//----------
 	template<typename T>
-	T findClosestOption(const T & value, const vector<T> & options) {
-		T bestDistance = std::numeric_limits<T>::max();
-		T bestOption = value;
+	T findClosestOption(const T & value, const vector<T> & sortedOptions) {
+		// Auto / Bulb are only chosen when asked for (sortedOptions leaves them out)
+		if (sortedOptions.empty() || value == 0) {
+			return value;
+		}
 
-		for (const auto & option : options) {
-			auto distance = abs(option - value);
-			if (distance < bestDistance) {
-				bestDistance = distance;
-				bestOption = option;
-			}
+		auto upper = lower_bound(sortedOptions.begin(), sortedOptions.end(), value);
+		if (upper == sortedOptions.begin()) {
+			return *upper;
+		}
+		if (upper == sortedOptions.end()) {
+			return sortedOptions.back();
 		}
 
-		return bestOption;
+		// Between two options, the lower one wins a tie
+		auto lower = upper - 1;
+		return value - *lower <= *upper - value
+			? *lower
+			: *upper;
 	}
 
 	//----------
 	void Device::setISO(int ISO, bool findClosest) {
 		if (findClosest) {
-			ISO = findClosestOption(ISO, this->getISOOptions());
+			unique_lock<mutex> lock(this->optionsMutex);
+			ISO = findClosestOption(ISO, this->getCachedOptions(this->ISOOptions, kEdsPropID_ISOSpeed, decodeISO).sortedOptions);
 		}
 		this->parameters.ISO = ISO;
 	}
@@ -645,7 +1172,8 @@ namespace ofxCanon {
 	//----------
 	void Device::setAperture(float aperture, bool findClosest) {
 		if (findClosest) {
-			aperture = findClosestOption(aperture, this->getApertureOptions());
+			unique_lock<mutex> lock(this->optionsMutex);
+			aperture = findClosestOption(aperture, this->getCachedOptions(this->apertureOptions, kEdsPropID_Av, decodeAperture).sortedOptions);
 		}
 		this->parameters.aperture = aperture;
 	}
@@ -658,7 +1186,8 @@ namespace ofxCanon {
 	//----------
 	void Device::setShutterSpeed(float shutterSpeed, bool findClosest) {
 		if (findClosest) {
-			shutterSpeed = findClosestOption(shutterSpeed, this->getShutterSpeedOptions());
+			unique_lock<mutex> lock(this->optionsMutex);
+			shutterSpeed = findClosestOption(shutterSpeed, this->getCachedOptions(this->shutterSpeedOptions, kEdsPropID_Tv, decodeShutterSpeed).sortedOptions);
 		}
 		this->parameters.shutterSpeed = shutterSpeed;
 	}
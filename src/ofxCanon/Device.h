@@ -2,6 +2,7 @@
 
 #include "Utils.h"
 #include "Handlers.h"
+#include "EncodedBuffer.h"
 
 #include "ofPixels.h"
 #include "ofParameter.h"
@@ -13,8 +14,12 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 
 namespace ofxCanon {
+	class Burst;
 
 	/*
 		A blocking implementation of an EDSDK Camera Device.
@@ -74,10 +79,46 @@ namespace ofxCanon {
 			CaptureSucceeded
 		};
 
+		enum DownloadMode {
+			DownloadToMemory, // photo data is held in PhotoCaptureResult::encodedBuffer
+			DownloadToFile, // photo is streamed to disk, path is in PhotoCaptureResult::savedFilePath
+			DownloadToSink // photo is streamed in chunks to the DownloadSink
+		};
+
+		// Called in the camera thread with each chunk of the file. Return false to cancel the download.
+		typedef std::function<bool(const EdsDirectoryItemInfo &, const char * data, size_t size, uint64_t offset)> DownloadSink;
+
+		// Timestamps through a capture (monotonic clock). Unset times are left at the clock's epoch
+		// (e.g. photos taken with the camera's own shutter button have no command times).
+		struct CaptureTiming {
+			typedef std::chrono::steady_clock Clock;
+
+			Clock::time_point commandIssued; // just before the capture command was sent
+			Clock::time_point commandReturned; // when the capture command returned
+			Clock::time_point transferRequested; // when the camera announced the photo (e.g. DirItemRequestTransfer)
+			Clock::time_point downloadStarted; // when the camera thread started the download
+			Clock::time_point downloadCompleted;
+
+			bool hasCommand() const {
+				return this->commandIssued != Clock::time_point();
+			}
+		};
+
+		struct BurstSettings {
+			EdsUInt32 driveMode = 0x01; // kEdsPropID_DriveMode value, e.g. 0x01 continuous, 0x04 high speed continuous (camera dependent)
+			size_t frameCount = 0; // release the shutter after this many photos (0 for no limit)
+			std::chrono::milliseconds duration{ 0 }; // release the shutter after this long (0 for no limit)
+			size_t capacity = 8; // photos waiting to be received before further photos are dropped
+			bool autoFocus = false; // false presses the shutter without AF (NonAF)
+			std::chrono::milliseconds tailTimeout{ 2000 }; // after the shutter is released, wait this long for any last photos
+		};
+
 		struct PhotoCaptureResult {
-			std::shared_ptr<ofBuffer> encodedBuffer;
+			std::shared_ptr<EncodedBuffer> encodedBuffer; // e.g. JPEG or RAW file data (owns the EDSDK stream, no copy)
 			std::shared_ptr<PhotoMetadata> metaData;
 			EdsError errorReturned = EDS_ERR_OBJECT_NOTREADY;
+			std::string savedFilePath; // only when using DownloadToFile
+			CaptureTiming timing;
 
 			operator bool() const {
 				return this->errorReturned == EDS_ERR_OK;
@@ -96,12 +137,33 @@ namespace ofxCanon {
 		void close();
 		void update();
 
+		// Fails with EDS_ERR_DEVICE_BUSY if maxCapturesInFlight photos are already waiting to be downloaded
 		std::future<PhotoCaptureResult> takePhotoAsync();
 		void takePhotoToMemoryCard() const;
 
+		// How many takePhotoAsync captures may wait for their photos at once (default 1).
+		// With more than 1, the next shutter command can be sent while the previous photo is still downloading.
+		// Photos are matched to captures in the order they arrive from the camera.
+		void setMaxCapturesInFlight(size_t);
+		size_t getMaxCapturesInFlight() const;
+		size_t getCapturesInFlight() const;
+
+		// Fail all captures still waiting for photos with EDS_ERR_OPERATION_CANCELLED (e.g. after a timeout)
+		// Photos which arrive later are treated as unrequested
+		void cancelCapturesInFlight();
+
+		// Set the drive mode and hold the shutter down until frameCount / duration is reached or the burst is stopped.
+		// Photos are delivered through the returned Burst as they are downloaded (see Burst.h).
+		// The drive mode is restored when the shutter is released. Limits are checked in update().
+		// Returns nullptr if a capture or burst is already in progress, or if the camera refuses.
+		std::shared_ptr<Burst> startBurst(const BurstSettings &);
+		void stopBurst();
+		std::shared_ptr<Burst> getBurst() const; // nullptr if no burst is running
+
 		// take photo and wait until complete
 		// pass in your own ofPixels or ofShortPixels (i.e. for 8bit and 16bit images)
 		// NOTE : this function is only compatible with the main thread (since it uses glfwPollEvents), you must use takePhotoAsync otherwise
+		// With DownloadToFile the photo is loaded back from savedFilePath. With DownloadToSink nothing is decoded and pixelsOut is left untouched.
 		template<typename PixelsType>
 		PhotoCaptureResult takePhoto(ofPixels_<PixelsType> & pixelsOut) {
 			auto future = this->takePhotoAsync();
@@ -112,17 +174,24 @@ namespace ofxCanon {
 
 			auto result = future.get();
 			if (result.errorReturned == EDS_ERR_OK) {
-				ofLoadImage(pixelsOut, *result.encodedBuffer);
+				if (result.encodedBuffer) {
+					loadImage(pixelsOut, *result.encodedBuffer);
+				}
+				else if (!result.savedFilePath.empty()) {
+					ofLoadImage(pixelsOut, result.savedFilePath);
+				}
 			}
 			return result;
 		}
 
 		bool getLiveView(ofPixels &) const;
+		std::shared_ptr<EncodedBuffer> getLiveViewEncoded() const; // JPEG bytes only, decode later with loadImage. nullptr if no frame is ready.
 
 		CaptureStatus getCaptureStatus() const;
 
 		ofParameterGroup & getParameters();
 
+		// Options are read from the camera once and cached until the camera reports that the property description has changed
 		std::vector<std::string> getOptions(const ofAbstractParameter &) const;
 		std::vector<int> getISOOptions() const;
 		std::vector<float> getApertureOptions() const;
@@ -173,12 +242,71 @@ namespace ofxCanon {
 		void setLogDeviceCallbacks(bool);
 
 		typedef std::function<void()> Action;
-		void performInCameraThread(Action &&);
-		void performInCameraThreadBlocking(Action &&);
+
+		// Queued actions are performed highest priority first (and in order within a priority)
+		enum ActionPriority {
+			HighPriority, // e.g. photo downloads
+			NormalPriority,
+			LowPriority, // e.g. property polls
+			ActionPriorityCount
+		};
+
+		struct ActionQueueStats {
+			size_t queueLength[ActionPriorityCount] = { 0 }; // actions currently waiting
+			size_t maxQueueLength = 0; // longest total queue seen
+			uint64_t actionsPerformed = 0;
+			uint64_t updatesOverBudget = 0; // update() returned with actions still waiting
+			float averageWaitTime[ActionPriorityCount] = { 0.0f }; // smoothed ms from queuing until performed
+			float maxWaitTime = 0.0f; // ms
+		};
+
+		void performInCameraThread(Action &&, ActionPriority = NormalPriority);
+		void performInCameraThreadBlocking(Action &&, ActionPriority = NormalPriority);
+
+		// Each update() performs queued actions until either budget is used (0 for no limit)
+		// At least one action is performed per update
+		void setActionBudget(size_t maxActionsPerUpdate, std::chrono::microseconds maxTimePerUpdate);
+		size_t getMaxActionsPerUpdate() const;
+		std::chrono::microseconds getMaxTimePerUpdate() const;
+
+		ActionQueueStats getActionQueueStats() const;
+
+		struct PropertyEventStats {
+			uint64_t eventsReceived = 0; // property changed events from the camera
+			uint64_t eventsMerged = 0; // events for a property which was already waiting to be polled
+			uint64_t propertiesPolled = 0;
+		};
+		PropertyEventStats getPropertyEventStats() const;
+
+		// Call from the camera thread to sleep until an action is queued (or the timeout passes).
+		// Returns true if there are actions waiting to be performed by update().
+		bool waitForActions(std::chrono::microseconds timeout);
+
+		// Wake the camera thread from waitForActions without queuing an action (e.g. when closing)
+		void interruptWaitForActions();
 
 		void setDownloadEnabled(bool);
 		bool getDownloadEnabled() const;
 
+		// Photos are downloaded into blocks from this pool, which are recycled once the PhotoCaptureResult is released
+		// Use getDownloadPool()->setMaxPooledBytes(..) to limit idle memory, and getStats() for hits / misses
+		std::shared_ptr<BufferPool> getDownloadPool() const;
+
+		void setDownloadMode(DownloadMode);
+		DownloadMode getDownloadMode() const;
+
+		// Used with DownloadToFile, relative to the data folder. Tokens :
+		//	{index}	: the download file index as 6 digits, e.g. 000042 (increments after each saved file)
+		//	{name}	: the file name given by the camera without extension, e.g. IMG_0042
+		//	{ext}	: the file extension given by the camera in lower case, e.g. cr3
+		// e.g. "Sessions/Timelapse/{index}.{ext}"
+		void setDownloadFileTemplate(const std::string &);
+		const std::string & getDownloadFileTemplate() const;
+		void setDownloadFileIndex(int);
+		int getDownloadFileIndex() const;
+
+		void setDownloadSink(const DownloadSink &);
+
 		//these events will always fire in the camera thread
 		ofEvent<EdsPropertyID> onParameterOptionsChange;
 		ofEvent<LensInfo> onLensChange;
@@ -188,31 +316,96 @@ namespace ofxCanon {
 
 		std::thread::id cameraThreadId;
 
-		void download(EdsDirectoryItemRef);
+		void download(EdsDirectoryItemRef, CaptureTiming::Clock::time_point transferRequested);
+		void downloadToSink(EdsDirectoryItemRef, const EdsDirectoryItemInfo &);
+		std::string getDownloadFilePath(const EdsDirectoryItemInfo &) const;
 
 		void lensChanged();
 
 		void pollProperty(EdsPropertyID);
 
+		template<typename T>
+		struct CachedOptions {
+			std::vector<T> options; // in the order the camera lists them
+			std::vector<T> sortedOptions; // for finding the closest option
+			bool valid = false;
+		};
+
+		template<typename T>
+		const CachedOptions<T> & getCachedOptions(CachedOptions<T> &, EdsPropertyID, T (*decode)(EdsUInt32)) const;
+		void invalidateOptions(EdsPropertyID = kEdsPropID_Unknown); // kEdsPropID_Unknown for all
+
+		// Property changed events mark the property as dirty, and dirty properties are polled once per camera thread update
+		void markPropertyDirty(EdsPropertyID);
+		void pollDirtyProperties();
+
 		void callbackISOParameterChanged(int &);
 		void callbackApertureParameterChanged(float &);
 		void callbackShutterSpeedParameterChanged(float &);
 
 		EdsCameraRef camera = NULL;
 		bool downloadEnabled = true;
+		std::shared_ptr<BufferPool> downloadPool = std::make_shared<BufferPool>();
+		DownloadMode downloadMode = DownloadMode::DownloadToMemory;
+		std::string downloadFileTemplate = "{name}.{ext}";
+		int downloadFileIndex = 0;
+		DownloadSink downloadSink;
 		bool isOpen = false;
 		bool logDeviceCallbacks = false;
 		bool hasDownloadedFirstPhoto = false;
 		CaptureStatus captureStatus = CaptureStatus::NoCaptureTriggered;
-		std::unique_ptr<std::promise<PhotoCaptureResult>> capturePromise;
+
+		// Captures waiting for their photos, oldest first
+		struct PendingCapture {
+			std::promise<PhotoCaptureResult> promise;
+			CaptureTiming timing;
+		};
+		std::deque<PendingCapture> pendingCaptures;
+		size_t maxCapturesInFlight = 1;
+
+		// Returns false if the photo shouldn't be downloaded (dropped or beyond frameCount)
+		bool burstFrameTaken(EdsDirectoryItemRef);
+		void updateBurst();
+		void releaseBurstShutter();
+		void finishBurst();
+
+		struct ActiveBurst {
+			std::shared_ptr<Burst> burst;
+			bool shutterHeld = false;
+			EdsUInt32 previousDriveMode = 0;
+			uint64_t framesTaken = 0;
+			std::chrono::high_resolution_clock::time_point startTime;
+			std::chrono::high_resolution_clock::time_point lastEventTime; // shutter released or photo arrived
+		} activeBurst;
 
 		DeviceInfo deviceInfo;
 		LensInfo lensInfo;
 
-		ofThreadChannel<Action> actionQueue;
+		struct QueuedAction {
+			Action action;
+			std::chrono::high_resolution_clock::time_point timeQueued;
+		};
+		void queueAction(Action &&, ActionPriority);
+
+		std::deque<QueuedAction> actionQueues[ActionPriorityCount];
+		size_t maxActionsPerUpdate = 0;
+		std::chrono::microseconds maxTimePerUpdate{ 10000 };
+		ActionQueueStats actionQueueStats;
+		mutable std::mutex actionQueueMutex;
+		std::condition_variable actionQueueChanged;
+		bool waitForActionsInterrupted = false;
 
 		bool liveViewEnabled = false;
 
+		mutable CachedOptions<int> ISOOptions;
+		mutable CachedOptions<float> apertureOptions;
+		mutable CachedOptions<float> shutterSpeedOptions;
+		mutable std::mutex optionsMutex;
+
+		std::vector<EdsPropertyID> dirtyProperties; // in the order they were first changed
+		PropertyEventStats propertyEventStats;
+		mutable std::mutex dirtyPropertiesMutex;
+
 #ifndef PARAM_DECLARE
 		// Syntactic sugar which enables struct-ofParameterGroup
 #define PARAM_DECLARE(NAME, ...) bool paramDeclareConstructor \
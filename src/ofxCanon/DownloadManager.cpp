@@ -0,0 +1,301 @@
+#include "DownloadManager.h"
+#include "Utils.h"
+
+#include <fstream>
+
+using namespace std;
+
+// Wait between attempts doubles from this, up to RETRY_BACKOFF_MAX
+#define RETRY_BACKOFF_MIN chrono::milliseconds(100)
+#define RETRY_BACKOFF_MAX chrono::milliseconds(2000)
+
+#define STALL_TIMEOUT_SECONDS 10.0f
+
+namespace ofxCanon {
+	//----------
+	DownloadManager::DownloadManager(size_t threadCount) {
+		if (threadCount < 1) {
+			threadCount = 1;
+		}
+		for (size_t i = 0; i < threadCount; i++) {
+			this->workers.emplace_back(new Worker());
+		}
+		for (auto & worker : this->workers) {
+			auto workerPointer = worker.get();
+			worker->thread = thread([this, workerPointer]() {
+				this->workerLoop(*workerPointer);
+			});
+		}
+	}
+
+	//----------
+	DownloadManager::~DownloadManager() {
+		{
+			unique_lock<mutex> lock(this->jobsMutex);
+			this->closeThreads = true;
+			for (auto & worker : this->workers) {
+				worker->client.setCancelled(true);
+			}
+		}
+		this->jobsChanged.notify_all();
+
+		for (auto & worker : this->workers) {
+			if (worker->thread.joinable()) {
+				worker->thread.join();
+			}
+		}
+	}
+
+	//----------
+	size_t DownloadManager::getThreadCount() const {
+		return this->workers.size();
+	}
+
+	//----------
+	void DownloadManager::setMaxAttempts(size_t maxAttempts) {
+		unique_lock<mutex> lock(this->jobsMutex);
+		this->maxAttempts = max(maxAttempts, (size_t) 1);
+	}
+
+	//----------
+	size_t DownloadManager::getMaxAttempts() const {
+		unique_lock<mutex> lock(this->jobsMutex);
+		return this->maxAttempts;
+	}
+
+	//----------
+	void DownloadManager::add(const Request & request) {
+		{
+			unique_lock<mutex> lock(this->jobsMutex);
+			Job job;
+			job.request = request;
+			job.timeAdded = Clock::now();
+			this->jobs[request.priority].push_back(move(job));
+		}
+		this->jobsChanged.notify_one();
+	}
+
+	//----------
+	bool DownloadManager::receive(Result & result) {
+		unique_lock<mutex> lock(this->jobsMutex);
+		if (this->results.empty()) {
+			return false;
+		}
+		result = move(this->results.front());
+		this->results.pop_front();
+		return true;
+	}
+
+	//----------
+	void DownloadManager::cancelAll() {
+		unique_lock<mutex> lock(this->jobsMutex);
+		for (auto & jobs : this->jobs) {
+			jobs.clear();
+		}
+
+		// Workers clear this when they take their next job
+		for (auto & worker : this->workers) {
+			worker->client.setCancelled(true);
+		}
+	}
+
+	//----------
+	DownloadManager::Stats DownloadManager::getStats() const {
+		unique_lock<mutex> lock(this->jobsMutex);
+		auto stats = this->stats;
+		for (int priority = 0; priority < PriorityCount; priority++) {
+			stats.queueLength[priority] = this->jobs[priority].size();
+		}
+		return stats;
+	}
+
+	//----------
+	void DownloadManager::workerLoop(Worker & worker) {
+		while (true) {
+			Job job;
+			{
+				unique_lock<mutex> lock(this->jobsMutex);
+				this->jobsChanged.wait(lock, [this]() {
+					if (this->closeThreads) {
+						return true;
+					}
+					for (const auto & jobs : this->jobs) {
+						if (!jobs.empty()) {
+							return true;
+						}
+					}
+					return false;
+				});
+
+				if (this->closeThreads) {
+					break;
+				}
+
+				// highest priority first
+				for (auto & jobs : this->jobs) {
+					if (!jobs.empty()) {
+						job = move(jobs.front());
+						jobs.pop_front();
+						break;
+					}
+				}
+
+				worker.client.setCancelled(false);
+				this->stats.activeDownloads++;
+			}
+
+			auto result = this->download(job, worker.client);
+
+			if (job.request.onComplete) {
+				job.request.onComplete(result);
+			}
+
+			{
+				unique_lock<mutex> lock(this->jobsMutex);
+				this->stats.activeDownloads--;
+				if (result.success) {
+					this->stats.downloadsCompleted++;
+					this->stats.bytesDownloaded += result.bytes;
+					this->stats.averageThroughput = this->stats.downloadsCompleted == 1
+						? result.throughput
+						: this->stats.averageThroughput * 0.9f + result.throughput * 0.1f;
+				}
+				else {
+					this->stats.downloadsFailed++;
+				}
+				this->stats.resumes += result.resumes;
+				if (job.request.keepResult) {
+					this->results.push_back(move(result));
+				}
+			}
+		}
+	}
+
+	//----------
+	DownloadManager::Result DownloadManager::download(Job & job, HttpClient & client) {
+		const auto & request = job.request;
+
+		Result result;
+		result.url = request.url;
+		result.priority = request.priority;
+
+		auto startTime = Clock::now();
+		result.queueTime = toMilliseconds(startTime - job.timeAdded);
+
+		ofstream file;
+		if (request.destination == ToFile) {
+			file.open(request.filePath, ios::binary | ios::trunc);
+			if (!file.is_open()) {
+				result.error = "Couldn't open " + request.filePath + " for writing";
+				return result;
+			}
+			result.filePath = request.filePath;
+		}
+		else if (request.destination == ToSink && !request.sink) {
+			result.error = "No sink";
+			return result;
+		}
+
+		// bytes of the file we have so far
+		uint64_t received = 0;
+		bool sinkFailed = false;
+
+		HttpClient::Sink sink = [&](const char * data, size_t size, uint64_t offset) {
+			if (offset < received) {
+				// the server sent the file from the beginning again
+				result.restarts++;
+				if (request.destination == ToMemory) {
+					result.buffer.resize((size_t) offset);
+				}
+				else if (request.destination == ToFile) {
+					file.seekp((streamoff) offset);
+				}
+			}
+
+			switch (request.destination) {
+			case ToMemory:
+				result.buffer.append(data, size);
+				break;
+			case ToFile:
+				file.write(data, size);
+				sinkFailed = !file.good();
+				break;
+			case ToSink:
+				sinkFailed = !request.sink(data, size, offset);
+				break;
+			}
+
+			received = offset + size;
+			return !sinkFailed;
+		};
+
+		size_t maxAttempts;
+		{
+			unique_lock<mutex> lock(this->jobsMutex);
+			maxAttempts = this->maxAttempts;
+		}
+
+		auto backoff = RETRY_BACKOFF_MIN;
+		for (size_t attempt = 0; attempt < maxAttempts; attempt++) {
+			if (attempt > 0) {
+				this_thread::sleep_for(backoff);
+				backoff = min(backoff * 2, RETRY_BACKOFF_MAX);
+			}
+
+			auto rangeStart = received;
+			auto response = client.download(request.url, sink, rangeStart, STALL_TIMEOUT_SECONDS);
+			result.status = response.status;
+			result.error = response.error;
+
+			if (rangeStart > 0 && response.status == 206) {
+				result.resumes++;
+			}
+
+			if (response.status == 200 || response.status == 206) {
+				result.success = true;
+				break;
+			}
+
+			if (sinkFailed || client.isCancelled()) {
+				// don't retry
+				if (result.error.empty() || client.isCancelled()) {
+					result.error = client.isCancelled() ? "Cancelled" : "Sink failed";
+				}
+				break;
+			}
+
+			if (response.status >= 400 && response.status < 500) {
+				// e.g. the file is gone
+				result.error = "HTTP " + to_string(response.status) + " : " + response.data.getText();
+				break;
+			}
+
+			// otherwise the connection dropped (or the camera was busy), try again from where we got to
+			ofLogWarning("ofxCanon::DownloadManager") << "Download of " << request.url << " interrupted at " << received << " bytes ("
+				<< (response.error.empty() ? "HTTP " + to_string(response.status) : response.error) << ")";
+		}
+
+		if (file.is_open()) {
+			file.close();
+		}
+
+		result.bytes = received;
+		result.transferTime = toMilliseconds(Clock::now() - startTime);
+		if (result.transferTime > 0.0f) {
+			result.throughput = (float) result.bytes / (result.transferTime * 1000.0f); // bytes per ms / 1000 = MB/s
+		}
+
+		if (result.success && request.deleteAfterDownload) {
+			auto response = client.del(request.url);
+			if (response.status != 200) {
+				ofLogWarning("ofxCanon::DownloadManager") << "Couldn't delete " << request.url << " after download : " << response.data.getText();
+			}
+		}
+
+		if (!result.success) {
+			ofLogError("ofxCanon::DownloadManager") << "Failed to download " << request.url << " : " << result.error;
+		}
+
+		return result;
+	}
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "HttpClient.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <memory>
+
+namespace ofxCanon {
+	/*
+		Downloads files over HTTP (e.g. photos from a RemoteDevice) on a small pool of worker threads,
+		each with its own connection, so one large RAW file doesn't hold up everything else.
+
+		Requests are started highest priority first (e.g. JPEG previews before RAW files).
+
+		If a transfer drops part way through, it is resumed from where it stopped using an HTTP Range
+		request (or restarted from the beginning if the server doesn't honour the range).
+
+		Each file is streamed to one of :
+			Memory : Result::buffer
+			File : Request::filePath (written as it arrives)
+			Sink : Request::sink, called in the worker thread with each chunk
+
+		Completed downloads are received with receive() (e.g. from the main thread), and/or
+		Request::onComplete is called in the worker thread.
+	*/
+	class DownloadManager {
+	public:
+		enum Priority {
+			HighPriority, // e.g. JPEG previews
+			NormalPriority,
+			LowPriority, // e.g. RAW files
+			PriorityCount
+		};
+
+		enum Destination {
+			ToMemory,
+			ToFile,
+			ToSink
+		};
+
+		// Called with each chunk and its offset in the file. If the download restarts from the beginning, offset goes back to 0.
+		// Return false to cancel the download.
+		typedef HttpClient::Sink Sink;
+
+		struct Result;
+
+		struct Request {
+			std::string url;
+			Priority priority = NormalPriority;
+			Destination destination = ToMemory;
+			std::string filePath; // ToFile
+			Sink sink; // ToSink
+			bool deleteAfterDownload = false; // send DELETE to the url once the file has been downloaded
+			std::function<void(Result &)> onComplete; // called in the worker thread (e.g. move the buffer out)
+			bool keepResult = true; // false if onComplete is enough (the result won't be kept for receive())
+		};
+
+		struct Result {
+			std::string url;
+			Priority priority = NormalPriority;
+			bool success = false;
+			int status = 0; // HTTP status of the last attempt
+			std::string error;
+
+			ofBuffer buffer; // ToMemory
+			std::string filePath; // ToFile
+
+			uint64_t bytes = 0;
+			size_t resumes = 0; // transfers which continued part way through the file
+			size_t restarts = 0; // transfers which had to start again from the beginning
+			float queueTime = 0.0f; // ms from being added until the transfer started
+			float transferTime = 0.0f; // ms
+			float throughput = 0.0f; // MB/s over the whole transfer (including retries)
+
+			operator bool() const {
+				return this->success;
+			}
+		};
+
+		struct Stats {
+			size_t queueLength[PriorityCount] = { 0 };
+			size_t activeDownloads = 0;
+			uint64_t downloadsCompleted = 0;
+			uint64_t downloadsFailed = 0;
+			uint64_t resumes = 0;
+			uint64_t bytesDownloaded = 0;
+			float averageThroughput = 0.0f; // smoothed MB/s per file
+		};
+
+		DownloadManager(size_t threadCount = 2);
+		~DownloadManager();
+
+		size_t getThreadCount() const;
+
+		void setMaxAttempts(size_t); // per file, default 5
+		size_t getMaxAttempts() const;
+
+		void add(const Request &);
+
+		bool receive(Result &);
+
+		// Forget queued requests and abort transfers in progress (they complete with success = false)
+		void cancelAll();
+
+		Stats getStats() const;
+	protected:
+		typedef std::chrono::high_resolution_clock Clock;
+
+		struct Job {
+			Request request;
+			Clock::time_point timeAdded;
+		};
+
+		struct Worker {
+			std::thread thread;
+			HttpClient client;
+		};
+
+		void workerLoop(Worker &);
+		Result download(Job &, HttpClient &);
+
+		std::vector<std::unique_ptr<Worker>> workers;
+		bool closeThreads = false;
+
+		mutable std::mutex jobsMutex;
+		std::condition_variable jobsChanged;
+		std::deque<Job> jobs[PriorityCount];
+		size_t maxAttempts = 5;
+
+		std::deque<Result> results;
+		Stats stats;
+	};
+}
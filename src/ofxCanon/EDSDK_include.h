@@ -4,4 +4,8 @@
     #define __MACOS__
 #endif
 
-#include "EDSDK.h"
+#ifdef OFXCANON_SIMULATOR
+    #include "Simulator/EDSDK.h"
+#else
+    #include "EDSDK.h"
+#endif
@@ -0,0 +1,231 @@
+#include "EncodedBuffer.h"
+#include "Utils.h"
+
+#include "FreeImage.h"
+
+#include <fstream>
+
+using namespace std;
+
+namespace ofxCanon {
+	//----------
+	EncodedBuffer::EncodedBuffer(EdsStreamRef stream)
+	: stream(stream) {
+
+	}
+
+	//----------
+	EncodedBuffer::EncodedBuffer(EdsStreamRef stream, BufferPool::Block && block, weak_ptr<BufferPool> pool)
+	: stream(stream)
+	, block(move(block))
+	, pool(pool) {
+
+	}
+
+	//----------
+	EncodedBuffer::~EncodedBuffer() {
+		if (this->stream != NULL) {
+			WARNING(EdsRelease(this->stream)
+				, "Release encoded stream");
+		}
+
+		// The stream no longer references the block, so it can be reused
+		auto pool = this->pool.lock();
+		if (pool) {
+			pool->release(move(this->block));
+		}
+	}
+
+	//----------
+	EdsStreamRef EncodedBuffer::getStream() const {
+		return this->stream;
+	}
+
+	//----------
+	const char * EncodedBuffer::getData() const {
+		char * data = NULL;
+		if (this->stream != NULL) {
+			WARNING(EdsGetPointer(this->stream, (EdsVoid**)& data)
+				, "Get pointer to encoded data");
+		}
+		return data;
+	}
+
+	//----------
+	size_t EncodedBuffer::size() const {
+		EdsUInt64 length = 0;
+		if (this->stream != NULL) {
+			WARNING(EdsGetLength(this->stream, &length)
+				, "Get encoded stream length (i.e. file size)");
+		}
+		return (size_t)length;
+	}
+
+	//----------
+	bool EncodedBuffer::writeTo(ostream & stream) const {
+		auto data = this->getData();
+		if (data == NULL) {
+			return false;
+		}
+		stream.write(data, this->size());
+		return stream.good();
+	}
+
+	//----------
+	bool EncodedBuffer::save(const string & path) const {
+		ofstream file(ofToDataPath(path, true), ios::out | ios::binary);
+		if (!file.is_open()) {
+			ofLogError("ofxCanon") << "Couldn't open " << path << " for writing";
+			return false;
+		}
+		return this->writeTo(file);
+	}
+
+	//----------
+	ofBuffer EncodedBuffer::toBuffer() const {
+		auto data = this->getData();
+		if (data == NULL) {
+			return ofBuffer();
+		}
+		return ofBuffer(data, this->size());
+	}
+
+	//----------
+	ostream & operator<<(ostream & stream, const EncodedBuffer & buffer) {
+		buffer.writeTo(stream);
+		return stream;
+	}
+
+#pragma mark loadImage
+	//----------
+	// Follows putBmpIntoPixels in ofImage.cpp
+	template<typename PixelType>
+	void putBmpIntoPixels(FIBITMAP * bmp, ofPixels_<PixelType> & pixels) {
+		FIBITMAP * bmpConverted = nullptr;
+		auto imageType = FreeImage_GetImageType(bmp);
+
+		if (sizeof(PixelType) == 1
+			&& (FreeImage_GetColorType(bmp) == FIC_PALETTE || FreeImage_GetBPP(bmp) < 8 || imageType != FIT_BITMAP)) {
+			bmpConverted = FreeImage_IsTransparent(bmp)
+				? FreeImage_ConvertTo32Bits(bmp)
+				: FreeImage_ConvertTo24Bits(bmp);
+			bmp = bmpConverted;
+		}
+		else if (sizeof(PixelType) == 2
+			&& imageType != FIT_UINT16 && imageType != FIT_RGB16 && imageType != FIT_RGBA16) {
+			bmpConverted = FreeImage_ConvertToType(bmp, FreeImage_IsTransparent(bmp) ? FIT_RGBA16 : FIT_RGB16);
+			bmp = bmpConverted;
+		}
+		else if (sizeof(PixelType) == 4
+			&& imageType != FIT_FLOAT && imageType != FIT_RGBF && imageType != FIT_RGBAF) {
+			bmpConverted = FreeImage_ConvertToType(bmp, FreeImage_IsTransparent(bmp) ? FIT_RGBAF : FIT_RGBF);
+			bmp = bmpConverted;
+		}
+
+		if (bmp == nullptr) {
+			ofLogError("ofxCanon") << "loadImage : Couldn't convert image to requested pixel type";
+			return;
+		}
+
+		auto width = FreeImage_GetWidth(bmp);
+		auto height = FreeImage_GetHeight(bmp);
+		auto bpp = FreeImage_GetBPP(bmp);
+		auto channels = (bpp / sizeof(PixelType)) / 8;
+		auto pitch = FreeImage_GetPitch(bmp);
+#ifdef TARGET_LITTLE_ENDIAN
+		bool swapRG = channels && (bpp / channels == 8);
+#else
+		bool swapRG = false;
+#endif
+
+		ofPixelFormat pixelFormat = OF_PIXELS_GRAY;
+		if (channels == 3) {
+			pixelFormat = swapRG ? OF_PIXELS_BGR : OF_PIXELS_RGB;
+		}
+		else if (channels == 4) {
+			pixelFormat = swapRG ? OF_PIXELS_BGRA : OF_PIXELS_RGBA;
+		}
+
+		// ofPixels are top left, FIBITMAP is bottom left
+		FreeImage_FlipVertical(bmp);
+
+		auto bits = FreeImage_GetBits(bmp);
+		if (bits != nullptr) {
+			pixels.setFromAlignedPixels((PixelType*)bits, width, height, pixelFormat, pitch);
+		}
+		else {
+			ofLogError("ofxCanon") << "loadImage : Unable to set ofPixels from FIBITMAP";
+		}
+
+		if (bmpConverted != nullptr) {
+			FreeImage_Unload(bmpConverted);
+		}
+
+		if (swapRG && channels >= 3) {
+			pixels.swapRgb();
+		}
+	}
+
+	//----------
+	template<typename PixelType>
+	bool loadImage(ofPixels_<PixelType> & pixels, const char * data, size_t size, const ofImageLoadSettings & settings) {
+		if (data == nullptr || size == 0) {
+			ofLogError("ofxCanon") << "loadImage : Buffer is empty";
+			return false;
+		}
+
+		// openFrameworks normally does this in ofInit, but we may be called before that or from a plugin
+		{
+			static once_flag initialiseFlag;
+			call_once(initialiseFlag, []() {
+				FreeImage_Initialise();
+			});
+		}
+
+		// FreeImage only reads from the memory handle, so the const_cast is safe
+		auto memory = FreeImage_OpenMemory((BYTE*)const_cast<char*>(data), (DWORD)size);
+		if (memory == nullptr) {
+			ofLogError("ofxCanon") << "loadImage : Couldn't open buffer for reading";
+			return false;
+		}
+
+		bool success = false;
+		auto format = FreeImage_GetFileTypeFromMemory(memory);
+		if (format != FIF_UNKNOWN && FreeImage_FIFSupportsReading(format)) {
+			int flags = 0;
+			if (format == FIF_JPEG) {
+				flags |= settings.accurate ? JPEG_ACCURATE : JPEG_FAST;
+				flags |= settings.exifRotate ? JPEG_EXIFROTATE : 0;
+				flags |= settings.grayscale ? JPEG_GREYSCALE : 0;
+				flags |= settings.separateCMYK ? JPEG_CMYK : 0;
+			}
+			flags |= settings.freeImageFlags;
+
+			auto bmp = FreeImage_LoadFromMemory(format, memory, flags);
+			if (bmp != nullptr) {
+				putBmpIntoPixels(bmp, pixels);
+				FreeImage_Unload(bmp);
+				success = pixels.isAllocated();
+			}
+		}
+		else {
+			ofLogError("ofxCanon") << "loadImage : Unrecognised image format";
+		}
+
+		FreeImage_CloseMemory(memory);
+		return success;
+	}
+
+	//----------
+	template<typename PixelType>
+	bool loadImage(ofPixels_<PixelType> & pixels, const EncodedBuffer & buffer, const ofImageLoadSettings & settings) {
+		return loadImage(pixels, buffer.getData(), buffer.size(), settings);
+	}
+
+	template bool loadImage(ofPixels_<unsigned char> &, const char *, size_t, const ofImageLoadSettings &);
+	template bool loadImage(ofPixels_<unsigned short> &, const char *, size_t, const ofImageLoadSettings &);
+	template bool loadImage(ofPixels_<float> &, const char *, size_t, const ofImageLoadSettings &);
+	template bool loadImage(ofPixels_<unsigned char> &, const EncodedBuffer &, const ofImageLoadSettings &);
+	template bool loadImage(ofPixels_<unsigned short> &, const EncodedBuffer &, const ofImageLoadSettings &);
+	template bool loadImage(ofPixels_<float> &, const EncodedBuffer &, const ofImageLoadSettings &);
+}
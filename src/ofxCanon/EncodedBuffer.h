@@ -0,0 +1,63 @@
+#pragma once
+
+#include "EDSDK_include.h"
+#include "BufferPool.h"
+
+#include "ofFileUtils.h"
+#include "ofPixels.h"
+#include "ofImage.h"
+
+#include <string>
+#include <ostream>
+#include <memory>
+
+namespace ofxCanon {
+	/*
+		Holds the encoded bytes of a downloaded image (e.g. JPEG, CR2, CR3) inside
+		the EDSDK stream which they were downloaded into.
+
+		The stream is released when the EncodedBuffer is destroyed, so it is normally
+		passed around as a shared_ptr and released when the last reference drops.
+
+		getData() points directly into the stream's memory, so the image can be
+		decoded (see ofxCanon::loadImage) or written to disk without copying it into
+		an ofBuffer first.
+
+		If the stream was created over a block from a BufferPool, the block is returned
+		to the pool after the stream is released.
+	*/
+	class EncodedBuffer {
+	public:
+		EncodedBuffer(EdsStreamRef); // takes ownership of the stream
+		EncodedBuffer(EdsStreamRef, BufferPool::Block &&, std::weak_ptr<BufferPool>); // stream must be created over the block
+		~EncodedBuffer();
+
+		EncodedBuffer(const EncodedBuffer &) = delete;
+		EncodedBuffer & operator=(const EncodedBuffer &) = delete;
+
+		EdsStreamRef getStream() const;
+
+		const char * getData() const;
+		size_t size() const;
+
+		bool writeTo(std::ostream &) const;
+		bool save(const std::string & path) const;
+
+		// Copies the data into a new ofBuffer (e.g. for APIs which only accept ofBuffer)
+		ofBuffer toBuffer() const;
+	protected:
+		EdsStreamRef stream = NULL;
+		BufferPool::Block block;
+		std::weak_ptr<BufferPool> pool;
+	};
+
+	std::ostream & operator<<(std::ostream &, const EncodedBuffer &);
+
+	// Decode encoded image data directly from memory (no intermediate ofBuffer copy)
+	// These follow the same conventions as ofLoadImage
+	template<typename PixelType>
+	bool loadImage(ofPixels_<PixelType> &, const char * data, size_t size, const ofImageLoadSettings & = ofImageLoadSettings());
+
+	template<typename PixelType>
+	bool loadImage(ofPixels_<PixelType> &, const EncodedBuffer &, const ofImageLoadSettings & = ofImageLoadSettings());
+}
@@ -14,9 +14,10 @@ namespace ofxCanon {
 				{
 					auto directoryItem = (EdsDirectoryItemRef)object;
 					if (directoryItem) {
-						device->performInCameraThread([device, directoryItem]() {
-							device->download(directoryItem);
-						});
+						auto transferRequested = Device::CaptureTiming::Clock::now();
+						device->performInCameraThread([device, directoryItem, transferRequested]() {
+							device->download(directoryItem, transferRequested);
+						}, Device::HighPriority);
 					}
 					break;
 				}
@@ -46,16 +47,17 @@ namespace ofxCanon {
 			if (device->logDeviceCallbacks) {
 				ofLogNotice("ofxCanon") << "Property changed " << propertyToString(propertyId) << " : " << param;
 			}
-			
-			device->performInCameraThread([=]() {
-				device->pollProperty(propertyId);
-			});
+
+			// Repeated events for the same property are merged into one poll
+			device->markPropertyDirty(propertyId);
 			break;
 		case kEdsPropertyEvent_PropertyDescChanged:
 			if (device->logDeviceCallbacks) {
 				ofLogNotice("ofxCanon") << "Property description changed " << propertyToString(propertyId) << " : " << param;
 			}
 
+			device->invalidateOptions(propertyId);
+
 			device->performInCameraThread([=]() {
 				auto propertyIdCopy = propertyId;
 				ofNotifyEvent(device->onParameterOptionsChange, propertyIdCopy);
@@ -75,7 +77,7 @@ namespace ofxCanon {
 				//Extend the shutdown timer if the camera is about to fall asleep
 				device->performInCameraThread([=]() {
 					EdsSendCommand(device->camera, kEdsCameraCommand_ExtendShutDownTimer, 0);
-				});
+				}, Device::HighPriority);
 				break;
 			}
 		case kEdsStateEvent_CaptureError:
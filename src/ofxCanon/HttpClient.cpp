@@ -0,0 +1,211 @@
+#include "HttpClient.h"
+
+#include <curl/curl.h>
+
+using namespace std;
+
+namespace ofxCanon {
+	//----------
+	size_t write_cb(void * buffer, size_t size, size_t nmemb, void * userdata) {
+		auto client = (HttpClient *)userdata;
+
+		long status = 0;
+		if (client->sink) {
+			curl_easy_getinfo(client->handle, CURLINFO_RESPONSE_CODE, &status);
+		}
+
+		if (client->sink && status >= 200 && status < 300) {
+			if (!client->sinkStarted) {
+				// the body starts from rangeStart only if the server honoured the range
+				client->sinkOffset = status == 206 ? client->rangeStart : 0;
+				client->sinkStarted = true;
+			}
+
+			auto offset = client->sinkOffset;
+			client->sinkOffset += size * nmemb;
+
+			// returning less than we were given aborts the transfer
+			return (*client->sink)((const char *)buffer, size * nmemb, offset)
+				? size * nmemb
+				: 0;
+		}
+		else {
+			client->responseBuffer.append((const char *)buffer, size * nmemb);
+			return size * nmemb;
+		}
+	}
+
+	//----------
+	int cancel_cb(void * userdata, curl_off_t, curl_off_t, curl_off_t, curl_off_t) {
+		auto cancelled = (atomic<bool> *)userdata;
+		return *cancelled ? 1 : 0;
+	}
+
+	//----------
+	HttpClient::HttpClient() {
+		this->handle = curl_easy_init();
+
+		// "Expect:" stops curl waiting for 100-continue before sending a body
+		this->headers = curl_slist_append(this->headers, "Content-Type: application/json");
+		this->headers = curl_slist_append(this->headers, "Expect:");
+
+		if (this->handle) {
+			curl_easy_setopt(this->handle, CURLOPT_HTTPHEADER, this->headers);
+			curl_easy_setopt(this->handle, CURLOPT_WRITEFUNCTION, write_cb);
+			curl_easy_setopt(this->handle, CURLOPT_WRITEDATA, this);
+			curl_easy_setopt(this->handle, CURLOPT_TCP_KEEPALIVE, 1L);
+			curl_easy_setopt(this->handle, CURLOPT_TCP_NODELAY, 1L);
+			curl_easy_setopt(this->handle, CURLOPT_NOSIGNAL, 1L); // we're used from several threads
+			curl_easy_setopt(this->handle, CURLOPT_NOPROGRESS, 0L);
+			curl_easy_setopt(this->handle, CURLOPT_XFERINFOFUNCTION, cancel_cb);
+			curl_easy_setopt(this->handle, CURLOPT_XFERINFODATA, &this->cancelled);
+		}
+	}
+
+	//----------
+	HttpClient::~HttpClient() {
+		if (this->handle) {
+			curl_easy_cleanup(this->handle);
+		}
+		if (this->headers) {
+			curl_slist_free_all(this->headers);
+		}
+	}
+
+	//----------
+	ofHttpResponse HttpClient::request(const string & method, const string & url, const string & body, float timeoutSeconds) {
+		return this->perform(method, url, body, timeoutSeconds, nullptr, 0);
+	}
+
+	//----------
+	ofHttpResponse HttpClient::download(const string & url, const Sink & sink, uint64_t rangeStart, float stallTimeoutSeconds) {
+		return this->perform("GET", url, "", stallTimeoutSeconds, &sink, rangeStart);
+	}
+
+	//----------
+	ofHttpResponse HttpClient::perform(const string & method, const string & url, const string & body, float timeoutSeconds, const Sink * sink, uint64_t rangeStart) {
+		ofHttpResponse response;
+		response.request.url = url;
+
+		unique_lock<mutex> lock(this->requestMutex);
+		if (!this->handle) {
+			response.status = -1;
+			response.error = "Couldn't initialise curl";
+			return response;
+		}
+		if (this->cancelled) {
+			response.status = -1;
+			response.error = "Cancelled";
+			return response;
+		}
+
+		auto handle = this->handle;
+
+		// Reset the method from the previous request
+		curl_easy_setopt(handle, CURLOPT_HTTPGET, 1L);
+		curl_easy_setopt(handle, CURLOPT_CUSTOMREQUEST, NULL);
+
+		curl_easy_setopt(handle, CURLOPT_URL, url.c_str());
+		if (!body.empty() || method == "POST") {
+			curl_easy_setopt(handle, CURLOPT_POSTFIELDS, body.data());
+			curl_easy_setopt(handle, CURLOPT_POSTFIELDSIZE, (long)body.size());
+		}
+		if (method != "GET" && method != "POST") {
+			curl_easy_setopt(handle, CURLOPT_CUSTOMREQUEST, method.c_str());
+		}
+		if (sink) {
+			// fail on a stall rather than on the total time
+			curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, 0L);
+			curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, 1L);
+			curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, max((long)timeoutSeconds, 1L));
+		}
+		else {
+			curl_easy_setopt(handle, CURLOPT_TIMEOUT_MS, (long)(timeoutSeconds * 1000.0f));
+			curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, 0L);
+			curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, 0L);
+		}
+
+		if (rangeStart > 0) {
+			auto range = to_string(rangeStart) + "-";
+			curl_easy_setopt(handle, CURLOPT_RANGE, range.c_str()); // curl copies the string
+		}
+		else {
+			curl_easy_setopt(handle, CURLOPT_RANGE, NULL);
+		}
+
+		this->sink = sink;
+		this->rangeStart = rangeStart;
+		this->sinkStarted = false;
+		this->responseBuffer.clear();
+		auto startTime = chrono::high_resolution_clock::now();
+		auto error = curl_easy_perform(handle);
+		this->sink = nullptr;
+		auto latency = (float)chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - startTime).count() / 1000.0f;
+
+		if (error == CURLE_OK) {
+			long status = 0;
+			curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &status);
+			response.status = (int)status;
+			response.data.set(this->responseBuffer.data(), this->responseBuffer.size());
+		}
+		else {
+			response.status = -1;
+			response.error = curl_easy_strerror(error);
+		}
+
+		long connectsMade = 0;
+		curl_easy_getinfo(handle, CURLINFO_NUM_CONNECTS, &connectsMade);
+
+		{
+			unique_lock<mutex> statsLock(this->statsMutex);
+			if (error != CURLE_OK) {
+				this->stats.failures++;
+			}
+			this->stats.connectionsOpened += connectsMade;
+			this->stats.requests++;
+			this->stats.averageLatency = this->stats.requests == 1
+				? latency
+				: this->stats.averageLatency * 0.9f + latency * 0.1f;
+			this->stats.maxLatency = max(this->stats.maxLatency, latency);
+		}
+
+		return response;
+	}
+
+	//----------
+	ofHttpResponse HttpClient::get(const string & url, float timeoutSeconds) {
+		return this->request("GET", url, "", timeoutSeconds);
+	}
+
+	//----------
+	ofHttpResponse HttpClient::post(const string & url, const string & body, float timeoutSeconds) {
+		return this->request("POST", url, body, timeoutSeconds);
+	}
+
+	//----------
+	ofHttpResponse HttpClient::put(const string & url, const string & body, float timeoutSeconds) {
+		return this->request("PUT", url, body, timeoutSeconds);
+	}
+
+	//----------
+	ofHttpResponse HttpClient::del(const string & url, float timeoutSeconds) {
+		return this->request("DELETE", url, "", timeoutSeconds);
+	}
+
+	//----------
+	void HttpClient::setCancelled(bool cancelled) {
+		this->cancelled = cancelled;
+	}
+
+	//----------
+	bool HttpClient::isCancelled() const {
+		return this->cancelled;
+	}
+
+	//----------
+	HttpClient::Stats HttpClient::getStats() const {
+		// not requestMutex, which is held for the whole of a request (e.g. a long poll)
+		unique_lock<mutex> lock(this->statsMutex);
+		return this->stats;
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "ofURLFileLoader.h"
+
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <functional>
+
+typedef void CURL;
+struct curl_slist;
+
+namespace ofxCanon {
+	/*
+		A blocking HTTP client which keeps its connection to the camera open between requests
+		(one curl easy handle, reused for every request).
+
+		Requests from different threads are serialised (one request at a time per client).
+		Use one client per connection you want to keep open (e.g. one per RemoteDevice).
+	*/
+	class HttpClient {
+	public:
+		struct Stats {
+			uint64_t requests = 0;
+			uint64_t failures = 0; // transport errors (not HTTP error statuses)
+			uint64_t connectionsOpened = 0; // requests which couldn't reuse the open connection
+			float averageLatency = 0.0f; // smoothed ms
+			float maxLatency = 0.0f; // ms
+		};
+
+		// Receives a successful response body in chunks as it arrives, with each chunk's offset in the file.
+		// Return false to abort the transfer.
+		typedef std::function<bool(const char * data, size_t size, uint64_t offset)> Sink;
+
+		HttpClient();
+		~HttpClient();
+
+		// body is sent as application/json if not empty
+		ofHttpResponse request(const std::string & method, const std::string & url, const std::string & body = "", float timeoutSeconds = 5.0f);
+
+		ofHttpResponse get(const std::string & url, float timeoutSeconds = 5.0f);
+		ofHttpResponse post(const std::string & url, const std::string & body, float timeoutSeconds = 5.0f);
+		ofHttpResponse put(const std::string & url, const std::string & body, float timeoutSeconds = 5.0f);
+		ofHttpResponse del(const std::string & url, float timeoutSeconds = 5.0f);
+
+		// GET streamed into the sink. Starts from rangeStart using a Range header. If the server ignores the range
+		// (status 200 rather than 206) the offsets start from 0 again. Error responses go to response.data instead.
+		// There is no overall timeout for large files, instead the transfer fails if no data arrives for stallTimeoutSeconds.
+		ofHttpResponse download(const std::string & url, const Sink &, uint64_t rangeStart = 0, float stallTimeoutSeconds = 10.0f);
+
+		// While cancelled, a request in progress is aborted (within about a second) and new requests fail straight away
+		// Can be called from any thread (e.g. to stop a long poll when closing)
+		void setCancelled(bool);
+		bool isCancelled() const;
+
+		Stats getStats() const;
+	protected:
+		friend size_t write_cb(void *, size_t, size_t, void *);
+
+		ofHttpResponse perform(const std::string & method, const std::string & url, const std::string & body, float timeoutSeconds, const Sink *, uint64_t rangeStart);
+
+		CURL * handle = nullptr;
+		curl_slist * headers = nullptr; // built once
+		std::string responseBuffer; // keeps its capacity between requests
+		const Sink * sink = nullptr; // whilst downloading
+		uint64_t rangeStart = 0;
+		uint64_t sinkOffset = 0;
+		bool sinkStarted = false;
+
+		std::atomic<bool> cancelled{ false };
+
+		Stats stats;
+		mutable std::mutex statsMutex;
+		mutable std::mutex requestMutex;
+	};
+}
@@ -0,0 +1,141 @@
+#include "LiveViewScrollParser.h"
+
+#include <algorithm>
+
+// Larger than any live view frame, so a corrupt size doesn't make us buffer forever
+#define MAX_FRAME_SIZE (16 * 1024 * 1024)
+
+using namespace std;
+
+namespace ofxCanon {
+	//----------
+	LiveViewScrollParser::LiveViewScrollParser(Callback && callback)
+	: callback(move(callback)) {
+
+	}
+
+	//----------
+	void LiveViewScrollParser::setCallback(Callback && callback) {
+		this->callback = move(callback);
+	}
+
+	//----------
+	void LiveViewScrollParser::push(const char * data, size_t size) {
+		this->stats.bytesReceived += size;
+
+		size_t position = 0;
+		while (position < size) {
+			auto byte = (uint8_t) data[position];
+
+			switch (this->state) {
+			case StartMarker:
+				// anything before a start marker is skipped
+				if (byte == 0xFF) {
+					this->state = StartMarkerType;
+				}
+				position++;
+				break;
+			case StartMarkerType:
+				if (byte == 0x00) {
+					this->state = Type;
+					position++;
+				}
+				else if (byte != 0xFF) {
+					this->state = StartMarker;
+					position++;
+				}
+				else {
+					// 0xFF 0xFF 0x00 : the second 0xFF may be the start
+					position++;
+				}
+				break;
+			case Type:
+				if (byte != ImageFrame && byte != InfoFrame) {
+					// not really a start marker (e.g. we're resyncing through JPEG data)
+					this->resync();
+					break;
+				}
+				this->frameType = (FrameType) byte;
+				this->frameSize = 0;
+				this->sizeBytesRead = 0;
+				this->state = Size;
+				position++;
+				break;
+			case Size:
+				this->frameSize = (this->frameSize << 8) | byte;
+				position++;
+				if (++this->sizeBytesRead == 4) {
+					if (this->frameSize > MAX_FRAME_SIZE) {
+						this->resync();
+					}
+					else {
+						this->frame.clear();
+						this->frame.reserve(this->frameSize);
+						this->state = this->frameSize > 0 ? Data : EndMarker;
+					}
+				}
+				break;
+			case Data:
+			{
+				// copy as much of the frame as we have in one go
+				auto remaining = (size_t) this->frameSize - this->frame.size();
+				auto count = min(remaining, size - position);
+				this->frame.append(data + position, count);
+				position += count;
+				if (this->frame.size() == this->frameSize) {
+					this->state = EndMarker;
+				}
+				break;
+			}
+			case EndMarker:
+				if (byte == 0xFF) {
+					this->state = EndMarkerType;
+					position++;
+				}
+				else {
+					// don't consume, it may be the start of the next frame
+					this->resync();
+				}
+				break;
+			case EndMarkerType:
+				if (byte == 0xFF) {
+					this->stats.framesParsed++;
+					if (this->callback) {
+						this->callback(this->frameType, this->frame);
+					}
+					this->frame.clear();
+					this->state = StartMarker;
+					this->searching = false;
+					position++;
+				}
+				else {
+					this->resync();
+				}
+				break;
+			}
+		}
+	}
+
+	//----------
+	void LiveViewScrollParser::reset() {
+		this->frame.clear();
+		this->state = StartMarker;
+		this->searching = false;
+	}
+
+	//----------
+	const LiveViewScrollParser::Stats & LiveViewScrollParser::getStats() const {
+		return this->stats;
+	}
+
+	//----------
+	void LiveViewScrollParser::resync() {
+		// whilst searching, false start markers in the JPEG data (0xFF 0x00 is JPEG byte stuffing) aren't counted again
+		if (!this->searching) {
+			this->stats.resyncs++;
+		}
+		this->frame.clear();
+		this->state = StartMarker;
+		this->searching = true;
+	}
+}
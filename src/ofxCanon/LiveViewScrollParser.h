@@ -0,0 +1,69 @@
+#pragma once
+
+#include "ofFileUtils.h"
+
+#include <functional>
+#include <stdint.h>
+
+namespace ofxCanon {
+	/*
+		Splits the CCAPI live view scroll stream (GET shooting/liveview/scroll) into frames as it arrives.
+
+		The stream is a sequence of frames :
+			0xFF 0x00 : start marker
+			1 byte : type (0x00 = JPEG image, 0x01 = live view info as JSON)
+			4 bytes : data size (big endian)
+			data
+			0xFF 0xFF : end marker
+
+		Chunks of any size can be pushed (e.g. straight from HttpClient::download). Only the frame
+		being received is buffered. If a marker is missing (e.g. the stream was cut mid-frame), the
+		partial frame is dropped and the parser skips ahead to the next start marker.
+	*/
+	class LiveViewScrollParser {
+	public:
+		enum FrameType : uint8_t {
+			ImageFrame = 0x00,
+			InfoFrame = 0x01
+		};
+
+		// Called for each complete frame. Swap the buffer out to keep it without a copy.
+		typedef std::function<void(FrameType, ofBuffer &)> Callback;
+
+		struct Stats {
+			uint64_t bytesReceived = 0;
+			uint64_t framesParsed = 0;
+			uint64_t resyncs = 0; // times sync was lost and the stream had to be searched for the next frame (e.g. after a partial frame)
+		};
+
+		LiveViewScrollParser(Callback && = Callback());
+
+		void setCallback(Callback &&);
+
+		void push(const char * data, size_t size);
+		void reset(); // forget any partial frame (e.g. on reconnect)
+
+		const Stats & getStats() const;
+	protected:
+		enum State {
+			StartMarker,
+			StartMarkerType,
+			Type,
+			Size,
+			Data,
+			EndMarker,
+			EndMarkerType
+		};
+
+		void resync();
+
+		Callback callback;
+		State state = StartMarker;
+		FrameType frameType = ImageFrame;
+		uint32_t frameSize = 0;
+		uint8_t sizeBytesRead = 0;
+		ofBuffer frame;
+		bool searching = false; // lost sync and looking for the next frame
+		Stats stats;
+	};
+}
@@ -0,0 +1,766 @@
+#include "RawDecoder.h"
+
+#include "ofLog.h"
+
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+
+// CR2 TIFF tags
+#define TAG_STRIP_OFFSETS 0x0111
+#define TAG_STRIP_BYTE_COUNTS 0x0117
+#define TAG_EXIF_IFD 0x8769
+#define TAG_MAKER_NOTE 0x927C
+#define TAG_CR2_SLICES 0xC640
+#define TAG_CANON_SENSOR_INFO 0x00E0
+
+// Rows handed to a thread at a time for prediction and unslicing
+#define RAW_DECODER_BAND_ROWS 64
+
+using namespace std;
+
+namespace ofxCanon {
+	namespace {
+#pragma mark TIFF
+		//----------
+		uint16_t get16(const uint8_t * data) {
+			return (uint16_t) data[0] | ((uint16_t) data[1] << 8);
+		}
+
+		//----------
+		uint32_t get32(const uint8_t * data) {
+			return (uint32_t) data[0] | ((uint32_t) data[1] << 8) | ((uint32_t) data[2] << 16) | ((uint32_t) data[3] << 24);
+		}
+
+		//----------
+		uint16_t get16BigEndian(const uint8_t * data) {
+			return ((uint16_t) data[0] << 8) | (uint16_t) data[1];
+		}
+
+		//----------
+		// Finds a tag in a (little endian) IFD and returns a pointer to its values, or nullptr
+		const uint8_t * findTag(const uint8_t * data, size_t size, uint32_t ifdOffset, uint16_t tag, uint16_t & type, uint32_t & count) {
+			if ((size_t) ifdOffset + 2 > size) {
+				return nullptr;
+			}
+			auto entryCount = get16(data + ifdOffset);
+			if ((size_t) ifdOffset + 2 + entryCount * 12 > size) {
+				return nullptr;
+			}
+
+			for (uint16_t i = 0; i < entryCount; i++) {
+				auto entry = data + ifdOffset + 2 + i * 12;
+				if (get16(entry) != tag) {
+					continue;
+				}
+				type = get16(entry + 2);
+				count = get32(entry + 4);
+
+				size_t typeSize;
+				switch (type) {
+				case 3: // SHORT
+				case 8: // SSHORT
+					typeSize = 2;
+					break;
+				case 4: // LONG
+				case 9: // SLONG
+				case 11: // FLOAT
+					typeSize = 4;
+					break;
+				case 5: // RATIONAL
+				case 10: // SRATIONAL
+				case 12: // DOUBLE
+					typeSize = 8;
+					break;
+				default: // BYTE, ASCII, UNDEFINED
+					typeSize = 1;
+					break;
+				}
+
+				// Values which fit in 4 bytes are stored in the entry itself
+				if (typeSize * count <= 4) {
+					return entry + 8;
+				}
+				auto offset = get32(entry + 8);
+				if ((size_t) offset + typeSize * count > size) {
+					return nullptr;
+				}
+				return data + offset;
+			}
+			return nullptr;
+		}
+
+		//----------
+		// SHORT or LONG values of a tag
+		vector<uint32_t> getTagValues(const uint8_t * data, size_t size, uint32_t ifdOffset, uint16_t tag) {
+			vector<uint32_t> values;
+			uint16_t type;
+			uint32_t count;
+			auto tagData = findTag(data, size, ifdOffset, tag, type, count);
+			if (tagData && (type == 3 || type == 4)) {
+				values.resize(count);
+				for (uint32_t i = 0; i < count; i++) {
+					values[i] = type == 3
+						? get16(tagData + i * 2)
+						: get32(tagData + i * 4);
+				}
+			}
+			return values;
+		}
+
+#pragma mark Lossless JPEG
+		//----------
+		// Reads the entropy coded segment, removing stuffed zero bytes.
+		// At a marker (or the end of the data) it feeds zeros instead.
+		struct BitReader {
+			BitReader(const uint8_t * position, const uint8_t * end)
+			: position(position)
+			, end(end) {
+
+			}
+
+			void fill() {
+				// Take whole bytes at once when the next 8 don't include an 0xFF
+				if (this->position + 8 <= this->end) {
+					uint64_t bytes = 0;
+					for (int i = 0; i < 8; i++) {
+						bytes = (bytes << 8) | this->position[i];
+					}
+					auto inverted = ~bytes;
+					auto hasFF = (inverted - 0x0101010101010101ull) & ~inverted & 0x8080808080808080ull;
+					if (!hasFF) {
+						auto byteCount = (64 - this->bitCount) / 8;
+						this->buffer |= (bytes >> (64 - byteCount * 8)) << (64 - this->bitCount - byteCount * 8);
+						this->bitCount += byteCount * 8;
+						this->position += byteCount;
+						return;
+					}
+				}
+
+				while (this->bitCount <= 56) {
+					uint64_t byte = 0;
+					if (this->position < this->end) {
+						byte = *this->position;
+						if (byte != 0xFF) {
+							this->position++;
+						}
+						else if (this->position + 1 < this->end && this->position[1] == 0x00) {
+							this->position += 2;
+						}
+						else {
+							// marker
+							this->end = this->position;
+							byte = 0;
+							this->paddedBytes++;
+						}
+					}
+					else {
+						this->paddedBytes++;
+					}
+					this->buffer |= byte << (56 - this->bitCount);
+					this->bitCount += 8;
+				}
+			}
+
+			uint32_t peek(int count) const {
+				return (uint32_t) (this->buffer >> (64 - count));
+			}
+
+			void skip(int count) {
+				this->buffer <<= count;
+				this->bitCount -= count;
+			}
+
+			// True if we've read past the end of the scan (i.e. the data is truncated / corrupt)
+			bool isOverrun() const {
+				return this->paddedBytes * 8 > (size_t) this->bitCount + 64;
+			}
+
+			const uint8_t * position;
+			const uint8_t * end;
+			uint64_t buffer = 0;
+			int bitCount = 0;
+			size_t paddedBytes = 0;
+		};
+	}
+
+	//----------
+	RawDecoder::RawDecoder(size_t threadCount)
+	: threadCount(threadCount) {
+		if (this->threadCount == 0) {
+			this->threadCount = max(thread::hardware_concurrency(), 1u);
+		}
+	}
+
+	//----------
+	RawDecoder::Format RawDecoder::getFormat(const char * data, size_t size) {
+		if (data == nullptr) {
+			return Format::Unknown;
+		}
+		if (size >= 16
+			&& memcmp(data, "II*\0", 4) == 0
+			&& data[8] == 'C' && data[9] == 'R') {
+			return Format::CR2;
+		}
+		if (size >= 12
+			&& memcmp(data + 4, "ftypcrx ", 8) == 0) {
+			return Format::CR3;
+		}
+		return Format::Unknown;
+	}
+
+	//----------
+	bool RawDecoder::decode(const char * data, size_t size) {
+		switch (RawDecoder::getFormat(data, size)) {
+		case Format::CR2:
+			return this->decodeCR2((const uint8_t *) data, size);
+		case Format::CR3:
+			ofLogWarning("ofxCanon") << "RawDecoder : CR3 (CRX) payloads aren't supported, use loadImage instead";
+			return false;
+		default:
+			ofLogError("ofxCanon") << "RawDecoder : Data is not a CR2 or CR3 file";
+			return false;
+		}
+	}
+
+	//----------
+	bool RawDecoder::decode(const EncodedBuffer & encodedBuffer) {
+		return this->decode(encodedBuffer.getData(), encodedBuffer.size());
+	}
+
+	//----------
+	const RawDecoder::Mosaic & RawDecoder::getMosaic() const {
+		return this->mosaic;
+	}
+
+	//----------
+	ofShortPixels & RawDecoder::getPixels() {
+		return this->pixels;
+	}
+
+	//----------
+	bool RawDecoder::decodeCR2(const uint8_t * data, size_t size) {
+		// The header holds the offset of the raw IFD (IFD3) after 'CR' and the version
+		auto rawIfdOffset = get32(data + 12);
+
+		auto stripOffsets = getTagValues(data, size, rawIfdOffset, TAG_STRIP_OFFSETS);
+		auto stripByteCounts = getTagValues(data, size, rawIfdOffset, TAG_STRIP_BYTE_COUNTS);
+		if (stripOffsets.empty() || stripByteCounts.empty()
+			|| (size_t) stripOffsets[0] >= size) {
+			ofLogError("ofxCanon") << "RawDecoder : Couldn't find the raw data in the CR2";
+			return false;
+		}
+		auto stripSize = min((size_t) stripByteCounts[0], size - stripOffsets[0]);
+
+		Frame frame;
+		if (!this->parseJpegHeaders(data + stripOffsets[0], stripSize, frame)) {
+			return false;
+		}
+
+		// The rows of the JPEG are cut into vertical slices of the sensor image
+		Slices slices;
+		{
+			auto slicesTag = getTagValues(data, size, rawIfdOffset, TAG_CR2_SLICES);
+			if (slicesTag.size() >= 3 && slicesTag[1] > 0 && slicesTag[2] > 0) {
+				slices.count = slicesTag[0];
+				slices.width = slicesTag[1];
+				slices.lastWidth = slicesTag[2];
+			}
+			else {
+				slices.lastWidth = frame.width * frame.componentCount;
+			}
+		}
+
+		auto sampleCount = (size_t) frame.width * frame.componentCount * frame.height;
+		if (sampleCount == 0 || sampleCount > stripSize * 8) {
+			// every sample takes at least 1 bit
+			ofLogError("ofxCanon") << "RawDecoder : Raw data is too small for a " << frame.width << "x" << frame.height << " frame";
+			return false;
+		}
+		auto width = slices.count * slices.width + slices.lastWidth;
+		if (width <= 0 || sampleCount % width != 0) {
+			ofLogError("ofxCanon") << "RawDecoder : CR2 slices don't match the size of the raw data";
+			return false;
+		}
+		auto height = (int) (sampleCount / width);
+
+		if (this->pixels.getWidth() != (size_t) width
+			|| this->pixels.getHeight() != (size_t) height
+			|| this->pixels.getNumChannels() != 1) {
+			this->pixels.allocate(width, height, OF_PIXELS_GRAY);
+		}
+
+		this->mosaic = Mosaic();
+		this->mosaic.data = this->pixels.getData();
+		this->mosaic.width = width;
+		this->mosaic.height = height;
+		this->mosaic.bitDepth = frame.precision;
+		this->mosaic.whiteLevel = (1 << frame.precision) - 1;
+		this->mosaic.activeWidth = width;
+		this->mosaic.activeHeight = height;
+
+		if (!this->decodeScan(frame, slices)) {
+			return false;
+		}
+
+		// The borders of the active area are in the Canon MakerNote (IFD0 > EXIF > MakerNote > SensorInfo)
+		{
+			uint16_t type;
+			uint32_t count;
+			auto exifIfd = getTagValues(data, size, get32(data + 4), TAG_EXIF_IFD);
+			auto makerNote = exifIfd.empty()
+				? nullptr
+				: findTag(data, size, exifIfd[0], TAG_MAKER_NOTE, type, count);
+			auto sensorInfo = makerNote
+				? getTagValues(data, size, (uint32_t) (makerNote - data), TAG_CANON_SENSOR_INFO)
+				: vector<uint32_t>();
+
+			if (sensorInfo.size() >= 9) {
+				// Borders are inclusive
+				int left = sensorInfo[5];
+				int top = sensorInfo[6];
+				int right = sensorInfo[7];
+				int bottom = sensorInfo[8];
+				if (left <= right && right < width
+					&& top <= bottom && bottom < height) {
+					this->mosaic.activeLeft = left;
+					this->mosaic.activeTop = top;
+					this->mosaic.activeWidth = right - left + 1;
+					this->mosaic.activeHeight = bottom - top + 1;
+				}
+			}
+		}
+
+		// Canon's CR2 sensors are RGGB from the corner of the active area
+		this->mosaic.activeCFAPattern = CFAPattern::RGGB;
+		this->mosaic.cfaPattern = (CFAPattern) ((uint8_t) CFAPattern::RGGB
+			^ (this->mosaic.activeLeft & 1)
+			^ ((this->mosaic.activeTop & 1) << 1));
+
+		this->measureBlackLevel();
+
+		return true;
+	}
+
+	//----------
+	bool RawDecoder::parseJpegHeaders(const uint8_t * data, size_t size, Frame & frame) {
+		if (size < 4 || data[0] != 0xFF || data[1] != 0xD8) {
+			ofLogError("ofxCanon") << "RawDecoder : Raw data is not a JPEG stream";
+			return false;
+		}
+
+		for (auto & table : this->huffmanTables) {
+			table.isSet = false;
+		}
+
+		int componentIDs[4];
+		size_t position = 2;
+		while (position + 4 <= size) {
+			if (data[position] != 0xFF) {
+				ofLogError("ofxCanon") << "RawDecoder : Expected a JPEG marker";
+				return false;
+			}
+			auto marker = data[position + 1];
+			if (marker == 0xFF) {
+				// fill byte
+				position++;
+				continue;
+			}
+
+			auto length = get16BigEndian(data + position + 2);
+			auto segment = data + position + 4;
+			auto segmentEnd = data + position + 2 + length;
+			if (length < 2 || position + 2 + length > size) {
+				ofLogError("ofxCanon") << "RawDecoder : JPEG segment runs past the end of the data";
+				return false;
+			}
+
+			switch (marker) {
+			case 0xC4: // DHT
+			{
+				auto tableData = segment;
+				while (tableData + 17 <= segmentEnd) {
+					auto & table = this->huffmanTables[tableData[0] & 0x03];
+					auto counts = tableData + 1;
+					int valueCount = 0;
+					for (int i = 0; i < 16; i++) {
+						valueCount += counts[i];
+					}
+					if (tableData + 17 + valueCount > segmentEnd) {
+						ofLogError("ofxCanon") << "RawDecoder : Invalid Huffman table";
+						return false;
+					}
+					table.values.assign(tableData + 17, tableData + 17 + valueCount);
+					for (auto value : table.values) {
+						if (value > 16) {
+							ofLogError("ofxCanon") << "RawDecoder : Invalid Huffman table";
+							return false;
+						}
+					}
+
+					// Canonical codes, shortest first
+					table.lookup.assign(1 << HuffmanTable::LookupBits, 0);
+					int code = 0;
+					int valueIndex = 0;
+					for (int length = 1; length <= 16; length++) {
+						table.valueOffset[length] = valueIndex - code;
+						for (int i = 0; i < counts[length - 1]; i++) {
+							if (code >= (1 << length)) {
+								ofLogError("ofxCanon") << "RawDecoder : Invalid Huffman table";
+								return false;
+							}
+							if (length <= HuffmanTable::LookupBits) {
+								auto shift = HuffmanTable::LookupBits - length;
+								auto entry = (uint16_t) ((length << 8) | table.values[valueIndex]);
+								std::fill(table.lookup.begin() + (code << shift)
+									, table.lookup.begin() + ((code + 1) << shift)
+									, entry);
+							}
+							code++;
+							valueIndex++;
+						}
+						table.maxCode[length] = counts[length - 1] > 0 ? code - 1 : -1;
+						code <<= 1;
+					}
+					table.maxCode[17] = INT32_MAX; // ends the search on corrupt data
+
+					// Where the code and its extra bits both fit in the lookup, store the difference itself
+					table.differenceLookup.assign(1 << HuffmanTable::LookupBits, 0);
+					for (uint32_t bits = 0; bits < table.lookup.size(); bits++) {
+						auto entry = table.lookup[bits];
+						if (entry == 0) {
+							continue;
+						}
+						int length = entry >> 8;
+						int category = entry & 0xFF;
+						if (category == 16) {
+							table.differenceLookup[bits] = (length << 16) | 32768;
+							continue;
+						}
+						if (length + category > HuffmanTable::LookupBits) {
+							continue;
+						}
+						int difference = (bits >> (HuffmanTable::LookupBits - length - category)) & ((1 << category) - 1);
+						if (category > 0 && difference < (1 << (category - 1))) {
+							difference -= (1 << category) - 1;
+						}
+						table.differenceLookup[bits] = ((length + category) << 16) | (uint16_t) difference;
+					}
+					table.isSet = true;
+
+					tableData += 17 + valueCount;
+				}
+				break;
+			}
+			case 0xC3: // SOF3 (lossless, Huffman)
+			{
+				if (length < 8) {
+					return false;
+				}
+				frame.precision = segment[0];
+				frame.height = get16BigEndian(segment + 1);
+				frame.width = get16BigEndian(segment + 3);
+				frame.componentCount = segment[5];
+				if (frame.componentCount < 1 || frame.componentCount > 4
+					|| length < 8 + frame.componentCount * 3
+					|| frame.precision < 2 || frame.precision > 16) {
+					ofLogError("ofxCanon") << "RawDecoder : Unsupported lossless JPEG frame";
+					return false;
+				}
+				for (int i = 0; i < frame.componentCount; i++) {
+					componentIDs[i] = segment[6 + i * 3];
+					if (segment[7 + i * 3] != 0x11) {
+						ofLogError("ofxCanon") << "RawDecoder : Subsampled components (e.g. sRAW / mRAW) aren't supported";
+						return false;
+					}
+				}
+				break;
+			}
+			case 0xC0: // other SOFs
+			case 0xC1:
+			case 0xC2:
+			case 0xC5:
+			case 0xC6:
+			case 0xC7:
+			case 0xC9:
+			case 0xCA:
+			case 0xCB:
+			case 0xCD:
+			case 0xCE:
+			case 0xCF:
+				ofLogError("ofxCanon") << "RawDecoder : Raw data is not lossless JPEG";
+				return false;
+			case 0xDD: // DRI
+				if (length >= 4 && get16BigEndian(segment) != 0) {
+					ofLogError("ofxCanon") << "RawDecoder : Restart intervals aren't supported";
+					return false;
+				}
+				break;
+			case 0xDA: // SOS
+			{
+				if (frame.componentCount == 0 || segment[0] != frame.componentCount
+					|| length < 6 + frame.componentCount * 2) {
+					ofLogError("ofxCanon") << "RawDecoder : Scan doesn't match the frame";
+					return false;
+				}
+				for (int i = 0; i < frame.componentCount; i++) {
+					auto id = segment[1 + i * 2];
+					auto table = segment[2 + i * 2] >> 4;
+					int componentIndex = i;
+					for (int j = 0; j < frame.componentCount; j++) {
+						if (componentIDs[j] == id) {
+							componentIndex = j;
+						}
+					}
+					if (table > 3 || !this->huffmanTables[table].isSet) {
+						ofLogError("ofxCanon") << "RawDecoder : Scan uses a missing Huffman table";
+						return false;
+					}
+					frame.componentTable[componentIndex] = table;
+				}
+				auto scanParameters = segment + 1 + frame.componentCount * 2;
+				frame.predictor = scanParameters[0];
+				frame.pointTransform = scanParameters[2] & 0x0F;
+				if (frame.predictor != 1) {
+					ofLogError("ofxCanon") << "RawDecoder : Lossless JPEG predictor " << frame.predictor << " isn't supported";
+					return false;
+				}
+				if (frame.pointTransform >= frame.precision) {
+					ofLogError("ofxCanon") << "RawDecoder : Invalid point transform";
+					return false;
+				}
+				frame.scan = segmentEnd;
+				frame.end = data + size;
+				return true;
+			}
+			default:
+				break;
+			}
+
+			position += 2 + length;
+		}
+
+		ofLogError("ofxCanon") << "RawDecoder : No scan found in the JPEG stream";
+		return false;
+	}
+
+	//----------
+	bool RawDecoder::decodeScan(const Frame & frame, const Slices & slices) {
+		const auto componentCount = frame.componentCount;
+		const auto rowSamples = frame.width * componentCount;
+		this->scanBuffer.resize((size_t) rowSamples * frame.height);
+
+		const HuffmanTable * tables[4];
+		for (int i = 0; i < componentCount; i++) {
+			tables[i] = &this->huffmanTables[frame.componentTable[i]];
+		}
+
+		// Bands of rows are handed to the other threads as soon as their differences are decoded.
+		// They sleep until then, since the Huffman decode takes most of the time.
+		mutex bandsMutex;
+		condition_variable bandsChanged;
+		int rowsDecoded = 0;
+		int nextBandStart = 0;
+		bool failed = false;
+
+		auto reconstructBands = [&]() {
+			unique_lock<mutex> lock(bandsMutex);
+			while (true) {
+				bandsChanged.wait(lock, [&]() {
+					return failed
+						|| nextBandStart >= frame.height
+						|| nextBandStart < rowsDecoded;
+				});
+				if (failed || nextBandStart >= frame.height) {
+					return;
+				}
+
+				auto bandStart = nextBandStart;
+				auto bandEnd = min(rowsDecoded, bandStart + RAW_DECODER_BAND_ROWS);
+				nextBandStart = bandEnd;
+				if (nextBandStart >= frame.height) {
+					// wake the others so they can finish
+					bandsChanged.notify_all();
+				}
+
+				lock.unlock();
+				for (int row = bandStart; row < bandEnd; row++) {
+					this->reconstructRow(frame, slices, row);
+				}
+				lock.lock();
+			}
+		};
+
+		vector<thread> workers;
+		for (size_t i = 1; i < this->threadCount; i++) {
+			workers.emplace_back(reconstructBands);
+		}
+
+		BitReader reader(frame.scan, frame.end);
+		const auto initialPrediction = (uint16_t) (1 << (frame.precision - frame.pointTransform - 1));
+
+		for (int row = 0; row < frame.height; row++) {
+			auto samples = this->scanBuffer.data() + (size_t) row * rowSamples;
+
+			for (int x = 0; x < rowSamples; x += componentCount) {
+				for (int component = 0; component < componentCount; component++) {
+					const auto & table = *tables[component];
+
+					if (reader.bitCount < 32) {
+						reader.fill();
+					}
+
+					auto fastEntry = table.differenceLookup[reader.peek(HuffmanTable::LookupBits)];
+					if (fastEntry != 0) {
+						reader.skip(fastEntry >> 16);
+						samples[x + component] = (uint16_t) fastEntry;
+						continue;
+					}
+
+					int length;
+					int category;
+					auto entry = table.lookup[reader.peek(HuffmanTable::LookupBits)];
+					if (entry != 0) {
+						length = entry >> 8;
+						category = entry & 0xFF;
+					}
+					else {
+						length = HuffmanTable::LookupBits + 1;
+						int code = reader.peek(length);
+						while (code > table.maxCode[length]) {
+							length++;
+							code = reader.peek(length);
+						}
+						category = length <= 16
+							? table.values[(table.valueOffset[length] + code) % table.values.size()]
+							: 0;
+					}
+					reader.skip(min(length, 16));
+
+					// The difference from the prediction (modulo 2^16)
+					int difference = 0;
+					if (category == 16) {
+						difference = 32768;
+					}
+					else if (category > 0) {
+						difference = reader.peek(category);
+						reader.skip(category);
+						if (difference < (1 << (category - 1))) {
+							difference -= (1 << category) - 1;
+						}
+					}
+					samples[x + component] = (uint16_t) difference;
+				}
+			}
+
+			// Each row starts from the first value of the row above, which reconstructRow leaves untouched
+			for (int component = 0; component < componentCount; component++) {
+				samples[component] += row == 0
+					? initialPrediction
+					: samples[component - rowSamples];
+			}
+
+			if (reader.isOverrun()) {
+				{
+					unique_lock<mutex> lock(bandsMutex);
+					failed = true;
+				}
+				bandsChanged.notify_all();
+				break;
+			}
+
+			if ((row + 1) % RAW_DECODER_BAND_ROWS == 0 || row + 1 == frame.height) {
+				{
+					unique_lock<mutex> lock(bandsMutex);
+					rowsDecoded = row + 1;
+				}
+				bandsChanged.notify_one();
+			}
+		}
+
+		// Help with whatever is left
+		reconstructBands();
+		for (auto & worker : workers) {
+			worker.join();
+		}
+
+		if (failed) {
+			ofLogError("ofxCanon") << "RawDecoder : Lossless JPEG data is truncated or corrupt";
+			return false;
+		}
+		return true;
+	}
+
+	//----------
+	void RawDecoder::reconstructRow(const Frame & frame, const Slices & slices, int row) {
+		const auto componentCount = frame.componentCount;
+		const auto rowSamples = frame.width * componentCount;
+		auto samples = this->scanBuffer.data() + (size_t) row * rowSamples;
+
+		// Predictor 1 : the previous value of the same component
+		// (the first values are already done, and the next row predicts from them)
+		for (int x = componentCount; x < rowSamples; x++) {
+			samples[x] += samples[x - componentCount];
+		}
+
+		// Copy into the slices which this row of the JPEG covers
+		auto output = this->pixels.getData();
+		const auto width = this->mosaic.width;
+		const auto height = (size_t) this->mosaic.height;
+		const auto fullSliceSize = (size_t) slices.width * height;
+
+		auto sampleIndex = (size_t) row * rowSamples;
+		int remaining = rowSamples;
+		while (remaining > 0) {
+			auto slice = fullSliceSize > 0
+				? min(sampleIndex / fullSliceSize, (size_t) slices.count)
+				: (size_t) 0;
+			auto sliceWidth = (int) slice < slices.count ? slices.width : slices.lastWidth;
+			auto offsetInSlice = sampleIndex - slice * fullSliceSize;
+			auto y = offsetInSlice / sliceWidth;
+			auto x = (int) (offsetInSlice % sliceWidth);
+			auto count = min(sliceWidth - x, remaining);
+
+			auto outputRun = output + y * width + slice * slices.width + x;
+			if (frame.pointTransform == 0) {
+				memcpy(outputRun, samples, count * sizeof(uint16_t));
+			}
+			else {
+				for (int i = 0; i < count; i++) {
+					outputRun[i] = samples[i] << frame.pointTransform;
+				}
+			}
+
+			samples += count;
+			sampleIndex += count;
+			remaining -= count;
+		}
+	}
+
+	//----------
+	void RawDecoder::measureBlackLevel() {
+		// Use the masked columns left of the active area, away from their edges
+		const int margin = 4;
+		auto left = margin;
+		auto right = this->mosaic.activeLeft - margin;
+		if (right <= left) {
+			this->mosaic.blackLevel = 0;
+			return;
+		}
+
+		uint64_t total = 0;
+		uint64_t count = 0;
+		for (int y = this->mosaic.activeTop; y < this->mosaic.activeTop + this->mosaic.activeHeight; y++) {
+			auto row = this->mosaic.data + (size_t) y * this->mosaic.width;
+			for (int x = left; x < right; x++) {
+				total += row[x];
+			}
+			count += right - left;
+		}
+		this->mosaic.blackLevel = count > 0
+			? (int) ((total + count / 2) / count)
+			: 0;
+	}
+}
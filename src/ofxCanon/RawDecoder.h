@@ -0,0 +1,115 @@
+#pragma once
+
+#include "EncodedBuffer.h"
+
+#include "ofPixels.h"
+
+#include <vector>
+#include <stdint.h>
+
+namespace ofxCanon {
+	/*
+		Reads the sensor mosaic straight out of a CR2 file, without going through FreeImage / LibRaw.
+
+		The lossless JPEG payload is Huffman decoded on the calling thread, whilst the other threads
+		undo the prediction and the CR2 slicing for rows which have already been decoded. The result
+		is written into a buffer owned by the decoder which is reused for the next file, and
+		getPixels() is a view onto that buffer (so it's overwritten by the next decode).
+
+		The mosaic is the whole sensor including the masked border (the same as loading with
+		RAW_UNPROCESSED). The active area, CFA pattern and black / white levels come with it.
+
+		CR3 files are recognised but their CRX payload isn't supported, so decode() returns false
+		and the caller should fall back to loadImage. sRAW / mRAW files are also not supported.
+	*/
+	class RawDecoder {
+	public:
+		enum class Format {
+			Unknown,
+			CR2,
+			CR3
+		};
+
+		// Colour of the 2x2 block starting at a given pixel, in reading order
+		enum class CFAPattern : uint8_t {
+			RGGB = 0,
+			GRBG,
+			GBRG,
+			BGGR
+		};
+
+		struct Mosaic {
+			const uint16_t * data = nullptr; // width * height values, tightly packed
+			int width = 0;
+			int height = 0;
+
+			// The exposed part of the sensor (the rest is masked)
+			int activeLeft = 0;
+			int activeTop = 0;
+			int activeWidth = 0;
+			int activeHeight = 0;
+
+			CFAPattern cfaPattern = CFAPattern::RGGB; // at (0, 0) of the whole mosaic
+			CFAPattern activeCFAPattern = CFAPattern::RGGB; // at (activeLeft, activeTop)
+
+			int bitDepth = 0;
+			int blackLevel = 0; // mean of the masked pixels left of the active area
+			int whiteLevel = 0; // (1 << bitDepth) - 1. The sensor may clip lower than this
+		};
+
+		RawDecoder(size_t threadCount = 0); // 0 uses all hardware threads
+
+		static Format getFormat(const char * data, size_t size);
+
+		bool decode(const char * data, size_t size);
+		bool decode(const EncodedBuffer &);
+
+		const Mosaic & getMosaic() const;
+		ofShortPixels & getPixels(); // single channel view onto the mosaic (valid until the next decode)
+	protected:
+		struct HuffmanTable {
+			// Codes up to LookupBits long are found in one step : (length << 8) | value, 0 if longer
+			static const int LookupBits = 14;
+			std::vector<uint16_t> lookup;
+			std::vector<uint32_t> differenceLookup; // (code + extra bits length) << 16 | difference, 0 if they don't fit
+
+			// For the longer codes
+			int32_t maxCode[18];
+			int32_t valueOffset[18];
+			std::vector<uint8_t> values;
+
+			bool isSet = false;
+		};
+
+		struct Frame {
+			int precision = 0;
+			int width = 0; // samples per component per row
+			int height = 0;
+			int componentCount = 0;
+			int componentTable[4];
+			int predictor = 0;
+			int pointTransform = 0;
+			const uint8_t * scan = nullptr;
+			const uint8_t * end = nullptr;
+		};
+
+		struct Slices {
+			int count = 0;
+			int width = 0;
+			int lastWidth = 0;
+		};
+
+		bool decodeCR2(const uint8_t * data, size_t size);
+		bool parseJpegHeaders(const uint8_t * data, size_t size, Frame &);
+		bool decodeScan(const Frame &, const Slices &);
+		void reconstructRow(const Frame &, const Slices &, int row);
+		void measureBlackLevel();
+
+		size_t threadCount;
+		HuffmanTable huffmanTables[4];
+
+		std::vector<uint16_t> scanBuffer; // decoded rows in JPEG order (before unslicing)
+		ofShortPixels pixels;
+		Mosaic mosaic;
+	};
+}
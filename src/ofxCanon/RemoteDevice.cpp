@@ -1,8 +1,19 @@
 #include "RemoteDevice.h"
-#include "CustomRequest.h"
 
 #define LOG_ERROR ofLogError("ofxCanon::RemoteDevice")
 
+// The camera answers a long poll as soon as something changes, or after about 30s without events
+#define POLL_TIMEOUT_SECONDS 40.0f
+#define POLL_BACKOFF_MIN std::chrono::milliseconds(100)
+#define POLL_BACKOFF_MAX std::chrono::milliseconds(5000)
+
+// The command thread wakes as soon as a command is queued, this is only for noticing close()
+#define COMMAND_THREAD_IDLE_TIMEOUT_MS 100
+
+// The live view stream is reopened if no data arrives for this long
+#define LIVE_VIEW_STALL_TIMEOUT_SECONDS 5.0f
+#define LIVE_VIEW_RETRY_INTERVAL std::chrono::milliseconds(500)
+
 namespace ofxCanon {
 	//----------
 	RemoteDevice::RemoteDevice()
@@ -22,13 +33,15 @@ namespace ofxCanon {
 	{
 		this->hostname = hostname;
 
-		ofHttpRequest request;
 		{
-			request.method = ofHttpRequest::GET;
-			request.url = "http://" + hostname + ":8080/ccapi/ver100/deviceinformation";
-			request.timeoutSeconds = 5.0;
+			std::unique_lock<std::mutex> lock(this->optionsMutex);
+			this->ISOOptions = CachedOptions<int>();
+			this->apertureOptions = CachedOptions<float>();
+			this->shutterSpeedOptions = CachedOptions<float>();
+			this->currentValues.clear();
 		}
-		auto response = this->urlLoader.handleRequest(request);
+
+		auto response = this->httpClient.get("http://" + hostname + ":8080/ccapi/ver100/deviceinformation", 5.0f);
 		if (response.status != 200) {
 			LOG_ERROR << "Failed to connect to CCAPI on " << hostname;
 			return false;
@@ -65,7 +78,7 @@ namespace ofxCanon {
 			while (this->thread.state == Thread::State::Running) {
 				// perform action queue
 				std::function<void()> action;
-				while (this->thread.actionQueue.tryReceive(action)) {
+				if (this->thread.actionQueue.tryReceive(action, COMMAND_THREAD_IDLE_TIMEOUT_MS)) {
 					try {
 						action();
 					}
@@ -73,9 +86,44 @@ namespace ofxCanon {
 						LOG_ERROR << e.message;
 					}
 				}
+			}
+			});
+
+		this->thread.pollThread = std::thread([this]() {
+			auto backoff = std::chrono::milliseconds(0);
+			while (this->thread.state == Thread::State::Running) {
+				bool success = false;
+				try {
+					success = this->poll();
+				}
+				catch (const Exception& e) {
+					LOG_ERROR << e.message;
+				}
+				catch (const nlohmann::json::exception& e) {
+					LOG_ERROR << "Couldn't parse poll response : " << e.what();
+				}
+
+				// back off exponentially whilst the camera is failing
+				if (success) {
+					backoff = std::chrono::milliseconds(0);
+				}
+				else {
+					backoff = backoff.count() == 0
+						? POLL_BACKOFF_MIN
+						: std::min(backoff * 2, POLL_BACKOFF_MAX);
+				}
+
+				{
+					std::unique_lock<std::mutex> lock(this->statsMutex);
+					this->stats.pollBackoff = backoff;
+				}
 
-				// poll
-				this->poll();
+				if (backoff.count() > 0) {
+					std::unique_lock<std::mutex> lock(this->thread.backoffMutex);
+					this->thread.backoffInterrupted.wait_for(lock, backoff, [this]() {
+						return this->thread.state != Thread::State::Running;
+					});
+				}
 			}
 			});
 
@@ -87,8 +135,19 @@ namespace ofxCanon {
 		RemoteDevice::close()
 	{
 		if (this->thread.state != Thread::State::Closed) {
-			this->thread.state = Thread::State::Joining;
+			{
+				std::unique_lock<std::mutex> lock(this->thread.backoffMutex);
+				this->thread.state = Thread::State::Joining;
+			}
+			this->thread.backoffInterrupted.notify_all();
+			this->pollClient.setCancelled(true); // abort the long poll
+			this->stopLiveViewThread();
+
 			this->thread.thread.join();
+			this->thread.pollThread.join();
+			this->downloadManager.cancelAll();
+
+			this->pollClient.setCancelled(false);
 			this->thread.state = Thread::State::Closed;
 		}
 	}
@@ -100,6 +159,14 @@ namespace ofxCanon {
 		return this->deviceInfo;
 	}
 
+	//----------
+	RemoteDevice::Stats
+		RemoteDevice::getStats() const
+	{
+		std::unique_lock<std::mutex> lock(this->statsMutex);
+		return this->stats;
+	}
+
 	//----------
 	void
 		RemoteDevice::update()
@@ -109,19 +176,18 @@ namespace ofxCanon {
 		}
 
 		this->frameIsNew = false;
+		this->liveViewIsNew = false;
 
-		// Receive incoming images
-		{
-			ofBuffer buffer;
-
-			while (this->incomingImages.tryReceive(buffer)) {
-				this->frameIsNew = true;
-			}
+		// Receive decoded images (only the texture upload happens here)
+		if (this->decodePool.receiveLiveView(this->pixels)) {
+			this->image.setFromPixels(this->pixels);
+			this->frameIsNew = true;
+			this->waitingForPhoto = false;
+		}
 
-			if (this->frameIsNew) {
-				this->image.load(buffer);
-				this->waitingForPhoto = false;
-			}
+		if (this->liveViewEnabled && this->liveViewDecodePool.receiveLiveView(this->liveViewPixels)) {
+			this->liveViewTexture.loadData(this->liveViewPixels);
+			this->liveViewIsNew = true;
 		}
 
 		// Receive incoming actions
@@ -147,26 +213,46 @@ namespace ofxCanon {
 		return this->image;
 	}
 
+	//----------
+	const ofPixels &
+		RemoteDevice::getPixels() const
+	{
+		return this->pixels;
+	}
+
+	//----------
+	void
+		RemoteDevice::setPreviewSize(int previewSize)
+	{
+		this->decodePool.setLiveViewMaxSize(previewSize);
+	}
+
+	//----------
+	int
+		RemoteDevice::getPreviewSize() const
+	{
+		return this->decodePool.getLiveViewMaxSize();
+	}
+
+	//----------
+	DecodePool::Stats
+		RemoteDevice::getDecodeStats() const
+	{
+		return this->decodePool.getStats();
+	}
+
 	//----------
 	bool 
 		RemoteDevice::takePhoto(bool autoFocus)
 	{
-		this->thread.actionQueue.send([this, autoFocus]() {
-			ofHttpRequest request;
-			{
-				request.method = ofHttpRequest::POST;
-				request.url = this->getBaseURL() + "shooting/control/shutterbutton";
-
-				nlohmann::json requestData;
-				requestData["af"] = autoFocus;
-				request.body = requestData.dump();
-			}
+		this->performInCommandThread([this, autoFocus]() {
+			nlohmann::json requestData;
+			requestData["af"] = autoFocus;
 
-			auto response = this->urlLoader.handleRequest(request);
+			auto response = this->httpClient.post(this->getBaseURL() + "shooting/control/shutterbutton", requestData.dump());
 
 			if (response.status != 200) {
 				LOG_ERROR << "Couldn't take photo : " << response.data;
-				return false;
 			}
 			});
 
@@ -175,6 +261,73 @@ namespace ofxCanon {
 		return true;
 	}
 
+	//----------
+	bool
+		RemoteDevice::setLiveViewEnabled(bool enabled, const string& size, bool enableCameraScreen)
+	{
+		if (this->thread.state != Thread::State::Running) {
+			LOG_ERROR << "Can't change live view whilst the device is closed";
+			return false;
+		}
+
+		this->stopLiveViewThread();
+
+		nlohmann::json requestData;
+		requestData["liveviewsize"] = enabled ? size : "off";
+		requestData["cameradisplay"] = enabled
+			? (enableCameraScreen ? "on" : "off")
+			: "keep";
+
+		auto response = this->httpClient.post(this->getBaseURL() + "shooting/liveview", requestData.dump());
+		if (response.status != 200) {
+			LOG_ERROR << "Couldn't " << (enabled ? "start" : "stop") << " live view : " << response.data;
+			return false;
+		}
+
+		if (enabled) {
+			this->liveViewEnabled = true;
+			this->thread.liveViewThread = std::thread([this]() {
+				this->liveViewLoop();
+				});
+		}
+		return true;
+	}
+
+	//----------
+	bool
+		RemoteDevice::getLiveViewEnabled() const
+	{
+		return this->liveViewEnabled;
+	}
+
+	//----------
+	bool
+		RemoteDevice::isLiveViewFrameNew() const
+	{
+		return this->liveViewIsNew;
+	}
+
+	//----------
+	const ofPixels &
+		RemoteDevice::getLiveViewPixels() const
+	{
+		return this->liveViewPixels;
+	}
+
+	//----------
+	ofTexture &
+		RemoteDevice::getLiveViewTexture()
+	{
+		return this->liveViewTexture;
+	}
+
+	//----------
+	DecodePool::Stats
+		RemoteDevice::getLiveViewDecodeStats() const
+	{
+		return this->liveViewDecodePool.getStats();
+	}
+
 	//----------
 	string
 		RemoteDevice::getBaseURL() const
@@ -182,6 +335,27 @@ namespace ofxCanon {
 		return "http://" + this->hostname + ":8080/ccapi/ver100/";
 	}
 
+	//----------
+	HttpClient::Stats
+		RemoteDevice::getHttpStats() const
+	{
+		return this->httpClient.getStats();
+	}
+
+	//----------
+	HttpClient::Stats
+		RemoteDevice::getPollHttpStats() const
+	{
+		return this->pollClient.getStats();
+	}
+
+	//----------
+	DownloadManager::Stats
+		RemoteDevice::getDownloadStats() const
+	{
+		return this->downloadManager.getStats();
+	}
+
 	//----------
 	void
 		RemoteDevice::setKeepFilesOnDevice(bool value)
@@ -252,7 +426,7 @@ namespace ofxCanon {
 	bool
 		RemoteDevice::getISO(int& value) const
 	{
-		auto json = this->get("shooting/settings/shootingmode");
+		auto json = this->get("shooting/settings/iso");
 		if (!json.contains("value")) {
 			return false;
 		}
@@ -266,10 +440,7 @@ namespace ofxCanon {
 	bool
 		RemoteDevice::setISO(int value)
 	{
-		nlohmann::json json;
-		json["value"] = this->convertISOToDevice(value);
-		auto result = this->put("shooting/settings/iso", json);
-		return result.contains("value");
+		return this->putSetting("iso", this->convertISOToDevice(value));
 	}
 
 	//----------
@@ -290,10 +461,7 @@ namespace ofxCanon {
 	bool
 		RemoteDevice::setAperture(float value)
 	{
-		nlohmann::json json;
-		json["value"] = RemoteDevice::convertApertureToDevice(value);
-		auto result = this->put("shooting/settings/av", json);
-		return result.contains("value");
+		return this->putSetting("av", this->convertApertureToDevice(value));
 	}
 
 	//----------
@@ -314,38 +482,75 @@ namespace ofxCanon {
 	bool
 		RemoteDevice::setShutterSpeed(float value)
 	{
-		nlohmann::json json;
-		json["value"] = RemoteDevice::convertShutterSpeedToDevice(value);
-		auto result = this->put("shooting/settings/tv", json);
-		return result.contains("value");
+		return this->putSetting("tv", this->convertShutterSpeedToDevice(value));
 	}
 
 	//----------
-	int
-		RemoteDevice::convertISOFromDevice(string text) const
+	bool
+		RemoteDevice::setExposure(int ISO, float aperture, float shutterSpeed)
 	{
-		if (text == "auto") {
-			return 0;
+		// CCAPI has no request which sets several settings at once, so we resolve every value
+		// first (from the cached options) and then only send the ones which have changed
+		string ISOValue, apertureValue, shutterSpeedValue;
+		if (ISO >= 0) {
+			ISOValue = this->convertISOToDevice(ISO);
 		}
-		else {
-			return ofToInt(text);
+		if (aperture >= 0.0f) {
+			apertureValue = this->convertApertureToDevice(aperture);
+		}
+		if (shutterSpeed >= 0.0f) {
+			shutterSpeedValue = this->convertShutterSpeedToDevice(shutterSpeed);
+		}
+
+		bool success = true;
+		if (ISO >= 0) {
+			success &= this->putSetting("iso", ISOValue);
 		}
+		if (aperture >= 0.0f) {
+			success &= this->putSetting("av", apertureValue);
+		}
+		if (shutterSpeed >= 0.0f) {
+			success &= this->putSetting("tv", shutterSpeedValue);
+		}
+		return success;
 	}
 
 	//----------
+	template<typename T>
+	void
+		RemoteDevice::updateOptions(CachedOptions<T>& options, const vector<string>& optionStrings, T (RemoteDevice::*convertFromDevice)(string) const) const
+	{
+		map<T, string> optionsByValue;
+		for (const auto& optionString : optionStrings) {
+			auto optionValue = (this->*convertFromDevice)(optionString);
+			optionsByValue.emplace(optionValue, optionString);
+		}
+
+		std::unique_lock<std::mutex> lock(this->optionsMutex);
+		options.optionsByValue = std::move(optionsByValue);
+		options.valid = !options.optionsByValue.empty();
+	}
+
+	//----------
+	template<typename T>
 	string
-		RemoteDevice::convertISOToDevice(int value) const
+		RemoteDevice::findClosestOption(CachedOptions<T>& options, const string& name, T value, T (RemoteDevice::*convertFromDevice)(string) const) const
 	{
-		// get all options
-		map<int, string> optionsByValue;
+		// get all options (unless we already have them)
+		bool valid;
 		{
-			auto optionStrings = this->getOptions("shooting/settings/iso");
-			for (const auto& optionString : optionStrings) {
-				auto optionValue = this->convertISOFromDevice(optionString);
-				optionsByValue.emplace(optionValue, optionString);
-			}
+			std::unique_lock<std::mutex> lock(this->optionsMutex);
+			valid = options.valid;
 		}
+		if (!valid) {
+			this->updateOptions(options, this->getOptions("shooting/settings/" + name), convertFromDevice);
 
+			std::unique_lock<std::mutex> lock(this->statsMutex);
+			this->stats.abilityRequests++;
+		}
+
+		std::unique_lock<std::mutex> lock(this->optionsMutex);
+		const auto& optionsByValue = options.optionsByValue;
 		if (optionsByValue.empty()) {
 			LOG_ERROR << "Failed to get options";
 			return "";
@@ -361,6 +566,64 @@ namespace ofxCanon {
 		}
 	}
 
+	//----------
+	void
+		RemoteDevice::updateCurrentValue(const string& name, const string& value)
+	{
+		std::unique_lock<std::mutex> lock(this->optionsMutex);
+		this->currentValues[name] = value;
+	}
+
+	//----------
+	bool
+		RemoteDevice::putSetting(const string& name, const string& value)
+	{
+		if (value.empty()) {
+			return false;
+		}
+
+		bool unchanged;
+		{
+			std::unique_lock<std::mutex> lock(this->optionsMutex);
+			auto find = this->currentValues.find(name);
+			unchanged = find != this->currentValues.end() && find->second == value;
+		}
+		if (unchanged) {
+			std::unique_lock<std::mutex> lock(this->statsMutex);
+			this->stats.settingsUnchanged++;
+			return true;
+		}
+
+		nlohmann::json json;
+		json["value"] = value;
+		auto result = this->put("shooting/settings/" + name, json);
+		if (!result.contains("value")) {
+			return false;
+		}
+
+		this->updateCurrentValue(name, result["value"].get<string>());
+		return true;
+	}
+
+	//----------
+	int
+		RemoteDevice::convertISOFromDevice(string text) const
+	{
+		if (text == "auto") {
+			return 0;
+		}
+		else {
+			return ofToInt(text);
+		}
+	}
+
+	//----------
+	string
+		RemoteDevice::convertISOToDevice(int value) const
+	{
+		return this->findClosestOption(this->ISOOptions, "iso", value, &RemoteDevice::convertISOFromDevice);
+	}
+
 	//----------
 	float
 		RemoteDevice::convertApertureFromDevice(string text) const
@@ -381,29 +644,7 @@ namespace ofxCanon {
 	string
 		RemoteDevice::convertApertureToDevice(float value) const
 	{
-		// get all options
-		map<float, string> optionsByValue;
-		{
-			auto optionStrings = this->getOptions("shooting/settings/av");
-			for (const auto& optionString : optionStrings) {
-				auto optionValue = this->convertApertureFromDevice(optionString);
-				optionsByValue.emplace(optionValue, optionString);
-			}
-		}
-
-		if (optionsByValue.empty()) {
-			LOG_ERROR << "Failed to get options";
-			return "";
-		}
-
-		// find closest option
-		auto find = optionsByValue.lower_bound(value);
-		if (find != optionsByValue.end()) {
-			return find->second;
-		}
-		else {
-			return optionsByValue.rbegin()->second;
-		}
+		return this->findClosestOption(this->apertureOptions, "av", value, &RemoteDevice::convertApertureFromDevice);
 	}
 
 
@@ -441,46 +682,59 @@ namespace ofxCanon {
 	string
 		RemoteDevice::convertShutterSpeedToDevice(float value) const
 	{
-		// get all options
-map<float, string> optionsByValue;
-{
-	auto optionStrings = this->getOptions("shooting/settings/tv");
-	for (const auto& optionString : optionStrings) {
-		auto optionValue = this->convertShutterSpeedFromDevice(optionString);
-		optionsByValue.emplace(optionValue, optionString);
+		return this->findClosestOption(this->shutterSpeedOptions, "tv", value, &RemoteDevice::convertShutterSpeedFromDevice);
 	}
-}
 
-if (optionsByValue.empty()) {
-	LOG_ERROR << "Failed to get options";
-	return "";
-}
-
-// find closest option
-auto find = optionsByValue.lower_bound(value);
-if (find != optionsByValue.end()) {
-	return find->second;
-}
-else {
-	return optionsByValue.rbegin()->second;
-}
+	//----------
+	void
+		RemoteDevice::performInCommandThread(std::function<void()>&& action)
+	{
+		auto timeQueued = std::chrono::high_resolution_clock::now();
+		this->thread.actionQueue.send([this, action, timeQueued]() {
+			action();
+
+			auto latency = (float) std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::high_resolution_clock::now() - timeQueued).count() / 1000.0f;
+			std::unique_lock<std::mutex> lock(this->statsMutex);
+			this->stats.commandsPerformed++;
+			this->stats.averageCommandLatency = this->stats.commandsPerformed == 1
+				? latency
+				: this->stats.averageCommandLatency * 0.9f + latency * 0.1f;
+			this->stats.maxCommandLatency = std::max(this->stats.maxCommandLatency, latency);
+			});
 	}
 
 	//----------
-	void
+	bool
 		RemoteDevice::poll()
 	{
-		ofHttpRequest request;
+		// Long poll on its own connection : the camera replies when something changes
+		auto response = this->pollClient.get(this->getBaseURL() + "event/polling?timeout=long", POLL_TIMEOUT_SECONDS);
+
 		{
-			request.method = ofHttpRequest::GET;
-			request.url = this->getBaseURL() + "event/polling";
-		}
+			std::unique_lock<std::mutex> lock(this->statsMutex);
+			auto now = std::chrono::high_resolution_clock::now();
+			if (this->stats.pollRequests == 0) {
+				this->pollWindowStart = now;
+			}
+			this->stats.pollRequests++;
+			this->pollRequestsInWindow++;
+			if (response.status != 200) {
+				this->stats.pollErrors++;
+			}
 
-		auto response = this->urlLoader.handleRequest(request);
+			auto windowDuration = std::chrono::duration_cast<std::chrono::microseconds>(now - this->pollWindowStart);
+			if (windowDuration >= std::chrono::seconds(1)) {
+				this->stats.pollRequestsPerSecond = (float) this->pollRequestsInWindow * 1e6f / (float) windowDuration.count();
+				this->pollRequestsInWindow = 0;
+				this->pollWindowStart = now;
+			}
+		}
 
 		if (response.status != 200) {
-			LOG_ERROR << "Couldn't poll.";
-			return;
+			if (this->thread.state == Thread::State::Running) {
+				LOG_ERROR << "Couldn't poll : " << (response.error.empty() ? response.data.getText() : response.error);
+			}
+			return false;
 		}
 
 		auto json = nlohmann::json::parse(response.data);
@@ -496,8 +750,18 @@ else {
 		}
 
 		if (json.contains("tv")) {
+			// the options change with the shooting mode, lens etc
+			if (json["tv"].contains("ability") && json["tv"]["ability"].is_array()) {
+				vector<string> optionStrings;
+				for (const auto& ability : json["tv"]["ability"]) {
+					optionStrings.push_back(ability.get<string>());
+				}
+				this->updateOptions(this->shutterSpeedOptions, optionStrings, &RemoteDevice::convertShutterSpeedFromDevice);
+			}
+
 			if (json["tv"].contains("value")) {
 				auto stringValue = json["tv"]["value"].get<string>();
+				this->updateCurrentValue("tv", stringValue);
 				auto value = this->convertShutterSpeedFromDevice(stringValue);
 				this->thread.mainThreadActionQueue.send([this, value]() {
 					auto valueCopy = value;
@@ -507,8 +771,18 @@ else {
 		}
 
 		if (json.contains("av")) {
+			// the options change with the shooting mode, lens etc
+			if (json["av"].contains("ability") && json["av"]["ability"].is_array()) {
+				vector<string> optionStrings;
+				for (const auto& ability : json["av"]["ability"]) {
+					optionStrings.push_back(ability.get<string>());
+				}
+				this->updateOptions(this->apertureOptions, optionStrings, &RemoteDevice::convertApertureFromDevice);
+			}
+
 			if (json["av"].contains("value")) {
 				auto stringValue = json["av"]["value"].get<string>();
+				this->updateCurrentValue("av", stringValue);
 				auto value = this->convertApertureFromDevice(stringValue);
 				this->thread.mainThreadActionQueue.send([this, value]() {
 					auto valueCopy = value;
@@ -518,8 +792,18 @@ else {
 		}
 
 		if (json.contains("iso")) {
+			// the options change with the shooting mode, lens etc
+			if (json["iso"].contains("ability") && json["iso"]["ability"].is_array()) {
+				vector<string> optionStrings;
+				for (const auto& ability : json["iso"]["ability"]) {
+					optionStrings.push_back(ability.get<string>());
+				}
+				this->updateOptions(this->ISOOptions, optionStrings, &RemoteDevice::convertISOFromDevice);
+			}
+
 			if (json["iso"].contains("value")) {
 				auto stringValue = json["iso"]["value"].get<string>();
+				this->updateCurrentValue("iso", stringValue);
 				int value;
 				if (stringValue == "auto") {
 					value = 0;
@@ -539,35 +823,138 @@ else {
 				auto filepath = filenameJson.get<string>();
 				auto extension = ofToLower(ofFilePath::getFileExt(filepath));
 
+				// JPEGs jump ahead of RAW files in the download queue
 				if ((extension == "jpeg" || extension == "jpg") && this->downloadJPEG) {
-					this->getFileFromCamera(filepath);
+					this->getFileFromCamera(filepath, DownloadManager::HighPriority);
 				}
-				if ((extension == "cr2" || extension == "cr3") && this->downloadRAW) {
-					this->getFileFromCamera(filepath);
+				else if ((extension == "cr2" || extension == "cr3") && this->downloadRAW) {
+					this->getFileFromCamera(filepath, DownloadManager::LowPriority);
 				}
-				if (!this->keepFilesOnDevice) {
+				else if (!this->keepFilesOnDevice) {
+					// files which are downloaded are deleted once their download completes
 					this->deleteFileOnCamera(filepath);
 				}
 			}
 		}
+
+		return true;
 	}
 
 	//----------
 	void
-		RemoteDevice::getFileFromCamera(const string& address)
+		RemoteDevice::liveViewLoop()
+	{
+		// Frames are parsed as the stream arrives, and each JPEG goes straight to the decoder (newest wins)
+		uint64_t framesParsed = 0;
+		LiveViewScrollParser parser([this, &framesParsed](LiveViewScrollParser::FrameType frameType, ofBuffer& frame) {
+			if (frameType == LiveViewScrollParser::ImageFrame) {
+				this->liveViewDecodePool.addLiveView(std::move(frame));
+				framesParsed++;
+			}
+			});
+
+		auto sink = [this, &parser, &framesParsed](const char* data, size_t size, uint64_t) {
+			parser.push(data, size);
+
+			std::unique_lock<std::mutex> lock(this->statsMutex);
+			auto now = std::chrono::high_resolution_clock::now();
+			if (this->stats.liveViewBytes == 0) {
+				this->liveViewWindowStart = now;
+			}
+			this->liveViewFramesInWindow += framesParsed - this->stats.liveViewFrames;
+			this->liveViewBytesInWindow += size;
+			this->stats.liveViewFrames = framesParsed;
+			this->stats.liveViewBytes += size;
+			this->stats.liveViewResyncs = parser.getStats().resyncs;
+
+			auto windowDuration = std::chrono::duration_cast<std::chrono::microseconds>(now - this->liveViewWindowStart);
+			if (windowDuration >= std::chrono::seconds(1)) {
+				this->stats.liveViewFramesPerSecond = (float) this->liveViewFramesInWindow * 1e6f / (float) windowDuration.count();
+				this->stats.liveViewBytesPerSecond = (float) this->liveViewBytesInWindow * 1e6f / (float) windowDuration.count();
+				this->liveViewFramesInWindow = 0;
+				this->liveViewBytesInWindow = 0;
+				this->liveViewWindowStart = now;
+			}
+			return true;
+		};
+
+		{
+			std::unique_lock<std::mutex> lock(this->statsMutex);
+			framesParsed = this->stats.liveViewFrames;
+		}
+
+		while (this->liveViewEnabled && this->thread.state == Thread::State::Running) {
+			// The response never completes whilst live view is running
+			parser.reset();
+			auto response = this->liveViewClient.download(this->getBaseURL() + "shooting/liveview/scroll", sink, 0, LIVE_VIEW_STALL_TIMEOUT_SECONDS);
+
+			if (!this->liveViewEnabled || this->thread.state != Thread::State::Running) {
+				break;
+			}
+
+			ofLogWarning("ofxCanon::RemoteDevice") << "Live view stream ended ("
+				<< (response.error.empty() ? "HTTP " + ofToString(response.status) + " " + response.data.getText() : response.error)
+				<< "), reconnecting";
+
+			{
+				std::unique_lock<std::mutex> lock(this->statsMutex);
+				this->stats.liveViewReconnects++;
+			}
+
+			std::unique_lock<std::mutex> lock(this->thread.backoffMutex);
+			this->thread.backoffInterrupted.wait_for(lock, LIVE_VIEW_RETRY_INTERVAL, [this]() {
+				return !this->liveViewEnabled || this->thread.state != Thread::State::Running;
+			});
+		}
+	}
+
+	//----------
+	void
+		RemoteDevice::stopLiveViewThread()
 	{
-		auto response = ofLoadURL("http://" + this->hostname + ":8080" + address);
-		if (response.status == 200) {
-			this->incomingImages.send(response.data);
+		{
+			std::unique_lock<std::mutex> lock(this->thread.backoffMutex);
+			this->liveViewEnabled = false;
+		}
+		this->thread.backoffInterrupted.notify_all();
+
+		if (this->thread.liveViewThread.joinable()) {
+			this->liveViewClient.setCancelled(true); // abort the stream
+			this->thread.liveViewThread.join();
+			this->liveViewClient.setCancelled(false);
 		}
 	}
 
+	//----------
+	void
+		RemoteDevice::getFileFromCamera(const string& address, DownloadManager::Priority priority)
+	{
+		DownloadManager::Request request;
+		request.url = "http://" + this->hostname + ":8080" + address;
+		request.priority = priority;
+		request.deleteAfterDownload = !this->keepFilesOnDevice;
+		request.keepResult = false;
+		request.onComplete = [this](DownloadManager::Result& result) {
+			if (result.success) {
+				this->decodePool.addLiveView(std::move(result.buffer));
+			}
+
+			// notify without the file data
+			result.buffer.clear();
+			this->thread.mainThreadActionQueue.send([this, result]() {
+				auto resultCopy = result;
+				ofNotifyEvent(this->deviceEvents.onDownloadComplete, resultCopy, this);
+				});
+		};
+		this->downloadManager.add(request);
+	}
+
 	//----------
 	void
 		RemoteDevice::deleteFileOnCamera(const string& address)
 	{
 		auto url = "http://" + this->hostname + ":8080" + address;
-		auto response = sendCustomRequest(url, nlohmann::json(), 1.0, "DELETE");
+		auto response = this->pollClient.del(url, 1.0f);
 
 		if (response.status != 200) {
 			auto responseJson = nlohmann::json::parse(response.data);
@@ -580,8 +967,8 @@ else {
 		RemoteDevice::get(const string& address) const
 	{
 		auto url = this->getBaseURL() + address;
-		auto response = ofLoadURL(url);
-		if (!response.status == 200) {
+		auto response = this->httpClient.get(url);
+		if (response.status != 200) {
 			LOG_ERROR << "Failed to get " << address << " : " << response.data;
 			return nlohmann::json();
 		}
@@ -596,7 +983,7 @@ else {
 	{
 		auto url = this->getBaseURL() + address;
 
-		auto response = sendCustomRequest(this->getBaseURL() + address, requestBody, 1.0, "PUT");
+		auto response = this->httpClient.put(url, requestBody.dump(), 1.0f);
 
 		if (response.status != 200) {
 			LOG_ERROR << "Couldn't put to : " << address << " : " << response.data;
@@ -1,7 +1,12 @@
 #pragma once
 
 #include "ofMain.h"
+#include "HttpClient.h"
+#include "DownloadManager.h"
+#include "DecodePool.h"
+#include "LiveViewScrollParser.h"
 #include <future>
+#include <atomic>
 
 namespace ofxCanon {
 	class RemoteDevice {
@@ -27,16 +32,61 @@ namespace ofxCanon {
 
 		DeviceInfo getDeviceInfo() const;
 
+		struct Stats {
+			uint64_t pollRequests = 0;
+			uint64_t pollErrors = 0;
+			float pollRequestsPerSecond = 0.0f;
+			std::chrono::milliseconds pollBackoff{ 0 }; // current wait before retrying a failed poll
+
+			uint64_t commandsPerformed = 0;
+			float averageCommandLatency = 0.0f; // smoothed ms from queuing a command (e.g. takePhoto) until it completes
+			float maxCommandLatency = 0.0f; // ms
+
+			uint64_t liveViewFrames = 0; // JPEG frames received (see getLiveViewDecodeStats for frames dropped before being shown)
+			uint64_t liveViewBytes = 0;
+			uint64_t liveViewResyncs = 0; // partial or corrupt frames which were dropped
+			uint64_t liveViewReconnects = 0;
+			float liveViewFramesPerSecond = 0.0f;
+			float liveViewBytesPerSecond = 0.0f;
+
+			uint64_t abilityRequests = 0; // GETs of a setting's options (otherwise they come from the cache)
+			uint64_t settingsUnchanged = 0; // sets which weren't sent because the camera already had that value
+		};
+		Stats getStats() const;
+
 		void update();
 		bool isFrameNew() const;
 
 		bool takePhoto(bool autoFocus);
 
+		// Live view is streamed from shooting/liveview/scroll on its own connection and decoded in a background thread.
+		// size is the CCAPI liveviewsize ("small" or "medium").
+		bool setLiveViewEnabled(bool, const string& size = "small", bool enableCameraScreen = true);
+		bool getLiveViewEnabled() const;
+		bool isLiveViewFrameNew() const;
+		const ofPixels& getLiveViewPixels() const;
+		ofTexture& getLiveViewTexture();
+		DecodePool::Stats getLiveViewDecodeStats() const;
+
 		
 		ofImage& getImage();
+		const ofPixels& getPixels() const;
+
+		// Photos are decoded in a background thread, update() only uploads the newest one.
+		// Set the longest side (in pixels) to decode a reduced size preview instead, 0 for full size (default).
+		void setPreviewSize(int);
+		int getPreviewSize() const;
+
+		DecodePool::Stats getDecodeStats() const; // e.g. liveViewFramesSuperseded counts photos which were never shown
 
 		string getBaseURL() const;
 
+		HttpClient::Stats getHttpStats() const; // command connection
+		HttpClient::Stats getPollHttpStats() const; // event connection
+
+		// Files are downloaded in parallel on their own connections (JPEGs first)
+		DownloadManager::Stats getDownloadStats() const;
+
 		void setKeepFilesOnDevice(bool);
 		bool getKeepFilesOnDevice() const;
 
@@ -57,6 +107,10 @@ namespace ofxCanon {
 		bool getShutterSpeed(float &) const;
 		bool setShutterSpeed(float);
 
+		// Set ISO, aperture and shutter speed together. Negative values are left as they are.
+		// Only the settings which differ from the camera's current values are sent.
+		bool setExposure(int ISO, float aperture, float shutterSpeed);
+
 		int convertISOFromDevice(string) const;
 		string convertISOToDevice(int) const;
 
@@ -71,23 +125,42 @@ namespace ofxCanon {
 			ofEvent<float> onShutterSpeedChange;
 			ofEvent<float> onApertureChange;
 			ofEvent<int> onISOChange;
+			ofEvent<DownloadManager::Result> onDownloadComplete; // per file, incl. throughput (buffer is empty, see getImage)
 		} deviceEvents;
 	protected:
-		void poll();
-		void getFileFromCamera(const string & address);
+		void performInCommandThread(std::function<void()> &&);
+		bool poll(); // returns false on failure
+		void liveViewLoop();
+		void stopLiveViewThread();
+		void getFileFromCamera(const string & address, DownloadManager::Priority);
 		void deleteFileOnCamera(const string& address);
 
 		nlohmann::json get(const string& address) const;
 		nlohmann::json put(const string& address, const nlohmann::json&);
 		vector<string> getOptions(const string& address) const;
 
+		template<typename T>
+		struct CachedOptions {
+			std::map<T, string> optionsByValue;
+			bool valid = false;
+		};
+
+		template<typename T>
+		string findClosestOption(CachedOptions<T>&, const string& name, T value, T (RemoteDevice::*convertFromDevice)(string) const) const;
+		template<typename T>
+		void updateOptions(CachedOptions<T>&, const vector<string>& optionStrings, T (RemoteDevice::*convertFromDevice)(string) const) const;
+		void updateCurrentValue(const string& name, const string& value);
+		bool putSetting(const string& name, const string& value); // skipped if the camera already has this value
+
 		string hostname;
 
 		DeviceInfo deviceInfo;
-		ofURLFileLoader urlLoader;
+		mutable HttpClient httpClient; // commands and settings, keeps the connection to the camera open between requests
+		HttpClient pollClient; // long poll for events, so commands never wait behind a poll
+		HttpClient liveViewClient; // live view stream
 
-		ofThreadChannel<ofBuffer> incomingImages;
 		bool frameIsNew = false;
+		ofPixels pixels; // recycled with the decodePool
 		ofImage image;
 
 		bool keepFilesOnDevice = false;
@@ -96,19 +169,51 @@ namespace ofxCanon {
 
 		bool waitingForPhoto = false;
 
+		std::atomic<bool> liveViewEnabled{ false };
+		bool liveViewIsNew = false;
+		ofPixels liveViewPixels; // recycled with the liveViewDecodePool
+		ofTexture liveViewTexture;
+
+		// Ability lists of iso, av and tv, fetched on first use and refreshed from poll events
+		mutable CachedOptions<int> ISOOptions;
+		mutable CachedOptions<float> apertureOptions;
+		mutable CachedOptions<float> shutterSpeedOptions;
+		std::map<string, string> currentValues; // last value the camera reported for each setting
+		mutable std::mutex optionsMutex;
+
 		struct Thread {
-			std::thread thread;
+			std::thread thread; // performs commands from the actionQueue
+			std::thread pollThread;
+			std::thread liveViewThread;
 			ofThreadChannel<function<void()>> actionQueue;
 			ofThreadChannel<function<void()>> mainThreadActionQueue;
 			enum class State {
 				Closed,
 				Running,
 				Joining
-			} state = State::Closed;
+			};
+			std::atomic<State> state{ State::Closed };
+
+			std::mutex backoffMutex;
+			std::condition_variable backoffInterrupted;
 		} thread;
 
+		mutable Stats stats;
+		uint64_t pollRequestsInWindow = 0;
+		std::chrono::high_resolution_clock::time_point pollWindowStart;
+		uint64_t liveViewFramesInWindow = 0;
+		uint64_t liveViewBytesInWindow = 0;
+		std::chrono::high_resolution_clock::time_point liveViewWindowStart;
+		mutable std::mutex statsMutex;
+
 		struct Exception {
 			std::string message;
 		};
+
+		DecodePool decodePool{ 1 }; // only the newest photo matters, so one thread is enough
+		DecodePool liveViewDecodePool{ 1 };
+
+		// Declared last so it's destroyed first (its workers call back into the members above)
+		DownloadManager downloadManager{ 2 };
 	};
 }
\ No newline at end of file
@@ -0,0 +1,331 @@
+#include "Rig.h"
+
+#ifdef TARGET_WIN32
+	#include "combaseapi.h"
+#endif
+
+using namespace std;
+
+// When nothing else is happening, each camera thread wakes at least this often
+#define RIG_CAMERA_THREAD_IDLE_TIMEOUT chrono::milliseconds(100)
+
+namespace ofxCanon {
+#pragma mark PendingCapture
+	//----------
+	Rig::PendingCapture::PendingCapture(uint64_t captureIndex, size_t cameraCount, Clock::time_point triggerDeadline, Clock::time_point captureDeadline)
+	: remaining(cameraCount)
+	, triggerDeadline(triggerDeadline)
+	, captureDeadline(captureDeadline) {
+		this->result.captureIndex = captureIndex;
+		this->result.cameraResults.resize(cameraCount);
+		for (size_t i = 0; i < cameraCount; i++) {
+			this->result.cameraResults[i].cameraIndex = i;
+		}
+	}
+
+	//----------
+	void Rig::PendingCapture::arriveAndWait() {
+		unique_lock<mutex> lock(this->pendingMutex);
+		this->arrived++;
+
+		if (this->released) {
+			// We're late, fire straight away
+			return;
+		}
+
+		if (this->arrived >= this->result.cameraResults.size()) {
+			// Last to arrive, release everybody
+			this->released = true;
+			this->releaseTime = Clock::now();
+			lock.unlock();
+			this->releasedChanged.notify_all();
+			return;
+		}
+
+		if (!this->releasedChanged.wait_until(lock, this->triggerDeadline, [this]() { return this->released; })) {
+			// Some cameras are still busy, don't wait for them any longer
+			this->released = true;
+			this->releaseTime = Clock::now();
+			this->result.triggerTimedOut = true;
+			lock.unlock();
+			this->releasedChanged.notify_all();
+		}
+	}
+
+	//----------
+	Rig::Clock::time_point Rig::PendingCapture::getReleaseTime() const {
+		unique_lock<mutex> lock(this->pendingMutex);
+		return this->releaseTime;
+	}
+
+	//----------
+	Rig::Clock::time_point Rig::PendingCapture::getCaptureDeadline() const {
+		return this->captureDeadline;
+	}
+
+	//----------
+	void Rig::PendingCapture::report(CameraResult && cameraResult) {
+		unique_lock<mutex> lock(this->pendingMutex);
+		if (cameraResult.captureResult) {
+			this->result.successCount++;
+		}
+		this->result.cameraResults[cameraResult.cameraIndex] = move(cameraResult);
+
+		if (--this->remaining > 0) {
+			return;
+		}
+
+		// Everybody has reported
+		{
+			auto minTriggerDelay = chrono::microseconds::max();
+			auto maxTriggerDelay = chrono::microseconds::min();
+			for (const auto & result : this->result.cameraResults) {
+				// Skipped cameras have no trigger delay
+				if (!result.commandSent) {
+					continue;
+				}
+				minTriggerDelay = min(minTriggerDelay, result.triggerDelay);
+				maxTriggerDelay = max(maxTriggerDelay, result.triggerDelay);
+			}
+			this->result.triggerSpread = minTriggerDelay <= maxTriggerDelay
+				? maxTriggerDelay - minTriggerDelay
+				: chrono::microseconds(0);
+			this->result.totalTime = chrono::duration_cast<chrono::microseconds>(Clock::now() - this->releaseTime);
+		}
+		this->promise.set_value(this->result);
+	}
+
+	//----------
+	future<Rig::CaptureResult> Rig::PendingCapture::getFuture() {
+		return this->promise.get_future();
+	}
+
+#pragma mark Rig
+	//----------
+	Rig::~Rig() {
+		this->close();
+	}
+
+	//----------
+	bool Rig::setup(size_t maxCameraCount) {
+		this->close();
+
+		// Must happen in the main thread (initializes the SDK)
+		auto devices = listDevices();
+		if (maxCameraCount > 0 && devices.size() > maxCameraCount) {
+			devices.resize(maxCameraCount);
+		}
+
+		// Open all the cameras in parallel, each in its own thread
+		vector<shared_ptr<Camera>> cameras;
+		vector<promise<bool>> openedPromises(devices.size());
+		for (size_t i = 0; i < devices.size(); i++) {
+			auto camera = make_shared<Camera>();
+			camera->device = devices[i];
+			auto & openedPromise = openedPromises[i];
+			camera->thread = thread([this, camera, &openedPromise]() {
+				this->cameraThreadLoop(camera, openedPromise);
+			});
+			cameras.push_back(camera);
+		}
+
+		for (size_t i = 0; i < cameras.size(); i++) {
+			auto & camera = cameras[i];
+			if (openedPromises[i].get_future().get()) {
+				camera->index = this->cameras.size();
+				this->cameras.push_back(camera);
+			}
+			else {
+				ofLogError("ofxCanon::Rig") << "Failed to open camera " << i << ", continuing without it";
+				camera->thread.join();
+			}
+		}
+
+		return !this->cameras.empty();
+	}
+
+	//----------
+	void Rig::close() {
+		for (auto & camera : this->cameras) {
+			camera->closeThread = true;
+			camera->device->interruptWaitForActions();
+		}
+		for (auto & camera : this->cameras) {
+			if (camera->thread.joinable()) {
+				camera->thread.join();
+			}
+		}
+		this->cameras.clear();
+	}
+
+	//----------
+	size_t Rig::getCameraCount() const {
+		return this->cameras.size();
+	}
+
+	//----------
+	shared_ptr<Device> Rig::getDevice(size_t cameraIndex) const {
+		if (cameraIndex >= this->cameras.size()) {
+			return nullptr;
+		}
+		return this->cameras[cameraIndex]->device;
+	}
+
+	//----------
+	void Rig::setTriggerTimeout(chrono::milliseconds triggerTimeout) {
+		this->triggerTimeout = triggerTimeout;
+	}
+
+	//----------
+	chrono::milliseconds Rig::getTriggerTimeout() const {
+		return this->triggerTimeout;
+	}
+
+	//----------
+	void Rig::setCaptureTimeout(chrono::milliseconds captureTimeout) {
+		this->captureTimeout = captureTimeout;
+	}
+
+	//----------
+	chrono::milliseconds Rig::getCaptureTimeout() const {
+		return this->captureTimeout;
+	}
+
+	//----------
+	future<Rig::CaptureResult> Rig::capture() {
+		auto now = Clock::now();
+		auto pendingCapture = make_shared<PendingCapture>(this->nextCaptureIndex++
+			, this->cameras.size()
+			, now + this->triggerTimeout
+			, now + this->captureTimeout);
+		auto future = pendingCapture->getFuture();
+
+		if (this->cameras.empty()) {
+			ofLogError("ofxCanon::Rig") << "Cannot capture, no cameras are open";
+			CaptureResult emptyResult;
+			promise<CaptureResult> promiseWeCantKeep;
+			promiseWeCantKeep.set_value(emptyResult);
+			return promiseWeCantKeep.get_future();
+		}
+
+		// Queue the trigger ahead of anything else waiting in each camera thread
+		for (auto & camera : this->cameras) {
+			auto cameraPointer = camera.get();
+			camera->device->performInCameraThread([this, cameraPointer, pendingCapture]() {
+				this->trigger(*cameraPointer, pendingCapture);
+			}, Device::HighPriority);
+		}
+
+		return future;
+	}
+
+	//----------
+	void Rig::cameraThreadLoop(shared_ptr<Camera> camera, promise<bool> & openedPromise) {
+#if defined(TARGET_WIN32)
+		CoInitializeEx(NULL, 0x0); // COINIT_APARTMENTTHREADED in SDK docs
+#endif
+
+		auto & device = camera->device;
+		bool opened = device->open();
+		openedPromise.set_value(opened);
+
+		if (opened) {
+			while (!camera->closeThread) {
+				device->update();
+
+				auto timeout = chrono::duration_cast<Clock::duration>(RIG_CAMERA_THREAD_IDLE_TIMEOUT);
+
+				if (camera->futurePhoto.valid()) {
+					// The photo is downloaded by an action in this thread, so no need to wait on the future
+					if (camera->futurePhoto.wait_for(chrono::seconds(0)) == future_status::ready) {
+						this->finishCapture(*camera, camera->futurePhoto.get());
+					}
+					else {
+						auto now = Clock::now();
+						auto captureDeadline = camera->pendingCapture->getCaptureDeadline();
+						if (now >= captureDeadline) {
+							ofLogError("ofxCanon::Rig") << "Camera " << camera->index << " timed out waiting for photo";
+							device->cancelCapturesInFlight(); // so the camera can take part in the next capture
+							this->finishCapture(*camera, Device::PhotoCaptureResult());
+						}
+						else {
+							timeout = min(timeout, captureDeadline - now);
+						}
+					}
+				}
+
+				device->waitForActions(chrono::duration_cast<chrono::microseconds>(timeout));
+			}
+
+			// Don't leave the rig capture waiting for us
+			if (camera->pendingCapture) {
+				Device::PhotoCaptureResult cancelledResult;
+				cancelledResult.errorReturned = EDS_ERR_OPERATION_CANCELLED;
+				this->finishCapture(*camera, cancelledResult);
+			}
+
+			device->close();
+		}
+
+#if defined(TARGET_WIN32)
+		CoUninitialize();
+#endif
+	}
+
+	//----------
+	void Rig::trigger(Camera & camera, shared_ptr<PendingCapture> pendingCapture) {
+		CameraResult cameraResult;
+		cameraResult.cameraIndex = camera.index;
+
+		if (camera.pendingCapture) {
+			// Still waiting for the photo from the previous rig capture
+			pendingCapture->arriveAndWait();
+			cameraResult.captureResult.errorReturned = EDS_ERR_DEVICE_BUSY;
+			pendingCapture->report(move(cameraResult));
+			return;
+		}
+
+		// Wait for the other cameras, then fire together
+		pendingCapture->arriveAndWait();
+
+		auto commandStart = Clock::now();
+		camera.futurePhoto = camera.device->takePhotoAsync();
+		auto commandEnd = Clock::now();
+
+		cameraResult.triggerDelay = chrono::duration_cast<chrono::microseconds>(commandStart - pendingCapture->getReleaseTime());
+		cameraResult.commandDuration = chrono::duration_cast<chrono::microseconds>(commandEnd - commandStart);
+
+		if (camera.futurePhoto.wait_for(chrono::seconds(0)) == future_status::ready) {
+			auto captureResult = camera.futurePhoto.get();
+			camera.futurePhoto = future<Device::PhotoCaptureResult>();
+			if (captureResult.errorReturned != EDS_ERR_OK) {
+				// The shutter was never pressed (e.g. the device was busy or the command failed), so report it now
+				cameraResult.captureResult = captureResult;
+				pendingCapture->report(move(cameraResult));
+				return;
+			}
+
+			cameraResult.commandSent = true;
+			camera.pendingCapture = pendingCapture;
+			camera.cameraResult = move(cameraResult);
+			this->finishCapture(camera, captureResult);
+			return;
+		}
+
+		cameraResult.commandSent = true;
+		camera.pendingCapture = pendingCapture;
+		camera.cameraResult = move(cameraResult);
+	}
+
+	//----------
+	void Rig::finishCapture(Camera & camera, const Device::PhotoCaptureResult & captureResult) {
+		auto pendingCapture = camera.pendingCapture;
+		camera.pendingCapture.reset();
+		camera.futurePhoto = future<Device::PhotoCaptureResult>();
+
+		auto & cameraResult = camera.cameraResult;
+		cameraResult.captureResult = captureResult;
+		cameraResult.downloadLatency = chrono::duration_cast<chrono::microseconds>(Clock::now() - pendingCapture->getReleaseTime());
+		pendingCapture->report(move(cameraResult));
+	}
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "Device.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <future>
+#include <vector>
+#include <memory>
+
+namespace ofxCanon {
+	/*
+		Operates many cameras together (e.g. a photogrammetry rig).
+
+		Each Device gets its own camera thread, so a slow camera (e.g. one which is still
+		downloading its last photo) doesn't hold up the others.
+
+		capture() fires all the shutters together : the trigger is queued to every camera
+		thread, where each one waits at a barrier until all of them have arrived, and then
+		they all send the capture command at once. If a camera hasn't arrived within
+		triggerTimeout, the others are released without it (it fires when it gets there).
+
+		The photos are collected into a single CaptureResult, which also reports how long
+		each camera took from the trigger until its photo was downloaded.
+
+		To try a rig without cameras, build with OFXCANON_SIMULATOR and call e.g.
+			Simulator::Settings settings;
+			settings.cameraCount = 32;
+			Simulator::setSettings(settings);
+		before Rig::setup() (see Simulator/Simulator.h).
+	*/
+	class Rig {
+	public:
+		struct CameraResult {
+			size_t cameraIndex = 0;
+			Device::PhotoCaptureResult captureResult;
+			bool commandSent = false; // false if the camera was skipped (e.g. still busy with the previous capture) or the shutter command failed
+			std::chrono::microseconds triggerDelay{ 0 }; // from the rig trigger until this camera was sent the capture command
+			std::chrono::microseconds commandDuration{ 0 }; // time for the capture command to return
+			std::chrono::microseconds downloadLatency{ 0 }; // from the rig trigger until this camera's photo was downloaded
+		};
+
+		struct CaptureResult {
+			uint64_t captureIndex = 0;
+			std::vector<CameraResult> cameraResults; // one per camera, in camera order
+			size_t successCount = 0;
+			bool triggerTimedOut = false; // some cameras missed the barrier and fired late
+			std::chrono::microseconds triggerSpread{ 0 }; // between the first and last camera being sent the capture command (of those which were sent it)
+			std::chrono::microseconds totalTime{ 0 }; // from the rig trigger until the last camera finished
+
+			operator bool() const {
+				return !this->cameraResults.empty() && this->successCount == this->cameraResults.size();
+			}
+		};
+
+		~Rig();
+
+		// Opens all connected cameras (up to maxCameraCount if not 0), each in its own thread
+		// Returns false if no cameras could be opened
+		bool setup(size_t maxCameraCount = 0);
+		void close();
+
+		size_t getCameraCount() const;
+		std::shared_ptr<Device> getDevice(size_t cameraIndex) const;
+
+		void setTriggerTimeout(std::chrono::milliseconds); // default 100ms
+		std::chrono::milliseconds getTriggerTimeout() const;
+		void setCaptureTimeout(std::chrono::milliseconds); // default 30s, cameras which haven't returned a photo by then fail
+		std::chrono::milliseconds getCaptureTimeout() const;
+
+		// Fire all cameras. Cameras which are still busy with a previous rig capture fail with EDS_ERR_DEVICE_BUSY
+		std::future<CaptureResult> capture();
+	protected:
+		typedef std::chrono::high_resolution_clock Clock;
+
+		// Shared between the camera threads for one capture
+		class PendingCapture {
+		public:
+			PendingCapture(uint64_t captureIndex, size_t cameraCount, Clock::time_point triggerDeadline, Clock::time_point captureDeadline);
+
+			// Block until every camera has arrived (or the trigger deadline has passed)
+			void arriveAndWait();
+			Clock::time_point getReleaseTime() const;
+			Clock::time_point getCaptureDeadline() const;
+
+			void report(CameraResult &&);
+			std::future<CaptureResult> getFuture();
+		protected:
+			std::promise<CaptureResult> promise;
+			CaptureResult result;
+			size_t remaining;
+
+			size_t arrived = 0;
+			bool released = false;
+			Clock::time_point triggerDeadline;
+			Clock::time_point captureDeadline;
+			Clock::time_point releaseTime;
+
+			mutable std::mutex pendingMutex;
+			std::condition_variable releasedChanged;
+		};
+
+		struct Camera {
+			size_t index = 0;
+			std::shared_ptr<Device> device;
+			std::thread thread;
+			std::atomic<bool> closeThread{ false };
+
+			// only accessed in the camera thread
+			std::shared_ptr<PendingCapture> pendingCapture;
+			std::future<Device::PhotoCaptureResult> futurePhoto;
+			CameraResult cameraResult;
+		};
+
+		void cameraThreadLoop(std::shared_ptr<Camera>, std::promise<bool> & openedPromise);
+		void trigger(Camera &, std::shared_ptr<PendingCapture>);
+		void finishCapture(Camera &, const Device::PhotoCaptureResult &);
+
+		std::vector<std::shared_ptr<Camera>> cameras;
+		std::atomic<uint64_t> nextCaptureIndex{ 0 };
+		std::chrono::milliseconds triggerTimeout{ 100 };
+		std::chrono::milliseconds captureTimeout{ 30000 };
+	};
+}
@@ -9,6 +9,12 @@
 
 using namespace std;
 
+// When the camera has no live view frame ready yet, poll again after this long
+#define LIVE_VIEW_RETRY_INTERVAL chrono::milliseconds(2)
+
+// With nothing scheduled, the camera thread wakes at least this often
+#define CAMERA_THREAD_IDLE_TIMEOUT chrono::milliseconds(500)
+
 namespace ofxCanon {
 #pragma mark CameraThread
 	//----------
@@ -52,6 +58,26 @@ namespace ofxCanon {
 	//----------
 	void Simple::setLiveView(bool useLiveView) {
 		this->useLiveView = useLiveView;
+
+		// the camera thread may be idle, wake it to start / stop live view
+		if (this->cameraThread && this->cameraThread->device) {
+			this->cameraThread->device->interruptWaitForActions();
+		}
+	}
+
+	//----------
+	void Simple::setDecodeThreadCount(size_t decodeThreadCount) {
+		this->decodeThreadCount = decodeThreadCount;
+	}
+
+	//----------
+	void Simple::setLiveViewFrameRateTarget(float liveViewFrameRateTarget) {
+		this->liveViewFrameRateTarget = liveViewFrameRateTarget;
+	}
+
+	//----------
+	float Simple::getLiveViewFrameRateTarget() const {
+		return this->liveViewFrameRateTarget;
 	}
 
 	//----------
@@ -64,6 +90,9 @@ namespace ofxCanon {
 		ofxCanon::Initializer::X();
 
 		ofThreadChannel<bool> reportSuccess;
+
+		//photos and live view frames are decoded here, so the camera thread only transfers bytes
+		this->decodePool = make_shared<DecodePool>(this->decodeThreadCount);
 		
 		this->cameraThread = make_shared<CameraThread>();
 		this->cameraThread->thread = thread([this, &reportSuccess]() {
@@ -91,13 +120,23 @@ namespace ofxCanon {
 				ofAddListener(this->cameraThread->device->onParameterOptionsChange, this->cameraThread.get(), &CameraThread::parameterChangeCallback);
 				ofAddListener(this->cameraThread->device->onUnrequestedPhotoReceived, this, &Simple::callbackUnrequestedPhotoReceived);
 
+				typedef chrono::high_resolution_clock Clock;
+				auto & device = this->cameraThread->device;
+				auto nextLiveViewPoll = Clock::now();
+
 				while (!this->cameraThread->closeThread) {
+					auto workStart = Clock::now();
+					auto & loopStats = this->cameraThread->loopStats;
+
 					auto useLiveView = this->useLiveView;
-					this->cameraThread->device->setLiveViewEnabled(useLiveView);
+					device->setLiveViewEnabled(useLiveView);
+
+					//perform outstanding actions (incoming photos are downloaded here)
+					device->update();
 
-					//receive incoming photo
+					//receive incoming photo (the promise is fulfilled by an action in this thread, so no need to wait)
 					if (this->cameraThread->futurePhoto.valid()) {
-						if (this->cameraThread->futurePhoto.wait_for(chrono::milliseconds(1)) == future_status::ready) {
+						if (this->cameraThread->futurePhoto.wait_for(chrono::seconds(0)) == future_status::ready) {
 							//photo has been received so load it
 							auto result = this->cameraThread->futurePhoto.get();
 							this->processCaptureResult(result);
@@ -112,25 +151,62 @@ namespace ofxCanon {
 						}
 					}
 
-					//perform outstanding actions
-					this->cameraThread->device->update();
-
-					//grab live view frame
-					if (useLiveView) {
-						if (this->cameraThread->device->getLiveView(this->cameraThread->liveViewLoad)) {
-							if (this->orientationMode != 0) {
-								this->cameraThread->liveView.rotate90(this->orientationMode);
-							}
-
-							unique_lock<mutex> lock(this->cameraThread->liveViewMutex);
-							swap(this->cameraThread->liveViewLoad, this->cameraThread->liveView);
+					//grab live view frame when it's due (if the decode pool is still busy with the previous frame, that one will be dropped)
+					bool polledLiveView = false;
+					bool liveViewNotReady = false;
+					if (useLiveView && Clock::now() >= nextLiveViewPoll) {
+						auto pollTime = Clock::now();
+						auto encodedFrame = device->getLiveViewEncoded();
+						if (encodedFrame) {
+							this->decodePool->addLiveView(encodedFrame, this->orientationMode);
 							this->liveViewFramerateCounter.addFrame();
-							this->cameraThread->liveViewIsNew = true;
+
+							auto frameRateTarget = max(this->liveViewFrameRateTarget.load(), 1.0f);
+							nextLiveViewPoll = pollTime + chrono::duration_cast<Clock::duration>(chrono::duration<float>(1.0f / frameRateTarget));
+						}
+						else {
+							nextLiveViewPoll = pollTime + LIVE_VIEW_RETRY_INTERVAL;
+							liveViewNotReady = true;
 						}
+						polledLiveView = true;
+					}
+
+					//sleep until there's an action to perform, or the next live view frame is due
+					auto workEnd = Clock::now();
+					bool wokeForActions;
+					{
+						auto timeout = useLiveView
+							? max(Clock::duration::zero(), nextLiveViewPoll - workEnd)
+							: chrono::duration_cast<Clock::duration>(CAMERA_THREAD_IDLE_TIMEOUT);
+						wokeForActions = device->waitForActions(chrono::duration_cast<chrono::microseconds>(timeout));
 					}
+					auto waitEnd = Clock::now();
 
-					//from ofxEdsdk
-					ofSleepMillis(5);
+					{
+						unique_lock<mutex> lock(this->cameraThread->loopStatsMutex);
+						loopStats.iterations++;
+						if (wokeForActions) {
+							loopStats.wakeupsForActions++;
+						}
+						else if (useLiveView && waitEnd >= nextLiveViewPoll) {
+							loopStats.wakeupsForLiveView++;
+						}
+						else {
+							loopStats.wakeupsIdle++;
+						}
+						if (polledLiveView) {
+							loopStats.liveViewPolls++;
+						}
+						if (liveViewNotReady) {
+							loopStats.liveViewPollsNotReady++;
+						}
+
+						auto workTime = chrono::duration<float>(workEnd - workStart).count();
+						auto totalTime = chrono::duration<float>(waitEnd - workStart).count();
+						if (totalTime > 0.0f) {
+							loopStats.busyFraction = loopStats.busyFraction * 0.99f + (workTime / totalTime) * 0.01f;
+						}
+					}
 				}
 
 				ofRemoveListener(this->cameraThread->device->onLensChange, this->cameraThread.get(), &CameraThread::lensChangeCallback);
@@ -155,10 +231,15 @@ namespace ofxCanon {
 	void Simple::close() {
 		if (this->cameraThread) {
 			this->cameraThread->closeThread = true;
+			if (this->cameraThread->device) {
+				this->cameraThread->device->interruptWaitForActions();
+			}
 			if (this->cameraThread->thread.joinable()) {
 				this->cameraThread->thread.join();
 			}
+			this->cameraThread.reset();
 		}
+		this->decodePool.reset();
 	}
 
 	//----------
@@ -169,23 +250,39 @@ namespace ofxCanon {
 			this->photoIsNew = false;
 			this->liveViewIsNew = false;
 
+			//receive decoded photos (in the order they were captured)
+			{
+				DecodePool::DecodedPhoto decodedPhoto;
+				while (this->decodePool->receivePhoto(decodedPhoto)) {
+					if (decodedPhoto.success) {
+						swap(this->photoPixels, decodedPhoto.pixels);
+					}
+					else {
+						ofLogError("ofxCanon") << "Failed to decode photo";
+					}
+					this->photoCaptureResult = decodedPhoto.captureResult;
+					this->photoIsNew = true;
+				}
+			}
+
+			//receive photo from blocking capture
 			{
 				unique_lock<mutex> lock(this->cameraThread->photoMutex);
 				if (this->cameraThread->photoIsNew) {
 					swap(this->photoPixels, cameraThread->photo);
-					this->photoTexture.loadData(this->photoPixels);
 					this->photoIsNew = true;
 					this->cameraThread->photoIsNew = false;
 				}
 			}
 
+			if (this->photoIsNew) {
+				this->photoTexture.loadData(this->photoPixels);
+			}
+
 			if(this->useLiveView) {
-				unique_lock<mutex> lock(this->cameraThread->liveViewMutex);
-				if (this->cameraThread->liveViewIsNew) {
-					swap(this->liveViewPixels, cameraThread->liveView);
+				if (this->decodePool->receiveLiveView(this->liveViewPixels)) {
 					this->liveViewTexture.loadData(this->liveViewPixels);
 					this->liveViewIsNew = true;
-					this->cameraThread->liveViewIsNew = false;
 				}
 			}
 
@@ -376,6 +473,20 @@ namespace ofxCanon {
 		return this->cameraThread;
 	}
 
+	//----------
+	shared_ptr<DecodePool> Simple::getDecodePool() {
+		return this->decodePool;
+	}
+
+	//----------
+	Simple::LoopStats Simple::getLoopStats() const {
+		if (!this->cameraThread) {
+			return LoopStats();
+		}
+		unique_lock<mutex> lock(this->cameraThread->loopStatsMutex);
+		return this->cameraThread->loopStats;
+	}
+
 	//----------
 	void Simple::callbackUnrequestedPhotoReceived(Device::PhotoCaptureResult& photoCaptureResult) {
 		this->unrequestedPhotosIncoming.send(photoCaptureResult);
@@ -384,21 +495,8 @@ namespace ofxCanon {
 	//----------
 	void Simple::processCaptureResult(const Device::PhotoCaptureResult& photoCaptureResult) {
 		if (photoCaptureResult.errorReturned == EDS_ERR_OK) {
-			ofLoadImage(this->cameraThread->photoLoad
-				, *photoCaptureResult.encodedBuffer);
-
-			//(rotate) and swap it into the chain
-			{
-				if (this->orientationMode != 0) {
-					this->cameraThread->photoLoad.rotate90(this->orientationMode);
-				}
-
-				unique_lock<mutex> lock(this->cameraThread->photoMutex);
-				swap(this->cameraThread->photoLoad, this->cameraThread->photo);
-				this->cameraThread->photoIsNew = true;
-			}
-
-			this->photoCaptureResult = photoCaptureResult;
+			//decode (and rotate) in the decode pool, the result is received in update()
+			this->decodePool->addPhoto(photoCaptureResult, this->orientationMode);
 		}
 		else {
 			ofLogError("ofxCanon") << "Photo capture failed : " << errorToString(photoCaptureResult.errorReturned);
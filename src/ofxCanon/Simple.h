@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Device.h"
+#include "DecodePool.h"
 
 #include "ofTexture.h"
 
@@ -8,11 +9,23 @@
 #include <thread>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
 
 namespace ofxCanon {
 	//The Simple class conceals thread complexity away from the user of ofxCanon (mirrors ofxEdsdk interface).
 	class Simple {
 	public:
+		// How the camera thread spent its time (see getLoopStats)
+		struct LoopStats {
+			uint64_t iterations = 0;
+			uint64_t wakeupsForActions = 0; // woke because an action was queued
+			uint64_t wakeupsForLiveView = 0; // woke because the next live view frame was due
+			uint64_t wakeupsIdle = 0; // woke at the idle timeout or when interrupted
+			uint64_t liveViewPolls = 0;
+			uint64_t liveViewPollsNotReady = 0; // camera had no new frame when polled
+			float busyFraction = 0.0f; // smoothed fraction of time spent working rather than waiting
+		};
+
 		struct CameraThread {
 			void lensChangeCallback(Device::LensInfo& lensInfo);
 			void parameterChangeCallback(EdsPropertyID&);
@@ -21,16 +34,11 @@ namespace ofxCanon {
 			std::thread thread;
 
 
-			ofPixels photoLoad;
+			// used by blocking takePhoto (otherwise photos and live view arrive through the decode pool)
 			ofPixels photo;
 			bool photoIsNew = false;
 			std::mutex photoMutex;
 
-			ofPixels liveViewLoad;
-			ofPixels liveView;
-			bool liveViewIsNew = false;
-			std::mutex liveViewMutex;
-
 			std::future<Device::PhotoCaptureResult> futurePhoto;
 
 			bool lensIsNew = false;
@@ -40,7 +48,8 @@ namespace ofxCanon {
 
 			bool closeThread = false;
 
-			std::queue<std::function<void()>> actionQueue;
+			LoopStats loopStats;
+			std::mutex loopStatsMutex;
 		};
 
 		//We directly mirror the interface of ofxEdsdk as of August 31st 2016, changes:
@@ -57,6 +66,9 @@ namespace ofxCanon {
 		void setOrientationMode(int orientationMode);
 		void setLiveView(bool useLiveView);
 		bool getLiveViewEnabled();
+		void setDecodeThreadCount(size_t); // call before setup
+		void setLiveViewFrameRateTarget(float); // the camera thread polls for live view at this rate (default 30)
+		float getLiveViewFrameRateTarget() const;
 
 		bool setup();
 		void close();
@@ -95,14 +107,19 @@ namespace ofxCanon {
 		bool isShutterSpeedNew() const;
 
 		std::shared_ptr<CameraThread> getCameraThread();
+		std::shared_ptr<DecodePool> getDecodePool(); // e.g. for getStats()
+		LoopStats getLoopStats() const;
 	protected:
 		void callbackUnrequestedPhotoReceived(Device::PhotoCaptureResult&);
 		void processCaptureResult(const Device::PhotoCaptureResult&);
 		int deviceId = 0;
 		int orientationMode = 0;
 		bool useLiveView = true;
+		size_t decodeThreadCount = 2;
+		std::atomic<float> liveViewFrameRateTarget{ 30.0f };
 
 		std::shared_ptr<CameraThread> cameraThread;
+		std::shared_ptr<DecodePool> decodePool;
 		ofThreadChannel<Device::PhotoCaptureResult> unrequestedPhotosIncoming;
 
 		ofPixels photoPixels;
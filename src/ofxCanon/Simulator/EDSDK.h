@@ -0,0 +1,445 @@
+#pragma once
+
+/*
+	Simulated EDSDK.
+
+	This header stands in for Canon's EDSDK.h when OFXCANON_SIMULATOR is defined (see EDSDK_include.h).
+	It declares the subset of the EDSDK API which ofxCanon uses, with the same names and values,
+	and is implemented in Simulator.cpp without any camera or Canon libraries.
+
+	Use ofxCanon::Simulator::setSettings(..) (Simulator.h) to set up sample files, latencies and failures.
+*/
+
+#include <stdint.h>
+
+#define EDSCALLBACK
+#define EDSAPI
+
+#define EDS_MAX_NAME 256
+
+#pragma mark Types
+typedef int EdsBool;
+typedef char EdsChar;
+typedef int8_t EdsInt8;
+typedef uint8_t EdsUInt8;
+typedef int16_t EdsInt16;
+typedef uint16_t EdsUInt16;
+typedef int32_t EdsInt32;
+typedef uint32_t EdsUInt32;
+typedef int64_t EdsInt64;
+typedef uint64_t EdsUInt64;
+typedef float EdsFloat;
+typedef double EdsDouble;
+typedef void EdsVoid;
+typedef EdsUInt32 EdsError;
+
+typedef struct __EdsObject * EdsBaseRef;
+typedef EdsBaseRef EdsCameraListRef;
+typedef EdsBaseRef EdsCameraRef;
+typedef EdsBaseRef EdsVolumeRef;
+typedef EdsBaseRef EdsDirectoryItemRef;
+typedef EdsBaseRef EdsStreamRef;
+typedef EdsBaseRef EdsImageRef;
+typedef EdsBaseRef EdsEvfImageRef;
+
+typedef EdsUInt32 EdsPropertyID;
+typedef EdsUInt32 EdsCameraCommand;
+typedef EdsUInt32 EdsCameraStatusCommand;
+typedef EdsUInt32 EdsPropertyEvent;
+typedef EdsUInt32 EdsObjectEvent;
+typedef EdsUInt32 EdsStateEvent;
+
+typedef enum {
+	kEdsDataType_Unknown = 0,
+	kEdsDataType_Bool = 1,
+	kEdsDataType_String = 2,
+	kEdsDataType_Int8 = 3,
+	kEdsDataType_UInt8 = 6,
+	kEdsDataType_Int16 = 4,
+	kEdsDataType_UInt16 = 7,
+	kEdsDataType_Int32 = 8,
+	kEdsDataType_UInt32 = 9,
+	kEdsDataType_Int64 = 10,
+	kEdsDataType_UInt64 = 11,
+	kEdsDataType_Float = 12,
+	kEdsDataType_Double = 13,
+	kEdsDataType_ByteBlock = 14,
+	kEdsDataType_Rational = 20,
+	kEdsDataType_Rational_Array = 37
+} EdsDataType;
+
+typedef enum {
+	kEdsSeek_Cur = 0,
+	kEdsSeek_Begin,
+	kEdsSeek_End
+} EdsSeekOrigin;
+
+typedef enum {
+	kEdsFileCreateDisposition_CreateNew = 0,
+	kEdsFileCreateDisposition_CreateAlways,
+	kEdsFileCreateDisposition_OpenExisting,
+	kEdsFileCreateDisposition_OpenAlways,
+	kEdsFileCreateDisposition_TruncateExsisting
+} EdsFileCreateDisposition;
+
+typedef enum {
+	kEdsAccess_Read = 0,
+	kEdsAccess_Write,
+	kEdsAccess_ReadWrite,
+	kEdsAccess_Error = 0xFFFFFFFF
+} EdsAccess;
+
+typedef enum {
+	kEdsSaveTo_Camera = 1,
+	kEdsSaveTo_Host = 2,
+	kEdsSaveTo_Both = kEdsSaveTo_Camera | kEdsSaveTo_Host
+} EdsSaveTo;
+
+typedef enum {
+	kEdsEvfOutputDevice_TFT = 1,
+	kEdsEvfOutputDevice_PC = 2
+} EdsEvfOutputDevice;
+
+typedef struct {
+	EdsInt32 form;
+	EdsInt32 access;
+	EdsInt32 numElements;
+	EdsInt32 propDesc[128];
+} EdsPropertyDesc;
+
+typedef struct {
+	EdsChar szPortName[EDS_MAX_NAME];
+	EdsChar szDeviceDescription[EDS_MAX_NAME];
+	EdsUInt32 deviceSubType;
+	EdsUInt32 reserved;
+} EdsDeviceInfo;
+
+typedef struct {
+	EdsUInt64 size;
+	EdsBool isFolder;
+	EdsUInt32 groupID;
+	EdsUInt32 option;
+	EdsChar szFileName[EDS_MAX_NAME];
+	EdsUInt32 format;
+	EdsUInt32 dateTime;
+} EdsDirectoryItemInfo;
+
+typedef struct {
+	EdsInt32 numberOfFreeClusters;
+	EdsInt32 bytesPerSector;
+	EdsBool reset;
+} EdsCapacity;
+
+typedef struct {
+	EdsInt32 numerator;
+	EdsUInt32 denominator;
+} EdsRational;
+
+typedef EdsError (EDSCALLBACK *EdsPropertyEventHandler)(EdsPropertyEvent inEvent, EdsPropertyID inPropertyID, EdsUInt32 inParam, EdsVoid * inContext);
+typedef EdsError (EDSCALLBACK *EdsObjectEventHandler)(EdsObjectEvent inEvent, EdsBaseRef inRef, EdsVoid * inContext);
+typedef EdsError (EDSCALLBACK *EdsStateEventHandler)(EdsStateEvent inEvent, EdsUInt32 inEventData, EdsVoid * inContext);
+
+#pragma mark Property IDs
+#define kEdsPropID_Unknown 0x0000ffff
+#define kEdsPropID_ProductName 0x00000002
+#define kEdsPropID_OwnerName 0x00000004
+#define kEdsPropID_MakerName 0x00000005
+#define kEdsPropID_DateTime 0x00000006
+#define kEdsPropID_FirmwareVersion 0x00000007
+#define kEdsPropID_BatteryLevel 0x00000008
+#define kEdsPropID_SaveTo 0x0000000b
+#define kEdsPropID_CurrentStorage 0x0000000c
+#define kEdsPropID_CurrentFolder 0x0000000d
+#define kEdsPropID_BatteryQuality 0x00000010
+#define kEdsPropID_BodyIDEx 0x00000015
+#define kEdsPropID_HDDirectoryStructure 0x00000020
+#define kEdsPropID_TempStatus 0x01000415
+#define kEdsPropID_ImageQuality 0x00000100
+#define kEdsPropID_Orientation 0x00000102
+#define kEdsPropID_ICCProfile 0x00000103
+#define kEdsPropID_FocusInfo 0x00000104
+#define kEdsPropID_WhiteBalance 0x00000106
+#define kEdsPropID_ColorTemperature 0x00000107
+#define kEdsPropID_WhiteBalanceShift 0x00000108
+#define kEdsPropID_ColorSpace 0x0000010d
+#define kEdsPropID_PictureStyle 0x00000114
+#define kEdsPropID_PictureStyleDesc 0x00000115
+#define kEdsPropID_PictureStyleCaption 0x00000200
+#define kEdsPropID_GPSVersionID 0x00000800
+#define kEdsPropID_GPSLatitudeRef 0x00000801
+#define kEdsPropID_GPSLatitude 0x00000802
+#define kEdsPropID_GPSLongitudeRef 0x00000803
+#define kEdsPropID_GPSLongitude 0x00000804
+#define kEdsPropID_GPSAltitudeRef 0x00000805
+#define kEdsPropID_GPSAltitude 0x00000806
+#define kEdsPropID_GPSTimeStamp 0x00000807
+#define kEdsPropID_GPSSatellites 0x00000808
+#define kEdsPropID_GPSStatus 0x00000809
+#define kEdsPropID_GPSMapDatum 0x00000812
+#define kEdsPropID_GPSDateStamp 0x0000081d
+#define kEdsPropID_AEMode 0x00000400
+#define kEdsPropID_DriveMode 0x00000401
+#define kEdsPropID_ISOSpeed 0x00000402
+#define kEdsPropID_MeteringMode 0x00000403
+#define kEdsPropID_AFMode 0x00000404
+#define kEdsPropID_Av 0x00000405
+#define kEdsPropID_Tv 0x00000406
+#define kEdsPropID_ExposureCompensation 0x00000407
+#define kEdsPropID_FocalLength 0x00000409
+#define kEdsPropID_AvailableShots 0x0000040a
+#define kEdsPropID_Bracket 0x0000040b
+#define kEdsPropID_WhiteBalanceBracket 0x0000040c
+#define kEdsPropID_LensName 0x0000040d
+#define kEdsPropID_AEBracket 0x0000040e
+#define kEdsPropID_FEBracket 0x0000040f
+#define kEdsPropID_ISOBracket 0x00000410
+#define kEdsPropID_NoiseReduction 0x00000411
+#define kEdsPropID_FlashOn 0x00000412
+#define kEdsPropID_RedEye 0x00000413
+#define kEdsPropID_FlashMode 0x00000414
+#define kEdsPropID_LensStatus 0x00000416
+#define kEdsPropID_Artist 0x00000418
+#define kEdsPropID_Copyright 0x00000419
+#define kEdsPropID_AEModeSelect 0x00000436
+#define kEdsPropID_PowerZoom_Speed 0x00000444
+#define kEdsPropID_Evf_OutputDevice 0x00000500
+#define kEdsPropID_Evf_Mode 0x00000501
+#define kEdsPropID_Evf_WhiteBalance 0x00000502
+#define kEdsPropID_Evf_ColorTemperature 0x00000503
+#define kEdsPropID_Evf_DepthOfFieldPreview 0x00000504
+#define kEdsPropID_Evf_Zoom 0x00000507
+#define kEdsPropID_Evf_ZoomPosition 0x00000508
+#define kEdsPropID_Evf_Histogram 0x0000050a
+#define kEdsPropID_Evf_ImagePosition 0x0000050b
+#define kEdsPropID_Evf_HistogramStatus 0x0000050c
+#define kEdsPropID_Evf_AFMode 0x0000050e
+#define kEdsPropID_Record 0x00000510
+#define kEdsPropID_Evf_HistogramY 0x00000515
+#define kEdsPropID_Evf_HistogramR 0x00000516
+#define kEdsPropID_Evf_HistogramG 0x00000517
+#define kEdsPropID_Evf_HistogramB 0x00000518
+#define kEdsPropID_Evf_CoordinateSystem 0x00000540
+#define kEdsPropID_Evf_ZoomRect 0x00000541
+#define kEdsPropID_Evf_ImageClipRect 0x00000545
+#define kEdsPropID_Evf_PowerZoom_CurPosition 0x00000550
+#define kEdsPropID_Evf_PowerZoom_MaxPosition 0x00000551
+#define kEdsPropID_Evf_PowerZoom_MinPosition 0x00000552
+
+#pragma mark Camera commands
+#define kEdsCameraCommand_TakePicture 0x00000000
+#define kEdsCameraCommand_ExtendShutDownTimer 0x00000001
+#define kEdsCameraCommand_BulbStart 0x00000002
+#define kEdsCameraCommand_BulbEnd 0x00000003
+#define kEdsCameraCommand_PressShutterButton 0x00000004
+#define kEdsCameraCommand_DoEvfAf 0x00000102
+#define kEdsCameraCommand_DriveLensEvf 0x00000103
+#define kEdsCameraCommand_DoClickWBEvf 0x00000104
+#define kEdsCameraCommand_DrivePowerZoom 0x0000010d
+#define kEdsCameraCommand_SetRemoteShootingMode 0x0000010f
+
+#define kEdsCameraCommand_ShutterButton_OFF 0x00000000
+#define kEdsCameraCommand_ShutterButton_Halfway 0x00000001
+#define kEdsCameraCommand_ShutterButton_Completely 0x00000003
+#define kEdsCameraCommand_ShutterButton_Halfway_NonAF 0x00010001
+#define kEdsCameraCommand_ShutterButton_Completely_NonAF 0x00010003
+
+#define kEdsCameraStatusCommand_UILock 0x00000000
+#define kEdsCameraStatusCommand_UIUnLock 0x00000001
+
+#pragma mark Events
+#define kEdsPropertyEvent_All 0x00000100
+#define kEdsPropertyEvent_PropertyChanged 0x00000101
+#define kEdsPropertyEvent_PropertyDescChanged 0x00000102
+
+#define kEdsObjectEvent_All 0x00000200
+#define kEdsObjectEvent_DirItemCreated 0x00000204
+#define kEdsObjectEvent_DirItemRemoved 0x00000205
+#define kEdsObjectEvent_DirItemRequestTransfer 0x00000208
+
+#define kEdsStateEvent_All 0x00000300
+#define kEdsStateEvent_Shutdown 0x00000301
+#define kEdsStateEvent_WillSoonShutDown 0x00000303
+#define kEdsStateEvent_CaptureError 0x00000305
+
+#pragma mark Errors
+#define EDS_ERR_OK 0x00000000L
+#define EDS_ERR_UNIMPLEMENTED 0x00000001L
+#define EDS_ERR_INTERNAL_ERROR 0x00000002L
+#define EDS_ERR_MEM_ALLOC_FAILED 0x00000003L
+#define EDS_ERR_MEM_FREE_FAILED 0x00000004L
+#define EDS_ERR_OPERATION_CANCELLED 0x00000005L
+#define EDS_ERR_INCOMPATIBLE_VERSION 0x00000006L
+#define EDS_ERR_NOT_SUPPORTED 0x00000007L
+#define EDS_ERR_UNEXPECTED_EXCEPTION 0x00000008L
+#define EDS_ERR_PROTECTION_VIOLATION 0x00000009L
+#define EDS_ERR_MISSING_SUBCOMPONENT 0x0000000aL
+#define EDS_ERR_SELECTION_UNAVAILABLE 0x0000000bL
+#define EDS_ERR_FILE_IO_ERROR 0x00000020L
+#define EDS_ERR_FILE_TOO_MANY_OPEN 0x00000021L
+#define EDS_ERR_FILE_NOT_FOUND 0x00000022L
+#define EDS_ERR_FILE_OPEN_ERROR 0x00000023L
+#define EDS_ERR_FILE_CLOSE_ERROR 0x00000024L
+#define EDS_ERR_FILE_SEEK_ERROR 0x00000025L
+#define EDS_ERR_FILE_TELL_ERROR 0x00000026L
+#define EDS_ERR_FILE_READ_ERROR 0x00000027L
+#define EDS_ERR_FILE_WRITE_ERROR 0x00000028L
+#define EDS_ERR_FILE_PERMISSION_ERROR 0x00000029L
+#define EDS_ERR_FILE_DISK_FULL_ERROR 0x0000002aL
+#define EDS_ERR_FILE_ALREADY_EXISTS 0x0000002bL
+#define EDS_ERR_FILE_FORMAT_UNRECOGNIZED 0x0000002cL
+#define EDS_ERR_FILE_DATA_CORRUPT 0x0000002dL
+#define EDS_ERR_FILE_NAMING_NA 0x0000002eL
+#define EDS_ERR_DIR_NOT_FOUND 0x00000040L
+#define EDS_ERR_DIR_IO_ERROR 0x00000041L
+#define EDS_ERR_DIR_ENTRY_NOT_FOUND 0x00000042L
+#define EDS_ERR_DIR_ENTRY_EXISTS 0x00000043L
+#define EDS_ERR_DIR_NOT_EMPTY 0x00000044L
+#define EDS_ERR_PROPERTIES_UNAVAILABLE 0x00000050L
+#define EDS_ERR_PROPERTIES_MISMATCH 0x00000051L
+#define EDS_ERR_PROPERTIES_NOT_LOADED 0x00000053L
+#define EDS_ERR_INVALID_PARAMETER 0x00000060L
+#define EDS_ERR_INVALID_HANDLE 0x00000061L
+#define EDS_ERR_INVALID_POINTER 0x00000062L
+#define EDS_ERR_INVALID_INDEX 0x00000063L
+#define EDS_ERR_INVALID_LENGTH 0x00000064L
+#define EDS_ERR_INVALID_FN_POINTER 0x00000065L
+#define EDS_ERR_INVALID_SORT_FN 0x00000066L
+#define EDS_ERR_DEVICE_NOT_FOUND 0x00000080L
+#define EDS_ERR_DEVICE_BUSY 0x00000081L
+#define EDS_ERR_DEVICE_INVALID 0x00000082L
+#define EDS_ERR_DEVICE_EMERGENCY 0x00000083L
+#define EDS_ERR_DEVICE_MEMORY_FULL 0x00000084L
+#define EDS_ERR_DEVICE_INTERNAL_ERROR 0x00000085L
+#define EDS_ERR_DEVICE_INVALID_PARAMETER 0x00000086L
+#define EDS_ERR_DEVICE_NO_DISK 0x00000087L
+#define EDS_ERR_DEVICE_DISK_ERROR 0x00000088L
+#define EDS_ERR_DEVICE_CF_GATE_CHANGED 0x00000089L
+#define EDS_ERR_DEVICE_DIAL_CHANGED 0x0000008aL
+#define EDS_ERR_DEVICE_NOT_INSTALLED 0x0000008bL
+#define EDS_ERR_DEVICE_STAY_AWAKE 0x0000008cL
+#define EDS_ERR_DEVICE_NOT_RELEASED 0x0000008dL
+#define EDS_ERR_STREAM_IO_ERROR 0x000000a0L
+#define EDS_ERR_STREAM_NOT_OPEN 0x000000a1L
+#define EDS_ERR_STREAM_ALREADY_OPEN 0x000000a2L
+#define EDS_ERR_STREAM_OPEN_ERROR 0x000000a3L
+#define EDS_ERR_STREAM_CLOSE_ERROR 0x000000a4L
+#define EDS_ERR_STREAM_SEEK_ERROR 0x000000a5L
+#define EDS_ERR_STREAM_TELL_ERROR 0x000000a6L
+#define EDS_ERR_STREAM_READ_ERROR 0x000000a7L
+#define EDS_ERR_STREAM_WRITE_ERROR 0x000000a8L
+#define EDS_ERR_STREAM_PERMISSION_ERROR 0x000000a9L
+#define EDS_ERR_STREAM_COULDNT_BEGIN_THREAD 0x000000aaL
+#define EDS_ERR_STREAM_BAD_OPTIONS 0x000000abL
+#define EDS_ERR_STREAM_END_OF_STREAM 0x000000acL
+#define EDS_ERR_COMM_PORT_IS_IN_USE 0x000000c0L
+#define EDS_ERR_COMM_DISCONNECTED 0x000000c1L
+#define EDS_ERR_COMM_DEVICE_INCOMPATIBLE 0x000000c2L
+#define EDS_ERR_COMM_BUFFER_FULL 0x000000c3L
+#define EDS_ERR_COMM_USB_BUS_ERR 0x000000c4L
+#define EDS_ERR_USB_DEVICE_LOCK_ERROR 0x000000d0L
+#define EDS_ERR_USB_DEVICE_UNLOCK_ERROR 0x000000d1L
+#define EDS_ERR_STI_UNKNOWN_ERROR 0x000000e0L
+#define EDS_ERR_STI_INTERNAL_ERROR 0x000000e1L
+#define EDS_ERR_STI_DEVICE_CREATE_ERROR 0x000000e2L
+#define EDS_ERR_STI_DEVICE_RELEASE_ERROR 0x000000e3L
+#define EDS_ERR_DEVICE_NOT_LAUNCHED 0x000000e4L
+#define EDS_ERR_ENUM_NA 0x000000f0L
+#define EDS_ERR_INVALID_FN_CALL 0x000000f1L
+#define EDS_ERR_HANDLE_NOT_FOUND 0x000000f2L
+#define EDS_ERR_INVALID_ID 0x000000f3L
+#define EDS_ERR_WAIT_TIMEOUT_ERROR 0x000000f4L
+#define EDS_ERR_SESSION_NOT_OPEN 0x00002003L
+#define EDS_ERR_INVALID_TRANSACTIONID 0x00002004L
+#define EDS_ERR_INCOMPLETE_TRANSFER 0x00002007L
+#define EDS_ERR_INVALID_STRAGEID 0x00002008L
+#define EDS_ERR_DEVICEPROP_NOT_SUPPORTED 0x0000200aL
+#define EDS_ERR_INVALID_OBJECTFORMATCODE 0x0000200bL
+#define EDS_ERR_SELF_TEST_FAILED 0x00002011L
+#define EDS_ERR_PARTIAL_DELETION 0x00002012L
+#define EDS_ERR_SPECIFICATION_BY_FORMAT_UNSUPPORTED 0x00002014L
+#define EDS_ERR_NO_VALID_OBJECTINFO 0x00002015L
+#define EDS_ERR_INVALID_CODE_FORMAT 0x00002016L
+#define EDS_ERR_UNKNOWN_VENDOR_CODE 0x00002017L
+#define EDS_ERR_CAPTURE_ALREADY_TERMINATED 0x00002018L
+#define EDS_ERR_PTP_DEVICE_BUSY 0x00002019L
+#define EDS_ERR_INVALID_PARENTOBJECT 0x0000201aL
+#define EDS_ERR_INVALID_DEVICEPROP_FORMAT 0x0000201bL
+#define EDS_ERR_INVALID_DEVICEPROP_VALUE 0x0000201cL
+#define EDS_ERR_SESSION_ALREADY_OPEN 0x0000201eL
+#define EDS_ERR_TRANSACTION_CANCELLED 0x0000201fL
+#define EDS_ERR_SPECIFICATION_OF_DESTINATION_UNSUPPORTED 0x00002020L
+#define EDS_ERR_NOT_CAMERA_SUPPORT_SDK_VERSION 0x00002021L
+#define EDS_ERR_UNKNOWN_COMMAND 0x0000a001L
+#define EDS_ERR_OPERATION_REFUSED 0x0000a005L
+#define EDS_ERR_LENS_COVER_CLOSE 0x0000a006L
+#define EDS_ERR_LOW_BATTERY 0x0000a101L
+#define EDS_ERR_OBJECT_NOTREADY 0x0000a102L
+#define EDS_ERR_CANNOT_MAKE_OBJECT 0x0000a104L
+#define EDS_ERR_MEMORYSTATUS_NOTREADY 0x0000a106L
+#define EDS_ERR_TAKE_PICTURE_AF_NG 0x00008d01L
+#define EDS_ERR_TAKE_PICTURE_RESERVED 0x00008d02L
+#define EDS_ERR_TAKE_PICTURE_MIRROR_UP_NG 0x00008d03L
+#define EDS_ERR_TAKE_PICTURE_SENSOR_CLEANING_NG 0x00008d04L
+#define EDS_ERR_TAKE_PICTURE_SILENCE_NG 0x00008d05L
+#define EDS_ERR_TAKE_PICTURE_NO_CARD_NG 0x00008d06L
+#define EDS_ERR_TAKE_PICTURE_CARD_NG 0x00008d07L
+#define EDS_ERR_TAKE_PICTURE_CARD_PROTECT_NG 0x00008d08L
+#define EDS_ERR_TAKE_PICTURE_MOVIE_CROP_NG 0x00008d09L
+#define EDS_ERR_TAKE_PICTURE_STROBO_CHARGE_NG 0x00008d0aL
+#define EDS_ERR_TAKE_PICTURE_NO_LENS_NG 0x00008d0bL
+#define EDS_ERR_TAKE_PICTURE_SPECIAL_MOVIE_MODE_NG 0x00008d0cL
+#define EDS_ERR_TAKE_PICTURE_LV_REL_PROHIBIT_MODE_NG 0x00008d0dL
+
+#pragma mark Functions
+#ifdef __cplusplus
+extern "C" {
+#endif
+	EdsError EDSAPI EdsInitializeSDK();
+	EdsError EDSAPI EdsTerminateSDK();
+	EdsError EDSAPI EdsGetEvent();
+
+	EdsUInt32 EDSAPI EdsRetain(EdsBaseRef inRef);
+	EdsUInt32 EDSAPI EdsRelease(EdsBaseRef inRef);
+
+	EdsError EDSAPI EdsGetChildCount(EdsBaseRef inRef, EdsUInt32 * outCount);
+	EdsError EDSAPI EdsGetChildAtIndex(EdsBaseRef inRef, EdsInt32 inIndex, EdsBaseRef * outRef);
+
+	EdsError EDSAPI EdsGetPropertySize(EdsBaseRef inRef, EdsPropertyID inPropertyID, EdsInt32 inParam, EdsDataType * outDataType, EdsUInt32 * outSize);
+	EdsError EDSAPI EdsGetPropertyData(EdsBaseRef inRef, EdsPropertyID inPropertyID, EdsInt32 inParam, EdsUInt32 inPropertySize, EdsVoid * outPropertyData);
+	EdsError EDSAPI EdsSetPropertyData(EdsBaseRef inRef, EdsPropertyID inPropertyID, EdsInt32 inParam, EdsUInt32 inPropertySize, const EdsVoid * inPropertyData);
+	EdsError EDSAPI EdsGetPropertyDesc(EdsBaseRef inRef, EdsPropertyID inPropertyID, EdsPropertyDesc * outPropertyDesc);
+
+	EdsError EDSAPI EdsGetCameraList(EdsCameraListRef * outCameraListRef);
+	EdsError EDSAPI EdsGetDeviceInfo(EdsCameraRef inCameraRef, EdsDeviceInfo * outDeviceInfo);
+	EdsError EDSAPI EdsOpenSession(EdsCameraRef inCameraRef);
+	EdsError EDSAPI EdsCloseSession(EdsCameraRef inCameraRef);
+	EdsError EDSAPI EdsSendCommand(EdsCameraRef inCameraRef, EdsCameraCommand inCommand, EdsInt32 inParam);
+	EdsError EDSAPI EdsSendStatusCommand(EdsCameraRef inCameraRef, EdsCameraStatusCommand inStatusCommand, EdsInt32 inParam);
+	EdsError EDSAPI EdsSetCapacity(EdsCameraRef inCameraRef, EdsCapacity inCapacity);
+
+	EdsError EDSAPI EdsGetDirectoryItemInfo(EdsDirectoryItemRef inDirItemRef, EdsDirectoryItemInfo * outDirItemInfo);
+	EdsError EDSAPI EdsDeleteDirectoryItem(EdsDirectoryItemRef inDirItemRef);
+	EdsError EDSAPI EdsDownload(EdsDirectoryItemRef inDirItemRef, EdsUInt64 inReadSize, EdsStreamRef outStream);
+	EdsError EDSAPI EdsDownloadCancel(EdsDirectoryItemRef inDirItemRef);
+	EdsError EDSAPI EdsDownloadComplete(EdsDirectoryItemRef inDirItemRef);
+
+	EdsError EDSAPI EdsCreateFileStream(const EdsChar * inFileName, EdsFileCreateDisposition inCreateDisposition, EdsAccess inDesiredAccess, EdsStreamRef * outStream);
+	EdsError EDSAPI EdsCreateMemoryStream(EdsUInt64 inBufferSize, EdsStreamRef * outStream);
+	EdsError EDSAPI EdsCreateMemoryStreamFromPointer(EdsVoid * inUserBuffer, EdsUInt64 inBufferSize, EdsStreamRef * outStream);
+	EdsError EDSAPI EdsGetPointer(EdsStreamRef inStream, EdsVoid ** outPointer);
+	EdsError EDSAPI EdsRead(EdsStreamRef inStreamRef, EdsUInt64 inReadSize, EdsVoid * outBuffer, EdsUInt64 * outReadSize);
+	EdsError EDSAPI EdsWrite(EdsStreamRef inStreamRef, EdsUInt64 inWriteSize, const EdsVoid * inBuffer, EdsUInt64 * outWrittenSize);
+	EdsError EDSAPI EdsSeek(EdsStreamRef inStreamRef, EdsInt64 inSeekOffset, EdsSeekOrigin inSeekOrigin);
+	EdsError EDSAPI EdsGetPosition(EdsStreamRef inStreamRef, EdsUInt64 * outPosition);
+	EdsError EDSAPI EdsGetLength(EdsStreamRef inStreamRef, EdsUInt64 * outLength);
+
+	EdsError EDSAPI EdsCreateImageRef(EdsStreamRef inStreamRef, EdsImageRef * outImageRef);
+	EdsError EDSAPI EdsCreateEvfImageRef(EdsStreamRef inStreamRef, EdsEvfImageRef * outEvfImageRef);
+	EdsError EDSAPI EdsDownloadEvfImage(EdsCameraRef inCameraRef, EdsEvfImageRef inEvfImageRef);
+
+	EdsError EDSAPI EdsSetPropertyEventHandler(EdsCameraRef inCameraRef, EdsPropertyEvent inEvnet, EdsPropertyEventHandler inPropertyEventHandler, EdsVoid * inContext);
+	EdsError EDSAPI EdsSetObjectEventHandler(EdsCameraRef inCameraRef, EdsObjectEvent inEvnet, EdsObjectEventHandler inObjectEventHandler, EdsVoid * inContext);
+	EdsError EDSAPI EdsSetCameraStateEventHandler(EdsCameraRef inCameraRef, EdsStateEvent inEvnet, EdsStateEventHandler inStateEventHandler, EdsVoid * inContext);
+#ifdef __cplusplus
+}
+#endif
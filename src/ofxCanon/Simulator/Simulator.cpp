@@ -0,0 +1,1496 @@
+#include "Simulator.h"
+
+#ifdef OFXCANON_SIMULATOR
+
+#include "ofFileUtils.h"
+#include "ofLog.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// The EDSDK's opaque object type. All refs handed out by the simulator derive from this.
+struct __EdsObject {
+	virtual ~__EdsObject() {}
+	atomic<EdsUInt32> referenceCount{ 1 };
+};
+
+namespace ofxCanon {
+	namespace Simulator {
+		typedef chrono::high_resolution_clock Clock;
+
+#pragma mark Objects
+		struct SampleFile {
+			string name;
+			shared_ptr<vector<char>> data;
+		};
+
+		//----------
+		class Stream : public __EdsObject {
+		public:
+			virtual EdsError write(const char * data, EdsUInt64 size, EdsUInt64 & written) = 0;
+			virtual EdsError read(char * data, EdsUInt64 size, EdsUInt64 & read) = 0;
+			virtual EdsError seek(EdsInt64 offset, EdsSeekOrigin origin) = 0;
+			virtual EdsUInt64 getPosition() const = 0;
+			virtual EdsUInt64 getLength() const = 0;
+			virtual char * getPointer() {
+				return nullptr;
+			}
+
+			// Set when a JPEG has been downloaded into the stream (used by EdsCreateImageRef)
+			bool containsJpeg = false;
+		};
+
+		//----------
+		class MemoryStream : public Stream {
+		public:
+			// Growable stream (EdsCreateMemoryStream)
+			MemoryStream(EdsUInt64 size)
+			: owned((size_t) size)
+			, length(size) {
+
+			}
+
+			// Fixed size stream over the user's memory (EdsCreateMemoryStreamFromPointer)
+			MemoryStream(char * external, EdsUInt64 capacity)
+			: external(external)
+			, capacity(capacity)
+			, length(capacity) {
+
+			}
+
+			EdsError write(const char * data, EdsUInt64 size, EdsUInt64 & written) override {
+				written = size;
+				if (this->external) {
+					if (this->position + size > this->capacity) {
+						written = this->capacity - this->position;
+					}
+				}
+				else if (this->position + size > this->owned.size()) {
+					this->owned.resize((size_t) (this->position + size));
+				}
+
+				memcpy(this->getPointer() + this->position, data, (size_t) written);
+				this->position += written;
+				this->length = max(this->length, this->position);
+
+				return written == size ? EDS_ERR_OK : EDS_ERR_STREAM_END_OF_STREAM;
+			}
+
+			EdsError read(char * data, EdsUInt64 size, EdsUInt64 & read) override {
+				read = min(size, this->length - this->position);
+				memcpy(data, this->getPointer() + this->position, (size_t) read);
+				this->position += read;
+				return EDS_ERR_OK;
+			}
+
+			EdsError seek(EdsInt64 offset, EdsSeekOrigin origin) override {
+				EdsInt64 newPosition = offset;
+				if (origin == kEdsSeek_Cur) {
+					newPosition += this->position;
+				}
+				else if (origin == kEdsSeek_End) {
+					newPosition += this->length;
+				}
+				if (newPosition < 0 || (this->external && (EdsUInt64) newPosition > this->capacity)) {
+					return EDS_ERR_STREAM_SEEK_ERROR;
+				}
+				this->position = (EdsUInt64) newPosition;
+				return EDS_ERR_OK;
+			}
+
+			EdsUInt64 getPosition() const override {
+				return this->position;
+			}
+
+			EdsUInt64 getLength() const override {
+				return this->length;
+			}
+
+			char * getPointer() override {
+				return this->external ? this->external : this->owned.data();
+			}
+		protected:
+			vector<char> owned;
+			char * external = nullptr;
+			EdsUInt64 capacity = 0;
+			EdsUInt64 position = 0;
+			EdsUInt64 length = 0;
+		};
+
+		//----------
+		class FileStream : public Stream {
+		public:
+			EdsError open(const string & path, EdsFileCreateDisposition disposition, EdsAccess access) {
+				bool exists = ifstream(path).good();
+
+				switch (disposition) {
+				case kEdsFileCreateDisposition_CreateNew:
+					if (exists) {
+						return EDS_ERR_FILE_ALREADY_EXISTS;
+					}
+					break;
+				case kEdsFileCreateDisposition_OpenExisting:
+				case kEdsFileCreateDisposition_TruncateExsisting:
+					if (!exists) {
+						return EDS_ERR_FILE_NOT_FOUND;
+					}
+					break;
+				default:
+					break;
+				}
+
+				bool truncate = !exists
+					|| disposition == kEdsFileCreateDisposition_CreateAlways
+					|| disposition == kEdsFileCreateDisposition_CreateNew
+					|| disposition == kEdsFileCreateDisposition_TruncateExsisting;
+
+				ios::openmode mode = ios::binary | ios::in;
+				if (access != kEdsAccess_Read) {
+					mode |= ios::out;
+				}
+				if (truncate) {
+					mode |= ios::out | ios::trunc;
+				}
+
+				this->file.open(path, mode);
+				if (!this->file.is_open()) {
+					return EDS_ERR_FILE_OPEN_ERROR;
+				}
+
+				this->file.seekg(0, ios::end);
+				this->length = (EdsUInt64) this->file.tellg();
+				this->file.seekg(0, ios::beg);
+				return EDS_ERR_OK;
+			}
+
+			EdsError write(const char * data, EdsUInt64 size, EdsUInt64 & written) override {
+				this->file.seekp((streamoff) this->position);
+				this->file.write(data, (streamsize) size);
+				if (!this->file.good()) {
+					written = 0;
+					return EDS_ERR_FILE_WRITE_ERROR;
+				}
+				written = size;
+				this->position += size;
+				this->length = max(this->length, this->position);
+				return EDS_ERR_OK;
+			}
+
+			EdsError read(char * data, EdsUInt64 size, EdsUInt64 & read) override {
+				this->file.seekg((streamoff) this->position);
+				this->file.read(data, (streamsize) size);
+				read = (EdsUInt64) this->file.gcount();
+				this->file.clear();
+				this->position += read;
+				return EDS_ERR_OK;
+			}
+
+			EdsError seek(EdsInt64 offset, EdsSeekOrigin origin) override {
+				EdsInt64 newPosition = offset;
+				if (origin == kEdsSeek_Cur) {
+					newPosition += this->position;
+				}
+				else if (origin == kEdsSeek_End) {
+					newPosition += this->length;
+				}
+				if (newPosition < 0) {
+					return EDS_ERR_FILE_SEEK_ERROR;
+				}
+				this->position = (EdsUInt64) newPosition;
+				return EDS_ERR_OK;
+			}
+
+			EdsUInt64 getPosition() const override {
+				return this->position;
+			}
+
+			EdsUInt64 getLength() const override {
+				return this->length;
+			}
+		protected:
+			fstream file;
+			EdsUInt64 position = 0;
+			EdsUInt64 length = 0;
+		};
+
+		//----------
+		class Camera : public __EdsObject {
+		public:
+			int index = 0;
+			bool sessionOpen = false;
+			bool disconnected = false;
+			bool shutterHeld = false;
+
+			map<EdsPropertyID, EdsUInt32> values;
+			map<EdsPropertyID, string> strings;
+			map<EdsPropertyID, vector<EdsInt32>> descriptions;
+
+			EdsPropertyEvent propertyEventType = 0;
+			EdsPropertyEventHandler propertyEventHandler = nullptr;
+			EdsVoid * propertyEventContext = nullptr;
+
+			EdsObjectEvent objectEventType = 0;
+			EdsObjectEventHandler objectEventHandler = nullptr;
+			EdsVoid * objectEventContext = nullptr;
+
+			EdsStateEvent stateEventType = 0;
+			EdsStateEventHandler stateEventHandler = nullptr;
+			EdsVoid * stateEventContext = nullptr;
+
+			size_t nextSampleIndex = 0;
+			size_t nextLiveViewIndex = 0;
+			int fileNumber = 1;
+			Clock::time_point lastLiveViewFrame;
+		};
+
+		//----------
+		class CameraList : public __EdsObject {
+		public:
+			~CameraList() {
+				for (auto camera : this->cameras) {
+					EdsRelease(camera);
+				}
+			}
+			vector<Camera*> cameras;
+		};
+
+		//----------
+		class DirectoryItem : public __EdsObject {
+		public:
+			~DirectoryItem() {
+				EdsRelease(this->camera);
+			}
+			Camera * camera = nullptr;
+			SampleFile file;
+			EdsUInt64 readPosition = 0;
+			bool cancelled = false;
+		};
+
+		//----------
+		class ImageRef : public __EdsObject {
+		public:
+			EdsRational focalLength[3] = { { 50, 1 }, { 24, 1 }, { 105, 1 } }; // current, minimum, maximum
+		};
+
+		//----------
+		class EvfImage : public __EdsObject {
+		public:
+			~EvfImage() {
+				EdsRelease(this->stream);
+			}
+			Stream * stream = nullptr;
+		};
+
+#pragma mark State
+		//----------
+		struct State {
+			Settings settings;
+			Stats stats;
+
+			bool initialized = false;
+			vector<Camera*> cameras;
+
+			vector<string> samplePaths;
+			vector<string> liveViewPaths;
+			map<string, shared_ptr<vector<char>>> fileCache;
+			shared_ptr<vector<char>> photoTestPattern; // shared by all captures when there are no sample files
+
+			// Events are functions which run in the 'event context' (the dispatch thread or EdsGetEvent)
+			multimap<Clock::time_point, function<void()>> scheduledEvents;
+			deque<function<void()>> readyEvents;
+			thread dispatchThread;
+			bool closeDispatchThread = false;
+			condition_variable eventsChanged;
+
+			mt19937 random;
+
+			mutex stateMutex;
+		};
+
+		//----------
+		State & getState() {
+			static State state;
+			return state;
+		}
+
+		//----------
+		// call whilst holding the lock
+		bool injectFailure(State & state, float rate) {
+			if (rate <= 0.0f) {
+				return false;
+			}
+			uniform_real_distribution<float> distribution(0.0f, 1.0f);
+			if (distribution(state.random) < rate) {
+				state.stats.failuresInjected++;
+				return true;
+			}
+			return false;
+		}
+
+		//----------
+		void simulateLatency(Clock::duration duration) {
+			if (duration > Clock::duration::zero()) {
+				this_thread::sleep_for(duration);
+			}
+		}
+
+		//----------
+		// call whilst holding the lock
+		void scheduleEvent(State & state, Clock::duration delay, function<void()> && event) {
+			state.scheduledEvents.emplace(Clock::now() + delay, move(event));
+			state.eventsChanged.notify_all();
+		}
+
+		//----------
+		void dispatchThreadLoop() {
+			auto & state = getState();
+			unique_lock<mutex> lock(state.stateMutex);
+			while (!state.closeDispatchThread) {
+				if (state.scheduledEvents.empty()) {
+					state.eventsChanged.wait(lock);
+					continue;
+				}
+
+				auto next = state.scheduledEvents.begin();
+				if (next->first > Clock::now()) {
+					state.eventsChanged.wait_until(lock, next->first);
+					continue;
+				}
+
+				auto event = move(next->second);
+				state.scheduledEvents.erase(next);
+
+				if (state.settings.dispatchEventsInThread) {
+					lock.unlock();
+					event();
+					lock.lock();
+					state.stats.eventsDispatched++;
+				}
+				else {
+					state.readyEvents.push_back(move(event));
+				}
+			}
+		}
+
+		//----------
+		shared_ptr<vector<char>> makeTestPattern(int width, int height, int frameIndex) {
+			// 24bit BMP (which FreeImage can decode like the JPEGs from a real camera)
+			auto rowBytes = (width * 3 + 3) & ~3;
+			auto dataSize = rowBytes * height;
+			auto fileSize = 14 + 40 + dataSize;
+
+			auto file = make_shared<vector<char>>(fileSize, 0);
+			auto data = (uint8_t *) file->data();
+
+			auto put16 = [](uint8_t * at, uint16_t value) {
+				at[0] = value & 0xff;
+				at[1] = (value >> 8) & 0xff;
+			};
+			auto put32 = [](uint8_t * at, uint32_t value) {
+				for (int i = 0; i < 4; i++) {
+					at[i] = (value >> (i * 8)) & 0xff;
+				}
+			};
+
+			data[0] = 'B';
+			data[1] = 'M';
+			put32(data + 2, fileSize);
+			put32(data + 10, 14 + 40);
+			put32(data + 14, 40);
+			put32(data + 18, width);
+			put32(data + 22, height);
+			put16(data + 26, 1);
+			put16(data + 28, 24);
+			put32(data + 34, dataSize);
+
+			// gradient with a bar which moves each frame
+			auto pixels = data + 14 + 40;
+			auto barX = (frameIndex * 8) % width;
+			for (int y = 0; y < height; y++) {
+				auto row = pixels + y * rowBytes;
+				for (int x = 0; x < width; x++) {
+					auto pixel = row + x * 3;
+					bool bar = x >= barX && x < barX + 16;
+					pixel[0] = bar ? 255 : (uint8_t) (y * 255 / height);
+					pixel[1] = bar ? 255 : (uint8_t) ((x + y) * 255 / (width + height));
+					pixel[2] = bar ? 255 : (uint8_t) (x * 255 / width);
+				}
+			}
+
+			return file;
+		}
+
+		//----------
+		// call whilst holding the lock
+		shared_ptr<vector<char>> loadFile(State & state, const string & path) {
+			auto findFile = state.fileCache.find(path);
+			if (findFile != state.fileCache.end()) {
+				return findFile->second;
+			}
+
+			auto buffer = ofBufferFromFile(path, true);
+			auto file = make_shared<vector<char>>(buffer.getData(), buffer.getData() + buffer.size());
+			state.fileCache[path] = file;
+			return file;
+		}
+
+		//----------
+		vector<string> listFiles(const string & folder, const vector<string> & extensions) {
+			vector<string> paths;
+			if (folder.empty()) {
+				return paths;
+			}
+
+			ofDirectory directory(folder);
+			for (const auto & extension : extensions) {
+				directory.allowExt(extension);
+			}
+			directory.listDir();
+			directory.sort();
+			for (size_t i = 0; i < directory.size(); i++) {
+				paths.push_back(directory.getPath(i));
+			}
+			return paths;
+		}
+
+		//----------
+		// call whilst holding the lock
+		Camera * makeCamera(int index) {
+			auto camera = new Camera();
+			camera->index = index;
+
+			camera->values = {
+				{ kEdsPropID_SaveTo, kEdsSaveTo_Camera },
+				{ kEdsPropID_ISOSpeed, 0x58 }, // 400
+				{ kEdsPropID_Av, 0x30 }, // f/5.6
+				{ kEdsPropID_Tv, 0x60 }, // 1/30
+				{ kEdsPropID_AEMode, 0x03 }, // manual
+				{ kEdsPropID_DriveMode, 0x00 }, // single shot
+				{ kEdsPropID_AvailableShots, 999 },
+				{ kEdsPropID_LensStatus, 1 },
+				{ kEdsPropID_BatteryLevel, 0xffffffff }, // AC power
+				{ kEdsPropID_BatteryQuality, 3 },
+				{ kEdsPropID_Evf_Mode, 0 },
+				{ kEdsPropID_Evf_OutputDevice, kEdsEvfOutputDevice_TFT }
+			};
+
+			camera->strings = {
+				{ kEdsPropID_ProductName, "Canon EOS Simulator" },
+				{ kEdsPropID_BodyIDEx, "SIM" + ofToString(index, 9, '0') },
+				{ kEdsPropID_FirmwareVersion, "1.0.0" },
+				{ kEdsPropID_LensName, "EF24-105mm f/4L IS USM" },
+				{ kEdsPropID_MakerName, "Canon" },
+				{ kEdsPropID_OwnerName, "" },
+				{ kEdsPropID_Artist, "" },
+				{ kEdsPropID_Copyright, "" }
+			};
+
+			camera->descriptions = {
+				{ kEdsPropID_ISOSpeed, {
+					0x00, 0x48, 0x4b, 0x4d, 0x50, 0x53, 0x55, 0x58, 0x5b, 0x5d, 0x60,
+					0x63, 0x65, 0x68, 0x6b, 0x6d, 0x70, 0x73, 0x75, 0x78, 0x7b, 0x7d, 0x80
+				} },
+				{ kEdsPropID_Av, {
+					0x28, 0x2B, 0x2D, 0x30, 0x33, 0x35, 0x38, 0x3B,
+					0x3D, 0x40, 0x43, 0x45, 0x48, 0x4B, 0x4D, 0x50
+				} },
+				{ kEdsPropID_Tv, {
+					0x0C, 0x10, 0x13, 0x15, 0x18, 0x1B, 0x1D, 0x20, 0x23, 0x25, 0x28, 0x2B, 0x2D,
+					0x30, 0x33, 0x35, 0x38, 0x3B, 0x3D, 0x40, 0x43, 0x45, 0x48, 0x4B, 0x4D,
+					0x53, 0x55, 0x5D, 0x60, 0x63, 0x65, 0x68, 0x6B, 0x6D, 0x70, 0x73, 0x75,
+					0x78, 0x7B, 0x7D, 0x80, 0x83, 0x85, 0x88, 0x8B, 0x8D, 0x90, 0x93, 0x95, 0x98
+				} }
+			};
+
+			return camera;
+		}
+
+		//----------
+		// call whilst holding the lock
+		void rebuildCameras(State & state) {
+			for (auto camera : state.cameras) {
+				camera->disconnected = true;
+				EdsRelease(camera);
+			}
+			state.cameras.clear();
+
+			for (int i = 0; i < state.settings.cameraCount; i++) {
+				state.cameras.push_back(makeCamera(i));
+			}
+
+			state.samplePaths = listFiles(state.settings.sampleFolder, { "jpg", "jpeg", "cr2", "cr3", "tif", "bmp" });
+			state.liveViewPaths = listFiles(state.settings.liveViewFolder.empty()
+				? state.settings.sampleFolder
+				: state.settings.liveViewFolder, { "jpg", "jpeg" });
+			state.fileCache.clear();
+			state.photoTestPattern.reset();
+		}
+
+		//----------
+		Camera * getCamera(State & state, int cameraIndex) {
+			if (cameraIndex < 0 || cameraIndex >= (int) state.cameras.size()) {
+				ofLogError("ofxCanon::Simulator") << "Camera index " << cameraIndex << " does not exist";
+				return nullptr;
+			}
+			return state.cameras[cameraIndex];
+		}
+
+#pragma mark Events
+		//----------
+		// call whilst holding the lock
+		void schedulePropertyEvent(State & state, Camera * camera, EdsPropertyEvent eventType, EdsPropertyID propertyID) {
+			EdsRetain(camera);
+			scheduleEvent(state, state.settings.eventLatency, [&state, camera, eventType, propertyID]() {
+				EdsPropertyEventHandler handler = nullptr;
+				EdsVoid * context = nullptr;
+				{
+					unique_lock<mutex> lock(state.stateMutex);
+					if (camera->propertyEventType == kEdsPropertyEvent_All || camera->propertyEventType == eventType) {
+						handler = camera->propertyEventHandler;
+						context = camera->propertyEventContext;
+					}
+				}
+				if (handler) {
+					handler(eventType, propertyID, 0, context);
+				}
+				EdsRelease(camera);
+			});
+		}
+
+		//----------
+		// call whilst holding the lock
+		void scheduleStateEvent(State & state, Camera * camera, EdsStateEvent eventType, EdsUInt32 parameter) {
+			EdsRetain(camera);
+			scheduleEvent(state, state.settings.eventLatency, [&state, camera, eventType, parameter]() {
+				EdsStateEventHandler handler = nullptr;
+				EdsVoid * context = nullptr;
+				{
+					unique_lock<mutex> lock(state.stateMutex);
+					if (camera->stateEventType == kEdsStateEvent_All || camera->stateEventType == eventType) {
+						handler = camera->stateEventHandler;
+						context = camera->stateEventContext;
+					}
+				}
+				if (handler) {
+					handler(eventType, parameter, context);
+				}
+				EdsRelease(camera);
+			});
+		}
+
+		//----------
+		// Runs in the event context
+		void completeCapture(State & state, Camera * camera) {
+			DirectoryItem * directoryItem = nullptr;
+			EdsObjectEvent eventType = kEdsObjectEvent_DirItemRequestTransfer;
+			EdsObjectEventHandler handler = nullptr;
+			EdsVoid * context = nullptr;
+			{
+				unique_lock<mutex> lock(state.stateMutex);
+				if (camera->disconnected) {
+					return;
+				}
+
+				if (injectFailure(state, state.settings.captureFailureRate)) {
+					scheduleStateEvent(state, camera, kEdsStateEvent_CaptureError, 0);
+					return;
+				}
+
+				directoryItem = new DirectoryItem();
+				directoryItem->camera = camera;
+				EdsRetain(camera);
+
+				if (state.samplePaths.empty()) {
+					directoryItem->file.name = "IMG_" + ofToString(camera->fileNumber, 4, '0') + ".BMP";
+					if (!state.photoTestPattern) {
+						state.photoTestPattern = makeTestPattern(1920, 1280, 0);
+					}
+					directoryItem->file.data = state.photoTestPattern;
+				}
+				else {
+					const auto & path = state.samplePaths[camera->nextSampleIndex++ % state.samplePaths.size()];
+					auto extension = ofToUpper(ofFilePath::getFileExt(path));
+					directoryItem->file.name = "IMG_" + ofToString(camera->fileNumber, 4, '0') + "." + extension;
+					directoryItem->file.data = loadFile(state, path);
+				}
+				camera->fileNumber = camera->fileNumber % 9999 + 1;
+
+				// Photos saved to the card are announced as created, photos for the host request a transfer
+				eventType = camera->values[kEdsPropID_SaveTo] & kEdsSaveTo_Host
+					? kEdsObjectEvent_DirItemRequestTransfer
+					: kEdsObjectEvent_DirItemCreated;
+
+				if (camera->objectEventType == kEdsObjectEvent_All || camera->objectEventType == eventType) {
+					handler = camera->objectEventHandler;
+					context = camera->objectEventContext;
+				}
+
+				state.stats.capturesCompleted++;
+			}
+
+			if (handler) {
+				// As with the EDSDK, the handler receives the reference
+				handler(eventType, directoryItem, context);
+			}
+			else {
+				EdsRelease(directoryItem);
+			}
+		}
+
+		//----------
+		// call whilst holding the lock
+		void scheduleCapture(State & state, Camera * camera, Clock::duration delay) {
+			EdsRetain(camera);
+			scheduleEvent(state, delay, [&state, camera]() {
+				completeCapture(state, camera);
+				EdsRelease(camera);
+			});
+		}
+
+		//----------
+		// call whilst holding the lock
+		void scheduleBurstCapture(State & state, Camera * camera, Clock::duration delay) {
+			EdsRetain(camera);
+			scheduleEvent(state, delay, [&state, camera]() {
+				bool continueBurst;
+				{
+					unique_lock<mutex> lock(state.stateMutex);
+					continueBurst = camera->shutterHeld && !camera->disconnected;
+				}
+				if (continueBurst) {
+					completeCapture(state, camera);
+
+					unique_lock<mutex> lock(state.stateMutex);
+					scheduleBurstCapture(state, camera, state.settings.burstInterval);
+				}
+				EdsRelease(camera);
+			});
+		}
+
+#pragma mark Public
+		//----------
+		void setSettings(const Settings & settings) {
+			auto & state = getState();
+			unique_lock<mutex> lock(state.stateMutex);
+			state.settings = settings;
+			state.random.seed(settings.randomSeed);
+			rebuildCameras(state);
+		}
+
+		//----------
+		Settings getSettings() {
+			auto & state = getState();
+			unique_lock<mutex> lock(state.stateMutex);
+			return state.settings;
+		}
+
+		//----------
+		Stats getStats() {
+			auto & state = getState();
+			unique_lock<mutex> lock(state.stateMutex);
+			return state.stats;
+		}
+
+		//----------
+		void pressShutter(int cameraIndex) {
+			auto & state = getState();
+			unique_lock<mutex> lock(state.stateMutex);
+			auto camera = getCamera(state, cameraIndex);
+			if (camera) {
+				scheduleCapture(state, camera, state.settings.captureLatency);
+			}
+		}
+
+		//----------
+		void changeProperty(int cameraIndex, EdsPropertyID propertyID, EdsUInt32 value) {
+			auto & state = getState();
+			unique_lock<mutex> lock(state.stateMutex);
+			auto camera = getCamera(state, cameraIndex);
+			if (camera) {
+				camera->values[propertyID] = value;
+				schedulePropertyEvent(state, camera, kEdsPropertyEvent_PropertyChanged, propertyID);
+			}
+		}
+
+		//----------
+		void sendStateEvent(int cameraIndex, EdsStateEvent eventType, EdsUInt32 parameter) {
+			auto & state = getState();
+			unique_lock<mutex> lock(state.stateMutex);
+			auto camera = getCamera(state, cameraIndex);
+			if (camera) {
+				scheduleStateEvent(state, camera, eventType, parameter);
+			}
+		}
+
+		//----------
+		void disconnect(int cameraIndex) {
+			auto & state = getState();
+			unique_lock<mutex> lock(state.stateMutex);
+			auto camera = getCamera(state, cameraIndex);
+			if (camera) {
+				camera->disconnected = true;
+				scheduleStateEvent(state, camera, kEdsStateEvent_Shutdown, 0);
+			}
+		}
+	}
+}
+
+using namespace ofxCanon::Simulator;
+
+#pragma mark EDSDK API
+//----------
+EdsError EDSAPI EdsInitializeSDK() {
+	auto & state = getState();
+	unique_lock<mutex> lock(state.stateMutex);
+	if (state.initialized) {
+		return EDS_ERR_OK;
+	}
+
+	if (state.cameras.empty()) {
+		rebuildCameras(state);
+	}
+
+	state.closeDispatchThread = false;
+	state.dispatchThread = thread(dispatchThreadLoop);
+	state.initialized = true;
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsTerminateSDK() {
+	auto & state = getState();
+	{
+		unique_lock<mutex> lock(state.stateMutex);
+		if (!state.initialized) {
+			return EDS_ERR_OK;
+		}
+		state.closeDispatchThread = true;
+		state.initialized = false;
+	}
+	state.eventsChanged.notify_all();
+
+	if (state.dispatchThread.joinable()) {
+		state.dispatchThread.join();
+	}
+
+	unique_lock<mutex> lock(state.stateMutex);
+	state.scheduledEvents.clear();
+	state.readyEvents.clear();
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsGetEvent() {
+	auto & state = getState();
+	while (true) {
+		function<void()> event;
+		{
+			unique_lock<mutex> lock(state.stateMutex);
+			if (state.readyEvents.empty()) {
+				break;
+			}
+			event = move(state.readyEvents.front());
+			state.readyEvents.pop_front();
+			state.stats.eventsDispatched++;
+		}
+		event();
+	}
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsUInt32 EDSAPI EdsRetain(EdsBaseRef ref) {
+	if (!ref) {
+		return 0xFFFFFFFF;
+	}
+	return ++ref->referenceCount;
+}
+
+//----------
+EdsUInt32 EDSAPI EdsRelease(EdsBaseRef ref) {
+	if (!ref) {
+		return 0xFFFFFFFF;
+	}
+	auto count = --ref->referenceCount;
+	if (count == 0) {
+		delete ref;
+	}
+	return count;
+}
+
+//----------
+EdsError EDSAPI EdsGetChildCount(EdsBaseRef ref, EdsUInt32 * count) {
+	auto cameraList = dynamic_cast<CameraList*>(ref);
+	if (!cameraList || !count) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	*count = (EdsUInt32) cameraList->cameras.size();
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsGetChildAtIndex(EdsBaseRef ref, EdsInt32 index, EdsBaseRef * child) {
+	auto cameraList = dynamic_cast<CameraList*>(ref);
+	if (!cameraList || !child) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if (index < 0 || index >= (EdsInt32) cameraList->cameras.size()) {
+		return EDS_ERR_INVALID_INDEX;
+	}
+	*child = cameraList->cameras[index];
+	EdsRetain(*child);
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsGetPropertySize(EdsBaseRef ref, EdsPropertyID propertyID, EdsInt32, EdsDataType * dataType, EdsUInt32 * size) {
+	if (dynamic_cast<ImageRef*>(ref) && propertyID == kEdsPropID_FocalLength) {
+		*dataType = kEdsDataType_Rational_Array;
+		*size = sizeof(EdsRational) * 3;
+		return EDS_ERR_OK;
+	}
+
+	auto camera = dynamic_cast<Camera*>(ref);
+	if (!camera) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	auto & state = getState();
+	unique_lock<mutex> lock(state.stateMutex);
+	auto findString = camera->strings.find(propertyID);
+	if (findString != camera->strings.end()) {
+		*dataType = kEdsDataType_String;
+		*size = (EdsUInt32) findString->second.size() + 1;
+		return EDS_ERR_OK;
+	}
+	if (camera->values.count(propertyID)) {
+		*dataType = kEdsDataType_UInt32;
+		*size = sizeof(EdsUInt32);
+		return EDS_ERR_OK;
+	}
+	return EDS_ERR_PROPERTIES_UNAVAILABLE;
+}
+
+//----------
+EdsError EDSAPI EdsGetPropertyData(EdsBaseRef ref, EdsPropertyID propertyID, EdsInt32, EdsUInt32 size, EdsVoid * data) {
+	if (!data) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	auto imageRef = dynamic_cast<ImageRef*>(ref);
+	if (imageRef) {
+		if (propertyID != kEdsPropID_FocalLength) {
+			return EDS_ERR_PROPERTIES_UNAVAILABLE;
+		}
+		if (size < sizeof(imageRef->focalLength)) {
+			return EDS_ERR_INVALID_LENGTH;
+		}
+		memcpy(data, imageRef->focalLength, sizeof(imageRef->focalLength));
+		return EDS_ERR_OK;
+	}
+
+	auto camera = dynamic_cast<Camera*>(ref);
+	if (!camera) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	auto & state = getState();
+	unique_lock<mutex> lock(state.stateMutex);
+	if (camera->disconnected) {
+		return EDS_ERR_COMM_DISCONNECTED;
+	}
+
+	auto findString = camera->strings.find(propertyID);
+	if (findString != camera->strings.end()) {
+		memset(data, 0, size);
+		memcpy(data, findString->second.c_str(), min((size_t) size, findString->second.size()));
+		return EDS_ERR_OK;
+	}
+
+	auto findValue = camera->values.find(propertyID);
+	if (findValue != camera->values.end()) {
+		if (size < sizeof(EdsUInt32)) {
+			return EDS_ERR_INVALID_LENGTH;
+		}
+		memcpy(data, &findValue->second, sizeof(EdsUInt32));
+		return EDS_ERR_OK;
+	}
+
+	return EDS_ERR_PROPERTIES_UNAVAILABLE;
+}
+
+//----------
+EdsError EDSAPI EdsSetPropertyData(EdsBaseRef ref, EdsPropertyID propertyID, EdsInt32, EdsUInt32 size, const EdsVoid * data) {
+	auto camera = dynamic_cast<Camera*>(ref);
+	if (!camera) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if (!data) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	auto & state = getState();
+	simulateLatency(getSettings().commandLatency);
+
+	unique_lock<mutex> lock(state.stateMutex);
+	if (camera->disconnected) {
+		return EDS_ERR_COMM_DISCONNECTED;
+	}
+	if (!camera->sessionOpen) {
+		return EDS_ERR_SESSION_NOT_OPEN;
+	}
+	if (injectFailure(state, state.settings.propertyFailureRate)) {
+		return EDS_ERR_DEVICE_BUSY;
+	}
+
+	auto findString = camera->strings.find(propertyID);
+	if (findString != camera->strings.end()) {
+		findString->second = string((const char *) data, strnlen((const char *) data, size));
+	}
+	else {
+		if (size < sizeof(EdsUInt32)) {
+			return EDS_ERR_INVALID_LENGTH;
+		}
+		EdsUInt32 value;
+		memcpy(&value, data, sizeof(EdsUInt32));
+
+		// Only values in the property description are accepted
+		auto findDescription = camera->descriptions.find(propertyID);
+		if (findDescription != camera->descriptions.end()) {
+			const auto & options = findDescription->second;
+			if (find(options.begin(), options.end(), (EdsInt32) value) == options.end()) {
+				return EDS_ERR_INVALID_PARAMETER;
+			}
+		}
+
+		auto & currentValue = camera->values[propertyID];
+		if (currentValue == value) {
+			return EDS_ERR_OK;
+		}
+		currentValue = value;
+	}
+
+	schedulePropertyEvent(state, camera, kEdsPropertyEvent_PropertyChanged, propertyID);
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsGetPropertyDesc(EdsBaseRef ref, EdsPropertyID propertyID, EdsPropertyDesc * description) {
+	auto camera = dynamic_cast<Camera*>(ref);
+	if (!camera) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if (!description) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	auto & state = getState();
+	unique_lock<mutex> lock(state.stateMutex);
+	if (camera->disconnected) {
+		return EDS_ERR_COMM_DISCONNECTED;
+	}
+
+	memset(description, 0, sizeof(EdsPropertyDesc));
+	auto findDescription = camera->descriptions.find(propertyID);
+	if (findDescription != camera->descriptions.end()) {
+		const auto & options = findDescription->second;
+		description->numElements = (EdsInt32) min(options.size(), (size_t) 128);
+		copy(options.begin(), options.begin() + description->numElements, description->propDesc);
+	}
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsGetCameraList(EdsCameraListRef * cameraListRef) {
+	if (!cameraListRef) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	auto & state = getState();
+	unique_lock<mutex> lock(state.stateMutex);
+	auto cameraList = new CameraList();
+	for (auto camera : state.cameras) {
+		EdsRetain(camera);
+		cameraList->cameras.push_back(camera);
+	}
+	*cameraListRef = cameraList;
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsGetDeviceInfo(EdsCameraRef ref, EdsDeviceInfo * deviceInfo) {
+	auto camera = dynamic_cast<Camera*>(ref);
+	if (!camera) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if (!deviceInfo) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	memset(deviceInfo, 0, sizeof(EdsDeviceInfo));
+	auto description = "Canon EOS Simulator " + ofToString(camera->index);
+	auto port = "SIM" + ofToString(camera->index);
+	strncpy(deviceInfo->szDeviceDescription, description.c_str(), EDS_MAX_NAME - 1);
+	strncpy(deviceInfo->szPortName, port.c_str(), EDS_MAX_NAME - 1);
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsOpenSession(EdsCameraRef ref) {
+	auto camera = dynamic_cast<Camera*>(ref);
+	if (!camera) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	auto & state = getState();
+	unique_lock<mutex> lock(state.stateMutex);
+	if (camera->disconnected) {
+		return EDS_ERR_COMM_DISCONNECTED;
+	}
+	if (camera->sessionOpen) {
+		return EDS_ERR_SESSION_ALREADY_OPEN;
+	}
+	camera->sessionOpen = true;
+
+	// Like a real camera, announce the current state of everything once the session opens
+	for (const auto & value : camera->values) {
+		schedulePropertyEvent(state, camera, kEdsPropertyEvent_PropertyChanged, value.first);
+	}
+	for (const auto & string : camera->strings) {
+		schedulePropertyEvent(state, camera, kEdsPropertyEvent_PropertyChanged, string.first);
+	}
+	for (const auto & description : camera->descriptions) {
+		schedulePropertyEvent(state, camera, kEdsPropertyEvent_PropertyDescChanged, description.first);
+	}
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsCloseSession(EdsCameraRef ref) {
+	auto camera = dynamic_cast<Camera*>(ref);
+	if (!camera) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	auto & state = getState();
+	unique_lock<mutex> lock(state.stateMutex);
+	if (!camera->sessionOpen) {
+		return EDS_ERR_SESSION_NOT_OPEN;
+	}
+	camera->sessionOpen = false;
+	camera->shutterHeld = false;
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsSendCommand(EdsCameraRef ref, EdsCameraCommand command, EdsInt32 parameter) {
+	auto camera = dynamic_cast<Camera*>(ref);
+	if (!camera) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	auto & state = getState();
+	simulateLatency(getSettings().commandLatency);
+
+	unique_lock<mutex> lock(state.stateMutex);
+	state.stats.commandsReceived++;
+	if (camera->disconnected) {
+		return EDS_ERR_COMM_DISCONNECTED;
+	}
+	if (!camera->sessionOpen) {
+		return EDS_ERR_SESSION_NOT_OPEN;
+	}
+	if (injectFailure(state, state.settings.commandFailureRate)) {
+		return EDS_ERR_DEVICE_BUSY;
+	}
+
+	switch (command) {
+	case kEdsCameraCommand_TakePicture:
+		scheduleCapture(state, camera, state.settings.captureLatency);
+		break;
+	case kEdsCameraCommand_PressShutterButton:
+		switch (parameter) {
+		case kEdsCameraCommand_ShutterButton_Completely:
+		case kEdsCameraCommand_ShutterButton_Completely_NonAF:
+			if (camera->values[kEdsPropID_DriveMode] == 0x00) {
+				// Single shot
+				scheduleCapture(state, camera, state.settings.captureLatency);
+			}
+			else if (!camera->shutterHeld) {
+				// Continuous shooting, keep capturing until the button is released
+				camera->shutterHeld = true;
+				scheduleBurstCapture(state, camera, state.settings.captureLatency);
+			}
+			break;
+		case kEdsCameraCommand_ShutterButton_OFF:
+			camera->shutterHeld = false;
+			break;
+		default:
+			break;
+		}
+		break;
+	default:
+		// e.g. kEdsCameraCommand_ExtendShutDownTimer
+		break;
+	}
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsSendStatusCommand(EdsCameraRef ref, EdsCameraStatusCommand, EdsInt32) {
+	auto camera = dynamic_cast<Camera*>(ref);
+	if (!camera) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	auto & state = getState();
+	unique_lock<mutex> lock(state.stateMutex);
+	if (camera->disconnected) {
+		return EDS_ERR_COMM_DISCONNECTED;
+	}
+	return camera->sessionOpen ? EDS_ERR_OK : EDS_ERR_SESSION_NOT_OPEN;
+}
+
+//----------
+EdsError EDSAPI EdsSetCapacity(EdsCameraRef ref, EdsCapacity) {
+	return EdsSendStatusCommand(ref, kEdsCameraStatusCommand_UILock, 0);
+}
+
+//----------
+EdsError EDSAPI EdsGetDirectoryItemInfo(EdsDirectoryItemRef ref, EdsDirectoryItemInfo * info) {
+	auto directoryItem = dynamic_cast<DirectoryItem*>(ref);
+	if (!directoryItem) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if (!info) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	memset(info, 0, sizeof(EdsDirectoryItemInfo));
+	info->size = directoryItem->file.data->size();
+	info->isFolder = false;
+	strncpy(info->szFileName, directoryItem->file.name.c_str(), EDS_MAX_NAME - 1);
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsDeleteDirectoryItem(EdsDirectoryItemRef ref) {
+	return dynamic_cast<DirectoryItem*>(ref) ? EDS_ERR_OK : EDS_ERR_INVALID_HANDLE;
+}
+
+//----------
+EdsError EDSAPI EdsDownload(EdsDirectoryItemRef ref, EdsUInt64 readSize, EdsStreamRef streamRef) {
+	auto directoryItem = dynamic_cast<DirectoryItem*>(ref);
+	auto stream = dynamic_cast<Stream*>(streamRef);
+	if (!directoryItem || !stream) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	auto & state = getState();
+	{
+		auto settings = getSettings();
+		auto transferTime = settings.downloadBytesPerSecond > 0
+			? chrono::duration_cast<Clock::duration>(chrono::duration<double>((double) readSize / settings.downloadBytesPerSecond))
+			: Clock::duration::zero();
+		simulateLatency(settings.downloadLatency + transferTime);
+	}
+
+	{
+		unique_lock<mutex> lock(state.stateMutex);
+		if (directoryItem->camera->disconnected) {
+			return EDS_ERR_COMM_DISCONNECTED;
+		}
+		if (directoryItem->cancelled) {
+			return EDS_ERR_OPERATION_CANCELLED;
+		}
+		if (injectFailure(state, state.settings.downloadFailureRate)) {
+			return EDS_ERR_COMM_DISCONNECTED;
+		}
+	}
+
+	const auto & data = *directoryItem->file.data;
+	if (directoryItem->readPosition + readSize > data.size()) {
+		return EDS_ERR_INVALID_LENGTH;
+	}
+
+	EdsUInt64 written;
+	auto error = stream->write(data.data() + directoryItem->readPosition, readSize, written);
+	directoryItem->readPosition += written;
+
+	if (directoryItem->readPosition == written) {
+		// First chunk, note if this is a JPEG (so the SDK could read its metadata)
+		stream->containsJpeg = data.size() > 2
+			&& (uint8_t) data[0] == 0xFF
+			&& (uint8_t) data[1] == 0xD8;
+	}
+
+	unique_lock<mutex> lock(state.stateMutex);
+	state.stats.bytesDownloaded += written;
+	return error;
+}
+
+//----------
+EdsError EDSAPI EdsDownloadCancel(EdsDirectoryItemRef ref) {
+	auto directoryItem = dynamic_cast<DirectoryItem*>(ref);
+	if (!directoryItem) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	directoryItem->cancelled = true;
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsDownloadComplete(EdsDirectoryItemRef ref) {
+	auto directoryItem = dynamic_cast<DirectoryItem*>(ref);
+	if (!directoryItem) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	return directoryItem->cancelled ? EDS_ERR_OPERATION_CANCELLED : EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsCreateFileStream(const EdsChar * fileName, EdsFileCreateDisposition disposition, EdsAccess access, EdsStreamRef * streamRef) {
+	if (!fileName || !streamRef) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	auto stream = new FileStream();
+	auto error = stream->open(fileName, disposition, access);
+	if (error != EDS_ERR_OK) {
+		delete stream;
+		return error;
+	}
+	*streamRef = stream;
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsCreateMemoryStream(EdsUInt64 bufferSize, EdsStreamRef * streamRef) {
+	if (!streamRef) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+	*streamRef = new MemoryStream(bufferSize);
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsCreateMemoryStreamFromPointer(EdsVoid * userBuffer, EdsUInt64 bufferSize, EdsStreamRef * streamRef) {
+	if (!userBuffer || !streamRef) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+	*streamRef = new MemoryStream((char *) userBuffer, bufferSize);
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsGetPointer(EdsStreamRef streamRef, EdsVoid ** pointer) {
+	auto stream = dynamic_cast<Stream*>(streamRef);
+	if (!stream) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if (!pointer) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+	*pointer = stream->getPointer();
+	return *pointer ? EDS_ERR_OK : EDS_ERR_NOT_SUPPORTED;
+}
+
+//----------
+EdsError EDSAPI EdsRead(EdsStreamRef streamRef, EdsUInt64 readSize, EdsVoid * buffer, EdsUInt64 * readSizeOut) {
+	auto stream = dynamic_cast<Stream*>(streamRef);
+	if (!stream) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if (!buffer || !readSizeOut) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+	return stream->read((char *) buffer, readSize, *readSizeOut);
+}
+
+//----------
+EdsError EDSAPI EdsWrite(EdsStreamRef streamRef, EdsUInt64 writeSize, const EdsVoid * buffer, EdsUInt64 * writtenSize) {
+	auto stream = dynamic_cast<Stream*>(streamRef);
+	if (!stream) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if (!buffer || !writtenSize) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+	return stream->write((const char *) buffer, writeSize, *writtenSize);
+}
+
+//----------
+EdsError EDSAPI EdsSeek(EdsStreamRef streamRef, EdsInt64 offset, EdsSeekOrigin origin) {
+	auto stream = dynamic_cast<Stream*>(streamRef);
+	if (!stream) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	return stream->seek(offset, origin);
+}
+
+//----------
+EdsError EDSAPI EdsGetPosition(EdsStreamRef streamRef, EdsUInt64 * position) {
+	auto stream = dynamic_cast<Stream*>(streamRef);
+	if (!stream) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if (!position) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+	*position = stream->getPosition();
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsGetLength(EdsStreamRef streamRef, EdsUInt64 * length) {
+	auto stream = dynamic_cast<Stream*>(streamRef);
+	if (!stream) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if (!length) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+	*length = stream->getLength();
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsCreateImageRef(EdsStreamRef streamRef, EdsImageRef * imageRef) {
+	auto stream = dynamic_cast<Stream*>(streamRef);
+	if (!stream) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if (!imageRef) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	// Like the SDK on many bodies, we can only read metadata from JPEGs
+	if (!stream->containsJpeg) {
+		return EDS_ERR_FILE_FORMAT_UNRECOGNIZED;
+	}
+	*imageRef = new ImageRef();
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsCreateEvfImageRef(EdsStreamRef streamRef, EdsEvfImageRef * evfImageRef) {
+	auto stream = dynamic_cast<Stream*>(streamRef);
+	if (!stream) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+	if (!evfImageRef) {
+		return EDS_ERR_INVALID_POINTER;
+	}
+
+	auto evfImage = new EvfImage();
+	evfImage->stream = stream;
+	EdsRetain(stream);
+	*evfImageRef = evfImage;
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsDownloadEvfImage(EdsCameraRef ref, EdsEvfImageRef evfImageRef) {
+	auto camera = dynamic_cast<Camera*>(ref);
+	auto evfImage = dynamic_cast<EvfImage*>(evfImageRef);
+	if (!camera || !evfImage) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	auto & state = getState();
+	shared_ptr<vector<char>> frame;
+	{
+		unique_lock<mutex> lock(state.stateMutex);
+		if (camera->disconnected) {
+			return EDS_ERR_COMM_DISCONNECTED;
+		}
+
+		bool liveViewEnabled = camera->values[kEdsPropID_Evf_Mode] != 0
+			&& (camera->values[kEdsPropID_Evf_OutputDevice] & kEdsEvfOutputDevice_PC);
+		if (!liveViewEnabled) {
+			return EDS_ERR_OBJECT_NOTREADY;
+		}
+
+		// A new frame is only available at the live view interval
+		auto now = Clock::now();
+		if (now - camera->lastLiveViewFrame < state.settings.liveViewInterval) {
+			return EDS_ERR_OBJECT_NOTREADY;
+		}
+
+		if (injectFailure(state, state.settings.liveViewFailureRate)) {
+			return EDS_ERR_OBJECT_NOTREADY;
+		}
+
+		camera->lastLiveViewFrame = now;
+		if (state.liveViewPaths.empty()) {
+			frame = makeTestPattern(640, 424, (int) camera->nextLiveViewIndex++);
+		}
+		else {
+			frame = loadFile(state, state.liveViewPaths[camera->nextLiveViewIndex++ % state.liveViewPaths.size()]);
+		}
+		state.stats.liveViewFramesDownloaded++;
+	}
+
+	EdsUInt64 written;
+	evfImage->stream->seek(0, kEdsSeek_Begin);
+	return evfImage->stream->write(frame->data(), frame->size(), written);
+}
+
+//----------
+EdsError EDSAPI EdsSetPropertyEventHandler(EdsCameraRef ref, EdsPropertyEvent eventType, EdsPropertyEventHandler handler, EdsVoid * context) {
+	auto camera = dynamic_cast<Camera*>(ref);
+	if (!camera) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	auto & state = getState();
+	unique_lock<mutex> lock(state.stateMutex);
+	camera->propertyEventType = eventType;
+	camera->propertyEventHandler = handler;
+	camera->propertyEventContext = context;
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsSetObjectEventHandler(EdsCameraRef ref, EdsObjectEvent eventType, EdsObjectEventHandler handler, EdsVoid * context) {
+	auto camera = dynamic_cast<Camera*>(ref);
+	if (!camera) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	auto & state = getState();
+	unique_lock<mutex> lock(state.stateMutex);
+	camera->objectEventType = eventType;
+	camera->objectEventHandler = handler;
+	camera->objectEventContext = context;
+	return EDS_ERR_OK;
+}
+
+//----------
+EdsError EDSAPI EdsSetCameraStateEventHandler(EdsCameraRef ref, EdsStateEvent eventType, EdsStateEventHandler handler, EdsVoid * context) {
+	auto camera = dynamic_cast<Camera*>(ref);
+	if (!camera) {
+		return EDS_ERR_INVALID_HANDLE;
+	}
+
+	auto & state = getState();
+	unique_lock<mutex> lock(state.stateMutex);
+	camera->stateEventType = eventType;
+	camera->stateEventHandler = handler;
+	camera->stateEventContext = context;
+	return EDS_ERR_OK;
+}
+
+#endif
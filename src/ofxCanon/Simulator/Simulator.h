@@ -0,0 +1,76 @@
+#pragma once
+
+#include "../EDSDK_include.h"
+
+#include <string>
+#include <chrono>
+
+#ifdef OFXCANON_SIMULATOR
+
+namespace ofxCanon {
+	/*
+		Controls for the simulated EDSDK (build with OFXCANON_SIMULATOR defined).
+
+		The simulator presents a set of cameras which behave like EDSDK devices :
+			* Property values and descriptions for ISO, aperture, shutter speed, lens, battery and owner info
+			* Property / object / state events, delivered to the handlers set with EdsSet...EventHandler
+			* Captures which produce downloadable directory items (cycling through files in sampleFolder)
+			* Live view frames (cycling through JPEGs in liveViewFolder)
+
+		If no sample files are found, a generated test pattern (BMP) is used instead.
+
+		Events are dispatched from the simulator's own thread (like the EDSDK does via the OS message loop),
+		unless dispatchEventsInThread is false, in which case they are dispatched whenever EdsGetEvent() is called.
+	*/
+	namespace Simulator {
+		struct Settings {
+			int cameraCount = 1;
+
+			std::string sampleFolder; // photos returned by captures (e.g. .JPG, .CR2, .CR3)
+			std::string liveViewFolder; // live view frames (.jpg), defaults to sampleFolder
+
+			bool dispatchEventsInThread = true;
+
+			// Latencies
+			std::chrono::milliseconds commandLatency{ 5 }; // time for EdsSendCommand / EdsSetPropertyData to return
+			std::chrono::milliseconds captureLatency{ 200 }; // from shutter to the directory item being ready
+			std::chrono::milliseconds downloadLatency{ 10 }; // fixed cost per EdsDownload call
+			double downloadBytesPerSecond = 40e6; // 0 for unlimited
+			std::chrono::milliseconds liveViewInterval{ 33 }; // a new frame becomes available at this interval
+			std::chrono::milliseconds eventLatency{ 1 }; // from a change until its event is dispatched
+			std::chrono::milliseconds burstInterval{ 100 }; // between captures whilst the shutter is held in a continuous drive mode
+
+			// Failure injection (probability 0...1 for each call)
+			float commandFailureRate = 0.0f; // EdsSendCommand returns EDS_ERR_DEVICE_BUSY
+			float propertyFailureRate = 0.0f; // EdsSetPropertyData returns EDS_ERR_DEVICE_BUSY
+			float downloadFailureRate = 0.0f; // EdsDownload returns EDS_ERR_COMM_DISCONNECTED
+			float liveViewFailureRate = 0.0f; // EdsDownloadEvfImage returns EDS_ERR_OBJECT_NOTREADY
+			float captureFailureRate = 0.0f; // capture produces kEdsStateEvent_CaptureError instead of a photo
+
+			unsigned int randomSeed = 0;
+		};
+
+		struct Stats {
+			uint64_t commandsReceived = 0;
+			uint64_t capturesCompleted = 0;
+			uint64_t bytesDownloaded = 0;
+			uint64_t liveViewFramesDownloaded = 0;
+			uint64_t eventsDispatched = 0;
+			uint64_t failuresInjected = 0;
+		};
+
+		// Call before listing devices (changing cameraCount or folders rebuilds the cameras)
+		void setSettings(const Settings &);
+		Settings getSettings();
+
+		Stats getStats();
+
+		// Simulate things happening on the camera body
+		void pressShutter(int cameraIndex); // e.g. photo taken with the camera's own button (unrequested photo)
+		void changeProperty(int cameraIndex, EdsPropertyID, EdsUInt32 value);
+		void sendStateEvent(int cameraIndex, EdsStateEvent, EdsUInt32 parameter = 0);
+		void disconnect(int cameraIndex); // subsequent calls fail with EDS_ERR_COMM_DISCONNECTED
+	}
+}
+
+#endif
@@ -319,11 +319,69 @@ namespace ofxCanon {
 	}
 
 	//----------
+	// Encoding tables are sorted by encoded value at compile time (and a copy sorted by value
+	// is also made at compile time), so that lookups in either direction are binary searches.
+	// Encodings below 256 (i.e. all but 0xffffffff) are also indexed directly for decoding.
 	template<typename RawType>
-	RawType decode(const map<EdsUInt32, RawType> & encodings, EdsUInt32 encoded) {
-		auto findIterator = encodings.find(encoded);
-		if (findIterator != encodings.end()) {
-			return findIterator->second;
+	struct Encoding {
+		EdsUInt32 encoded;
+		RawType value;
+	};
+
+	template<typename RawType, size_t Size>
+	struct EncodingTable {
+		Encoding<RawType> byEncoded[Size];
+		Encoding<RawType> byValue[Size]; // equal values keep the lowest encoding first
+		RawType byEncodedIndex[256]; // value for each encoding below 256, 0 (the error value) if there isn't one
+
+		constexpr size_t size() const {
+			return Size;
+		}
+	};
+
+	//----------
+	template<typename RawType, size_t Size>
+	constexpr EncodingTable<RawType, Size> makeEncodingTable(const Encoding<RawType>(&encodings)[Size]) {
+		EncodingTable<RawType, Size> table{};
+
+		// insertion sorts (stable, so that ties keep the order from the previous sort)
+		for (size_t i = 0; i < Size; i++) {
+			auto encoding = encodings[i];
+			auto j = i;
+			for (; j > 0 && table.byEncoded[j - 1].encoded > encoding.encoded; j--) {
+				table.byEncoded[j] = table.byEncoded[j - 1];
+			}
+			table.byEncoded[j] = encoding;
+
+			if (encoding.encoded < 256) {
+				table.byEncodedIndex[encoding.encoded] = encoding.value;
+			}
+		}
+		for (size_t i = 0; i < Size; i++) {
+			auto encoding = table.byEncoded[i];
+			auto j = i;
+			for (; j > 0 && table.byValue[j - 1].value > encoding.value; j--) {
+				table.byValue[j] = table.byValue[j - 1];
+			}
+			table.byValue[j] = encoding;
+		}
+
+		return table;
+	}
+
+	//----------
+	template<typename RawType, size_t Size>
+	RawType decode(const EncodingTable<RawType, Size> & table, EdsUInt32 encoded) {
+		if (encoded < 256) {
+			return table.byEncodedIndex[encoded];
+		}
+
+		auto end = table.byEncoded + Size;
+		auto findIterator = lower_bound(table.byEncoded, end, encoded, [](const Encoding<RawType> & encoding, EdsUInt32 encoded) {
+			return encoding.encoded < encoded;
+		});
+		if (findIterator != end && findIterator->encoded == encoded) {
+			return findIterator->value;
 		}
 		else {
 			//error value
@@ -332,222 +390,277 @@ namespace ofxCanon {
 	}
 
 	//----------
-	template<typename RawType>
-	EdsUInt32 encode(const map<EdsUInt32, RawType> & encodings, RawType value) {
-		for (auto & encodedIterator : encodings) {
-			if (encodedIterator.second == value) {
-				return encodedIterator.first;
+	template<typename RawType, size_t Size>
+	EdsUInt32 encode(const EncodingTable<RawType, Size> & table, RawType value, bool findClosest) {
+		auto begin = table.byValue;
+		auto end = table.byValue + Size;
+		auto compare = [](const Encoding<RawType> & encoding, RawType value) {
+			return encoding.value < value;
+		};
+
+		// first entry which is >= value (i.e. lowest encoding for an exact match)
+		auto upper = lower_bound(begin, end, value, compare);
+		if (upper != end && upper->value == value) {
+			return upper->encoded;
+		}
+
+		if (!findClosest) {
+			//error value
+			return 0xffffffff;
+		}
+
+		// nearest value (ties go to the lower value)
+		// value 0 entries are skipped, since they aren't a setting to round to (ISO Auto, Bulb, the invalid aperture)
+		auto isSetting = [](const Encoding<RawType> & encoding) {
+			return encoding.value != 0 && encoding.encoded != 0xffffffff;
+		};
+		const Encoding<RawType> * closest = nullptr;
+		if (upper != begin) {
+			auto lower = upper - 1;
+			while (lower != begin && !isSetting(*lower)) {
+				lower--;
 			}
+			if (isSetting(*lower)) {
+				closest = lower;
+			}
+		}
+		while (upper != end && !isSetting(*upper)) {
+			upper++;
+		}
+		if (upper != end && (!closest || upper->value - value < value - closest->value)) {
+			closest = upper;
+		}
+		if (!closest) {
+			return 0xffffffff;
 		}
 
-		//error value
-		return 0xffffffff;
+		// lowest encoding with that value
+		return lower_bound(begin, end, closest->value, compare)->encoded;
 	}
 
 	//----------
-	const map<EdsUInt32, int> & getISOEncodings() {
-		static map<EdsUInt32, int> ISOEncodings;
-		if (ISOEncodings.empty()) {
-			ISOEncodings[0x00000000] = 0;
-			ISOEncodings[0x00000040] = 50;
-			ISOEncodings[0x00000048] = 100;
-			ISOEncodings[0x0000004b] = 125;
-			ISOEncodings[0x0000004d] = 160;
-			ISOEncodings[0x00000050] = 200;
-			ISOEncodings[0x00000053] = 250;
-			ISOEncodings[0x00000055] = 320;
-			ISOEncodings[0x00000058] = 400;
-			ISOEncodings[0x0000005b] = 500;
-			ISOEncodings[0x0000005d] = 640;
-			ISOEncodings[0x00000060] = 800;
-			ISOEncodings[0x00000063] = 1000;
-			ISOEncodings[0x00000065] = 1250;
-			ISOEncodings[0x00000068] = 1600;
-			ISOEncodings[0x0000006b] = 2000;
-			ISOEncodings[0x0000006d] = 2500;
-			ISOEncodings[0x00000070] = 3200;
-			ISOEncodings[0x00000073] = 4000;
-			ISOEncodings[0x00000075] = 5000;
-			ISOEncodings[0x00000078] = 6400;
-			ISOEncodings[0x0000007b] = 8000;
-			ISOEncodings[0x0000007d] = 10000;
-			ISOEncodings[0x00000080] = 12800;
-			ISOEncodings[0x00000088] = 25600;
-			ISOEncodings[0x00000090] = 51200;
-			ISOEncodings[0x00000098] = 102400;
-			ISOEncodings[0x000000a0] = 204800;
-			ISOEncodings[0x000000a8] = 409600;
+	template<typename RawType, size_t Size>
+	map<EdsUInt32, RawType> toMap(const EncodingTable<RawType, Size> & table) {
+		map<EdsUInt32, RawType> encodings;
+		for (const auto & encoding : table.byEncoded) {
+			encodings[encoding.encoded] = encoding.value;
 		}
-		return ISOEncodings;
+		return encodings;
+	}
+
+	//----------
+	constexpr Encoding<int> ISOEncodingList[] = {
+		{ 0x00000000, 0 },
+		{ 0x00000040, 50 },
+		{ 0x00000048, 100 },
+		{ 0x0000004b, 125 },
+		{ 0x0000004d, 160 },
+		{ 0x00000050, 200 },
+		{ 0x00000053, 250 },
+		{ 0x00000055, 320 },
+		{ 0x00000058, 400 },
+		{ 0x0000005b, 500 },
+		{ 0x0000005d, 640 },
+		{ 0x00000060, 800 },
+		{ 0x00000063, 1000 },
+		{ 0x00000065, 1250 },
+		{ 0x00000068, 1600 },
+		{ 0x0000006b, 2000 },
+		{ 0x0000006d, 2500 },
+		{ 0x00000070, 3200 },
+		{ 0x00000073, 4000 },
+		{ 0x00000075, 5000 },
+		{ 0x00000078, 6400 },
+		{ 0x0000007b, 8000 },
+		{ 0x0000007d, 10000 },
+		{ 0x00000080, 12800 },
+		{ 0x00000088, 25600 },
+		{ 0x00000090, 51200 },
+		{ 0x00000098, 102400 },
+		{ 0x000000a0, 204800 },
+		{ 0x000000a8, 409600 }
+	};
+	constexpr auto ISOEncodings = makeEncodingTable(ISOEncodingList);
+
+	//----------
+	const map<EdsUInt32, int> & getISOEncodings() {
+		static const auto encodings = toMap(ISOEncodings);
+		return encodings;
 	}
 
 	//----------
 	int decodeISO(EdsUInt32 isoEncoded) {
-		return decode(getISOEncodings(), isoEncoded);
+		return decode(ISOEncodings, isoEncoded);
 	}
 
 	//----------
-	EdsUInt32 encodeISO(int isoValue) {
-		return encode(getISOEncodings(), isoValue);
+	EdsUInt32 encodeISO(int isoValue, bool findClosest) {
+		return encode(ISOEncodings, isoValue, findClosest);
 	}
 
 #pragma warning (disable : 4305)
+	//----------
+	constexpr Encoding<float> ApertureEncodingList[] = {
+		{ 0x08, 1 },
+		{ 0x0B, 1.1 },
+		{ 0x0C, 1.2 },
+		{ 0x0D, 1.2 }, // thirds
+		{ 0x10, 1.4 },
+		{ 0x13, 1.6 },
+		{ 0x14, 1.8 },
+		{ 0x15, 1.8 }, // thirds
+		{ 0x18, 2 },
+		{ 0x1B, 2.2 },
+		{ 0x1C, 2.5 },
+		{ 0x1D, 2.5 }, // thirds
+		{ 0x20, 2.8 },
+		{ 0x23, 3.2 },
+		{ 0x24, 3.5 },
+		{ 0x25, 3.5 }, // thirds
+		{ 0x28, 4 },
+		{ 0x2B, 4.5 },
+		{ 0x2C, 4.5 }, // thirds
+		{ 0x2D, 5.0 },
+		{ 0x30, 5.6 },
+		{ 0x33, 6.3 },
+		{ 0x34, 6.7 },
+		{ 0x35, 7.1 },
+		{ 0x38, 8 },
+		{ 0x3B, 9 },
+		{ 0x3C, 9.5 },
+		{ 0x3D, 10 },
+		{ 0x40, 11 },
+		{ 0x43, 13 },
+		{ 0x44, 13 }, // thirds
+		{ 0x45, 14 },
+		{ 0x48, 16 },
+		{ 0x4B, 18 },
+		{ 0x4C, 19 },
+		{ 0x4D, 20 },
+		{ 0x50, 22 },
+		{ 0x53, 25 },
+		{ 0x54, 27 },
+		{ 0x55, 29 },
+		{ 0x58, 32 },
+		{ 0x5B, 36 },
+		{ 0x5C, 38 },
+		{ 0x5D, 40 },
+		{ 0x60, 45 },
+		{ 0x63, 51 },
+		{ 0x64, 54 },
+		{ 0x65, 57 },
+		{ 0x68, 64 },
+		{ 0x6B, 72 },
+		{ 0x6C, 76 },
+		{ 0x6D, 80 },
+		{ 0x70, 91 },
+		{ 0xffffffff, 0 }
+	};
+#pragma warning (default: 4305)
+	constexpr auto ApertureEncodings = makeEncodingTable(ApertureEncodingList);
+
 	//----------
 	const std::map<EdsUInt32, float> & getApertureEncodings() {
-		static map<EdsUInt32, float> ApertureEncodings;
-		if (ApertureEncodings.empty()) {
-			ApertureEncodings[0x08] = 1;
-			ApertureEncodings[0x0B] = 1.1;
-			ApertureEncodings[0x0C] = 1.2;
-			ApertureEncodings[0x0D] = 1.2; // thirds
-			ApertureEncodings[0x10] = 1.4;
-			ApertureEncodings[0x13] = 1.6;
-			ApertureEncodings[0x14] = 1.8;
-			ApertureEncodings[0x15] = 1.8; // thirds
-			ApertureEncodings[0x18] = 2;
-			ApertureEncodings[0x1B] = 2.2;
-			ApertureEncodings[0x1C] = 2.5;
-			ApertureEncodings[0x1D] = 2.5; // thirds
-			ApertureEncodings[0x20] = 2.8;
-			ApertureEncodings[0x23] = 3.2;
-			ApertureEncodings[0x24] = 3.5;
-			ApertureEncodings[0x25] = 3.5; // thirds
-			ApertureEncodings[0x28] = 4;
-			ApertureEncodings[0x2B] = 4.5;
-			ApertureEncodings[0x2C] = 4.5; // thirds
-			ApertureEncodings[0x2D] = 5.0;
-			ApertureEncodings[0x30] = 5.6;
-			ApertureEncodings[0x33] = 6.3;
-			ApertureEncodings[0x34] = 6.7;
-			ApertureEncodings[0x35] = 7.1;
-			ApertureEncodings[0x38] = 8;
-			ApertureEncodings[0x3B] = 9;
-			ApertureEncodings[0x3C] = 9.5;
-			ApertureEncodings[0x3D] = 10;
-			ApertureEncodings[0x40] = 11;
-			ApertureEncodings[0x43] = 13;
-			ApertureEncodings[0x44] = 13; // thirds
-			ApertureEncodings[0x45] = 14;
-			ApertureEncodings[0x48] = 16;
-			ApertureEncodings[0x4B] = 18;
-			ApertureEncodings[0x4C] = 19;
-			ApertureEncodings[0x4D] = 20;
-			ApertureEncodings[0x50] = 22;
-			ApertureEncodings[0x53] = 25;
-			ApertureEncodings[0x54] = 27;
-			ApertureEncodings[0x55] = 29;
-			ApertureEncodings[0x58] = 32;
-			ApertureEncodings[0x5B] = 36;
-			ApertureEncodings[0x5C] = 38;
-			ApertureEncodings[0x5D] = 40;
-			ApertureEncodings[0x60] = 45;
-			ApertureEncodings[0x63] = 51;
-			ApertureEncodings[0x64] = 54;
-			ApertureEncodings[0x65] = 57;
-			ApertureEncodings[0x68] = 64;
-			ApertureEncodings[0x6B] = 72;
-			ApertureEncodings[0x6C] = 76;
-			ApertureEncodings[0x6D] = 80;
-			ApertureEncodings[0x70] = 91;
-			ApertureEncodings[0xffffffff] = 0;
-		}
-		return ApertureEncodings;
+		static const auto encodings = toMap(ApertureEncodings);
+		return encodings;
 	}
-#pragma warning (default: 4305)
 
 	//----------
 	float decodeAperture(EdsUInt32 apertureEncoded) {
-		return decode(getApertureEncodings(), apertureEncoded);
+		return decode(ApertureEncodings, apertureEncoded);
 	}
 
 	//----------
-	EdsUInt32 encodeAperture(float apertureValue) {
-		return encode(getApertureEncodings(), apertureValue);
+	EdsUInt32 encodeAperture(float apertureValue, bool findClosest) {
+		return encode(ApertureEncodings, apertureValue, findClosest);
 	}
 
 #pragma warning (disable : 4305)
+	//----------
+	constexpr Encoding<float> ShutterSpeedEncodingList[] = {
+		{ 0x0C, 0 },
+		{ 0x10, 30 },
+		{ 0x13, 25 },
+		{ 0x14, 20 },
+		{ 0x15, 20.3 },
+		{ 0x18, 15 },
+		{ 0x1B, 13 },
+		{ 0x1C, 10 },
+		{ 0x1D, 10.3 },
+		{ 0x20, 8 },
+		{ 0x23, 6.3 },
+		{ 0x24, 6 },
+		{ 0x25, 5 },
+		{ 0x28, 4 },
+		{ 0x2B, 3.2 },
+		{ 0x2C, 3 },
+		{ 0x2D, 2.5 },
+		{ 0x30, 2 },
+		{ 0x33, 1.6 },
+		{ 0x34, 1.5 },
+		{ 0x35, 1.3 },
+		{ 0x38, 1 },
+		{ 0x3B, 0.8 },
+		{ 0x3C, 0.7 },
+		{ 0x3D, 0.6 },
+		{ 0x40, 0.5 },
+		{ 0x43, 0.4 },
+		{ 0x44, 0.3 },
+		{ 0x45, 0.33 },
+		{ 0x48, 1.0 / 4.0 },
+		{ 0x4B, 1.0 / 5.0 },
+		{ 0x4D, 1.0 / 6.0 }, // discovered empirically
+		{ 0x53, 1.0 / 10.0 }, // discovered empirically
+		{ 0x55, 1.0 / 13.0 }, // discovered empirically
+		{ 0x5D, 1.0 / 25.0 },
+		{ 0x60, 1.0 / 30.0 },
+		{ 0x63, 1.0 / 40.0 },
+		{ 0x64, 1.0 / 45.0 },
+		{ 0x65, 1.0 / 50.0 },
+		{ 0x68, 1.0 / 60.0 },
+		{ 0x6B, 1.0 / 80.0 },
+		{ 0x6C, 1.0 / 90.0 },
+		{ 0x6D, 1.0 / 100.0 },
+		{ 0x70, 1.0 / 125.0 },
+		{ 0x73, 1.0 / 160.0 },
+		{ 0x74, 1.0 / 180.0 },
+		{ 0x75, 1.0 / 200.0 },
+		{ 0x78, 1.0 / 250.0 },
+		{ 0x7B, 1.0 / 320.0 },
+		{ 0x7C, 1.0 / 350.0 },
+		{ 0x7D, 1.0 / 400.0 },
+		{ 0x80, 1.0 / 500.0 },
+		{ 0x83, 1.0 / 640.0 },
+		{ 0x84, 1.0 / 750.0 },
+		{ 0x85, 1.0 / 800.0 },
+		{ 0x88, 1.0 / 1000.0 },
+		{ 0x8B, 1.0 / 1250.0 },
+		{ 0x8C, 1.0 / 1500.0 },
+		{ 0x8D, 1.0 / 1600.0 },
+		{ 0x90, 1.0 / 2000.0 },
+		{ 0x93, 1.0 / 2500.0 },
+		{ 0x94, 1.0 / 3000.0 },
+		{ 0x95, 1.0 / 3200.0 },
+		{ 0x98, 1.0 / 4000.0 },
+		{ 0x9B, 1.0 / 5000.0 }
+	};
+#pragma warning (default: 4305)
+	constexpr auto ShutterSpeedEncodings = makeEncodingTable(ShutterSpeedEncodingList);
+
 	//----------
 	const std::map<EdsUInt32, float> & getShutterSpeedEncodings() {
-		static map<EdsUInt32, float> ShutterSpeedEncodings;
-		if (ShutterSpeedEncodings.empty()) {
-			ShutterSpeedEncodings[0x0C] = 0;
-			ShutterSpeedEncodings[0x10] = 30;
-			ShutterSpeedEncodings[0x13] = 25;
-			ShutterSpeedEncodings[0x14] = 20;
-			ShutterSpeedEncodings[0x15] = 20.3;
-			ShutterSpeedEncodings[0x18] = 15;
-			ShutterSpeedEncodings[0x1B] = 13;
-			ShutterSpeedEncodings[0x1C] = 10;
-			ShutterSpeedEncodings[0x1D] = 10.3;
-			ShutterSpeedEncodings[0x20] = 8;
-			ShutterSpeedEncodings[0x23] = 6.3;
-			ShutterSpeedEncodings[0x24] = 6;
-			ShutterSpeedEncodings[0x25] = 5;
-			ShutterSpeedEncodings[0x28] = 4;
-			ShutterSpeedEncodings[0x2B] = 3.2;
-			ShutterSpeedEncodings[0x2C] = 3;
-			ShutterSpeedEncodings[0x2D] = 2.5;
-			ShutterSpeedEncodings[0x30] = 2;
-			ShutterSpeedEncodings[0x33] = 1.6;
-			ShutterSpeedEncodings[0x34] = 1.5;
-			ShutterSpeedEncodings[0x35] = 1.3;
-			ShutterSpeedEncodings[0x38] = 1;
-			ShutterSpeedEncodings[0x3B] = 0.8;
-			ShutterSpeedEncodings[0x3C] = 0.7;
-			ShutterSpeedEncodings[0x3D] = 0.6;
-			ShutterSpeedEncodings[0x40] = 0.5;
-			ShutterSpeedEncodings[0x43] = 0.4;
-			ShutterSpeedEncodings[0x44] = 0.3;
-			ShutterSpeedEncodings[0x45] = 0.33;
-			ShutterSpeedEncodings[0x48] = 1.0 / 4.0;
-			ShutterSpeedEncodings[0x4B] = 1.0 / 5.0;
-			ShutterSpeedEncodings[0x4D] = 1.0 / 6.0; // discovered empirically
-			ShutterSpeedEncodings[0x53] = 1.0 / 10.0; // discovered empirically
-			ShutterSpeedEncodings[0x55] = 1.0 / 13.0; // discovered empirically
-			ShutterSpeedEncodings[0x5D] = 1.0 / 25.0;
-			ShutterSpeedEncodings[0x60] = 1.0 / 30.0;
-			ShutterSpeedEncodings[0x63] = 1.0 / 40.0;
-			ShutterSpeedEncodings[0x64] = 1.0 / 45.0;
-			ShutterSpeedEncodings[0x65] = 1.0 / 50.0;
-			ShutterSpeedEncodings[0x68] = 1.0 / 60.0;
-			ShutterSpeedEncodings[0x6B] = 1.0 / 80.0;
-			ShutterSpeedEncodings[0x6C] = 1.0 / 90.0;
-			ShutterSpeedEncodings[0x6D] = 1.0 / 100.0;
-			ShutterSpeedEncodings[0x70] = 1.0 / 125.0;
-			ShutterSpeedEncodings[0x73] = 1.0 / 160.0;
-			ShutterSpeedEncodings[0x74] = 1.0 / 180.0;
-			ShutterSpeedEncodings[0x75] = 1.0 / 200.0;
-			ShutterSpeedEncodings[0x78] = 1.0 / 250.0;
-			ShutterSpeedEncodings[0x7B] = 1.0 / 320.0;
-			ShutterSpeedEncodings[0x7C] = 1.0 / 350.0;
-			ShutterSpeedEncodings[0x7D] = 1.0 / 400.0;
-			ShutterSpeedEncodings[0x80] = 1.0 / 500.0;
-			ShutterSpeedEncodings[0x83] = 1.0 / 640.0;
-			ShutterSpeedEncodings[0x84] = 1.0 / 750.0;
-			ShutterSpeedEncodings[0x85] = 1.0 / 800.0;
-			ShutterSpeedEncodings[0x88] = 1.0 / 1000.0;
-			ShutterSpeedEncodings[0x8B] = 1.0 / 1250.0;
-			ShutterSpeedEncodings[0x8C] = 1.0 / 1500.0;
-			ShutterSpeedEncodings[0x8D] = 1.0 / 1600.0;
-			ShutterSpeedEncodings[0x90] = 1.0 / 2000.0;
-			ShutterSpeedEncodings[0x93] = 1.0 / 2500.0;
-			ShutterSpeedEncodings[0x94] = 1.0 / 3000.0;
-			ShutterSpeedEncodings[0x95] = 1.0 / 3200.0;
-			ShutterSpeedEncodings[0x98] = 1.0 / 4000.0;
-			ShutterSpeedEncodings[0x9B] = 1.0 / 5000.0;
-		}
-		return ShutterSpeedEncodings;
+		static const auto encodings = toMap(ShutterSpeedEncodings);
+		return encodings;
 	}
-#pragma warning (default: 4305)
 
 	//----------
 	float decodeShutterSpeed(EdsUInt32 shutterSpeedEncoded) {
-		return decode(getShutterSpeedEncodings(), shutterSpeedEncoded);
+		return decode(ShutterSpeedEncodings, shutterSpeedEncoded);
 	}
 
 	//----------
-	EdsUInt32 encodeShutterSpeed(float shutterSpeedValue) {
-		return encode(getShutterSpeedEncodings(), shutterSpeedValue);
+	EdsUInt32 encodeShutterSpeed(float shutterSpeedValue, bool findClosest) {
+		return encode(ShutterSpeedEncodings, shutterSpeedValue, findClosest);
 	}
 
 	//----------
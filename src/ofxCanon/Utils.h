@@ -35,13 +35,22 @@ namespace ofxCanon {
 	std::string propertyToString(EdsPropertyID);
 	std::string cameraCommandToString(EdsCameraCommand);
 
+	//--
+	// Encodings
+	//--
+	//
+	// The encode / decode functions are safe to call from any thread.
+	// With findClosest, encode returns the encoding of the nearest known value rather than failing.
+	//--
+
+
 	//--
 	// ISO
 	//--
 	//
 	const std::map<EdsUInt32, int> & getISOEncodings();
 	int decodeISO(EdsUInt32 isoEncoded);
-	EdsUInt32 encodeISO(int isoValue);
+	EdsUInt32 encodeISO(int isoValue, bool findClosest = false);
 	//
 	// Notes:
 	//	* Returns 0xffffffff : 0 if no setting available
@@ -55,7 +64,7 @@ namespace ofxCanon {
 	//
 	const std::map<EdsUInt32, float> & getApertureEncodings();
 	float decodeAperture(EdsUInt32 apertureEncoded);
-	EdsUInt32 encodeAperture(float apertureValue);
+	EdsUInt32 encodeAperture(float apertureValue, bool findClosest = false);
 	//
 	// Notes :
 	//	* Returns 0xffffffff : 0 if no setting available
@@ -69,7 +78,7 @@ namespace ofxCanon {
 	//
 	const std::map<EdsUInt32, float> & getShutterSpeedEncodings();
 	float decodeShutterSpeed(EdsUInt32 shutterSpeedEncoded);
-	EdsUInt32 encodeShutterSpeed(float shutterSpeedValue);
+	EdsUInt32 encodeShutterSpeed(float shutterSpeedValue, bool findClosest = false);
 	//
 	// Notes:
 	//	* Returns 0xffffffff : 0 if no setting available
@@ -79,6 +88,12 @@ namespace ofxCanon {
 	float rationalToFloat(EdsRational);
 	std::shared_ptr<ofBuffer> getBuffer(EdsStreamRef);
 
+	// For timing stats, e.g. toMilliseconds(end - start)
+	template<typename DurationType>
+	float toMilliseconds(const DurationType & duration) {
+		return (float) std::chrono::duration_cast<std::chrono::microseconds>(duration).count() / 1000.0f;
+	}
+
 	class FramerateCounter {
 	public:
 		void update();
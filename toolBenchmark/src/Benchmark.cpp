@@ -0,0 +1,217 @@
+#include "Benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+
+#if defined(_WIN32)
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+	#include <psapi.h>
+#elif defined(__APPLE__)
+	#include <mach/mach.h>
+#else
+	#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace Benchmark {
+#pragma mark Options
+	//----------
+	Options::Options(const vector<string> & arguments) {
+		for (const auto & argument : arguments) {
+			if (argument.size() > 2 && argument.compare(0, 2, "--") == 0) {
+				auto equals = argument.find('=');
+				if (equals == string::npos) {
+					this->values[argument.substr(2)] = "1";
+				}
+				else {
+					this->values[argument.substr(2, equals - 2)] = argument.substr(equals + 1);
+				}
+			}
+			else {
+				this->files.push_back(argument);
+			}
+		}
+	}
+
+	//----------
+	bool Options::has(const string & name) const {
+		return this->values.find(name) != this->values.end();
+	}
+
+	//----------
+	int Options::getInt(const string & name, int defaultValue) const {
+		auto findValue = this->values.find(name);
+		return findValue == this->values.end()
+			? defaultValue
+			: atoi(findValue->second.c_str());
+	}
+
+	//----------
+	float Options::getFloat(const string & name, float defaultValue) const {
+		auto findValue = this->values.find(name);
+		return findValue == this->values.end()
+			? defaultValue
+			: (float) atof(findValue->second.c_str());
+	}
+
+	//----------
+	string Options::getString(const string & name, const string & defaultValue) const {
+		auto findValue = this->values.find(name);
+		return findValue == this->values.end()
+			? defaultValue
+			: findValue->second;
+	}
+
+	//----------
+	const vector<string> & Options::getFiles() const {
+		return this->files;
+	}
+
+#pragma mark Timings
+	//----------
+	void Timings::add(Clock::duration duration) {
+		this->milliseconds.push_back((float) chrono::duration_cast<chrono::microseconds>(duration).count() / 1000.0f);
+	}
+
+	//----------
+	size_t Timings::size() const {
+		return this->milliseconds.size();
+	}
+
+	//----------
+	float Timings::getTotal() const {
+		float total = 0.0f;
+		for (auto value : this->milliseconds) {
+			total += value;
+		}
+		return total;
+	}
+
+	//----------
+	float Timings::getMean() const {
+		return this->milliseconds.empty()
+			? 0.0f
+			: this->getTotal() / (float) this->milliseconds.size();
+	}
+
+	//----------
+	float Timings::getPercentile(float percentile) const {
+		if (this->milliseconds.empty()) {
+			return 0.0f;
+		}
+		auto sorted = this->milliseconds;
+		sort(sorted.begin(), sorted.end());
+		auto index = (size_t) (percentile * (float) (sorted.size() - 1) + 0.5f);
+		return sorted[min(index, sorted.size() - 1)];
+	}
+
+#pragma mark Table
+	//----------
+	Table::Table(const vector<string> & header) {
+		this->rows.push_back(header);
+	}
+
+	//----------
+	void Table::addRow(const vector<string> & row) {
+		this->rows.push_back(row);
+	}
+
+	//----------
+	void Table::print() const {
+		vector<size_t> widths;
+		for (const auto & row : this->rows) {
+			widths.resize(max(widths.size(), row.size()), 0);
+			for (size_t i = 0; i < row.size(); i++) {
+				widths[i] = max(widths[i], row[i].size());
+			}
+		}
+
+		for (size_t rowIndex = 0; rowIndex < this->rows.size(); rowIndex++) {
+			const auto & row = this->rows[rowIndex];
+			for (size_t i = 0; i < row.size(); i++) {
+				cout << left << setw(widths[i] + 2) << row[i];
+			}
+			cout << endl;
+
+			if (rowIndex == 0) {
+				size_t totalWidth = 0;
+				for (auto width : widths) {
+					totalWidth += width + 2;
+				}
+				cout << string(totalWidth, '-') << endl;
+			}
+		}
+		cout << endl;
+	}
+
+#pragma mark Utils
+	//----------
+	size_t getMemoryUsage() {
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+			return counters.WorkingSetSize;
+		}
+		return 0;
+#elif defined(__APPLE__)
+		mach_task_basic_info info;
+		mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+		if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) == KERN_SUCCESS) {
+			return info.resident_size;
+		}
+		return 0;
+#else
+		size_t totalPages = 0;
+		size_t residentPages = 0;
+		auto file = fopen("/proc/self/statm", "r");
+		if (!file) {
+			return 0;
+		}
+		if (fscanf(file, "%zu %zu", &totalPages, &residentPages) != 2) {
+			residentPages = 0;
+		}
+		fclose(file);
+		return residentPages * (size_t) sysconf(_SC_PAGESIZE);
+#endif
+	}
+
+	//----------
+	string toString(float value, int precision) {
+		stringstream stream;
+		stream << fixed << setprecision(precision) << value;
+		return stream.str();
+	}
+
+	//----------
+	string toMegabytes(size_t bytes) {
+		return toString((float) bytes / (1024.0f * 1024.0f), 1) + " MB";
+	}
+
+	//----------
+	void fillMosaic(uint16_t * pixels, int width, int height) {
+		// each site of the colour filter passes a different amount of light, which is what the mono debayer corrects
+		const float gains[2][2] = {
+			{ 0.45f, 1.0f } // red, green
+			, { 1.0f, 0.6f } // green, blue
+		};
+
+		uint32_t random = 1;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < width; x++) {
+				random = random * 1664525u + 1013904223u;
+				auto scene = 0.5f + 0.25f * sinf((float) x * 0.003f) + 0.2f * cosf((float) y * 0.005f + (float) x * 0.001f);
+				auto noise = (float) (random >> 24) / 255.0f - 0.5f;
+				pixels[(size_t) y * width + x] = (uint16_t) (scene * gains[y % 2][x % 2] * 12000.0f + noise * 200.0f + 500.0f);
+			}
+		}
+	}
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace Benchmark {
+	typedef std::chrono::high_resolution_clock Clock;
+
+	// Command line arguments after the benchmark name, e.g. --count=20 file1.CR2 file2.CR2
+	class Options {
+	public:
+		Options(const std::vector<std::string> & arguments);
+
+		bool has(const std::string & name) const;
+		int getInt(const std::string & name, int defaultValue) const;
+		float getFloat(const std::string & name, float defaultValue) const;
+		std::string getString(const std::string & name, const std::string & defaultValue) const;
+
+		// Arguments which aren't options (e.g. file paths)
+		const std::vector<std::string> & getFiles() const;
+	protected:
+		std::map<std::string, std::string> values;
+		std::vector<std::string> files;
+	};
+
+	// Durations of repeated runs, reported in milliseconds
+	class Timings {
+	public:
+		void add(Clock::duration);
+		size_t size() const;
+
+		float getTotal() const;
+		float getMean() const;
+		float getPercentile(float) const; // 0...1, e.g. 0.5 for the median
+	protected:
+		std::vector<float> milliseconds;
+	};
+
+	// Prints columns aligned to the widest cell
+	class Table {
+	public:
+		Table(const std::vector<std::string> & header);
+		void addRow(const std::vector<std::string> & row);
+		void print() const;
+	protected:
+		std::vector<std::vector<std::string>> rows;
+	};
+
+	struct Entry {
+		std::string name;
+		std::string description;
+		std::function<void(const Options &)> run;
+	};
+
+	size_t getMemoryUsage(); // resident (working set) bytes of this process, 0 if unknown
+
+	std::string toString(float value, int precision = 2);
+	std::string toMegabytes(size_t bytes);
+
+	// A 14 bit RGGB Bayer mosaic of a smooth scene with sensor noise (the same every time)
+	void fillMosaic(uint16_t * pixels, int width, int height);
+
+	//--
+	// Benchmarks (each in its own file, listed in ofApp.cpp)
+	//--
+	void encodedBuffer(const Options &);
+	void download(const Options &);
+	void encodings(const Options &);
+	void httpClient(const Options &);
+	void monoDebayer(const Options &);
+	void threadScaling(const Options &);
+	void normalize(const Options &);
+	void rawDecoder(const Options &);
+}
@@ -0,0 +1,156 @@
+#include "Benchmark.h"
+
+#include "ofxCanon.h"
+#include "ofxCanon/Simulator/Simulator.h"
+
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace Benchmark {
+	namespace {
+		// A stand-in RAW file (the simulator hands out any sample file's bytes as the photo)
+		void writeSampleFile(const string & path, size_t size) {
+			ofstream file(path, ios::binary);
+			vector<char> chunk(1024 * 1024);
+			for (size_t i = 0; i < chunk.size(); i++) {
+				chunk[i] = (char) (i * 31);
+			}
+			for (size_t offset = 0; offset < size; offset += chunk.size()) {
+				file.write(chunk.data(), min(chunk.size(), size - offset));
+			}
+			if (!file) {
+				throw(runtime_error("Couldn't write sample file " + path));
+			}
+		}
+
+		uint64_t getFileSize(const string & path) {
+			ifstream file(path, ios::binary | ios::ate);
+			return file ? (uint64_t) file.tellg() : 0;
+		}
+
+		struct Mode {
+			string name;
+			ofxCanon::Device::DownloadMode downloadMode;
+		};
+	}
+
+	//----------
+	void download(const Options & options) {
+		auto captureCount = max(options.getInt("count", 10), 1);
+		auto photoSize = (size_t) options.getInt("size", 60) * 1024 * 1024;
+
+		auto folder = ofToDataPath("benchmark", true);
+		auto downloadsFolder = folder + "/downloads";
+		auto sampleFolder = options.getString("samples", "");
+		if (sampleFolder.empty()) {
+			sampleFolder = folder + "/samples";
+			ofDirectory::createDirectory(sampleFolder, false, true);
+			writeSampleFile(sampleFolder + "/IMG_0001.CR2", photoSize);
+		}
+		ofDirectory::createDirectory(downloadsFolder, false, true);
+
+		// Only the transfer itself is slowed down (by --link MB/s, default unlimited) so that the disk is what's measured
+		{
+			ofxCanon::Simulator::Settings settings;
+			settings.sampleFolder = sampleFolder;
+			settings.commandLatency = chrono::milliseconds(0);
+			settings.captureLatency = chrono::milliseconds(0);
+			settings.downloadLatency = chrono::milliseconds(0);
+			settings.downloadBytesPerSecond = (double) options.getFloat("link", 0.0f) * 1e6;
+			ofxCanon::Simulator::setSettings(settings);
+		}
+
+		auto devices = ofxCanon::listDevices();
+		if (devices.empty() || !devices.front()->open()) {
+			throw(runtime_error("Couldn't open the simulated camera"));
+		}
+		auto device = devices.front();
+
+		// DownloadToSink writes each chunk to this file
+		ofstream sinkFile;
+		string sinkPath = downloadsFolder + "/sink.bin";
+		device->setDownloadSink([&](const EdsDirectoryItemInfo & info, const char * data, size_t size, uint64_t offset) {
+			if (offset == 0) {
+				sinkFile.open(sinkPath, ios::binary);
+			}
+			sinkFile.write(data, size);
+			if (offset + size >= info.size) {
+				sinkFile.close();
+			}
+			return !sinkFile.fail();
+		});
+		device->setDownloadFileTemplate("benchmark/downloads/{index}.{ext}");
+
+		vector<Mode> modes = {
+			{ "DownloadToMemory then EncodedBuffer::save", ofxCanon::Device::DownloadMode::DownloadToMemory }
+			, { "DownloadToFile", ofxCanon::Device::DownloadMode::DownloadToFile }
+			, { "DownloadToSink (ofstream)", ofxCanon::Device::DownloadMode::DownloadToSink }
+		};
+
+		cout << "Downloading " << captureCount << " photos from " << sampleFolder << " to disk through the simulated camera" << endl;
+		cout << "Camera thread is the time the camera thread spends on the download (before it can start on the next photo)" << endl;
+		cout << "On disk is until the photo is written (for DownloadToMemory this adds the save afterwards)" << endl << endl;
+
+		Table table({ "Mode", "MB/s to disk", "Camera thread mean ms", "On disk mean ms", "On disk p99 ms", "Failed" });
+		for (const auto & mode : modes) {
+			device->setDownloadMode(mode.downloadMode);
+
+			Timings cameraThreadTimings;
+			Timings onDiskTimings;
+			uint64_t bytesWritten = 0;
+			int failedCount = 0;
+
+			for (int i = 0; i < captureCount; i++) {
+				auto future = device->takePhotoAsync();
+				while (future.wait_for(chrono::milliseconds(1)) != future_status::ready) {
+					device->update();
+				}
+				auto result = future.get();
+				if (!result) {
+					failedCount++;
+					continue;
+				}
+
+				auto downloadDuration = result.timing.downloadCompleted - result.timing.downloadStarted;
+				auto onDiskDuration = downloadDuration;
+				string path;
+
+				switch (mode.downloadMode) {
+				case ofxCanon::Device::DownloadMode::DownloadToMemory:
+				{
+					path = downloadsFolder + "/memory.bin";
+					auto saveStart = ofxCanon::Device::CaptureTiming::Clock::now();
+					result.encodedBuffer->save(path);
+					onDiskDuration += ofxCanon::Device::CaptureTiming::Clock::now() - saveStart;
+					break;
+				}
+				case ofxCanon::Device::DownloadMode::DownloadToFile:
+					path = result.savedFilePath;
+					break;
+				case ofxCanon::Device::DownloadMode::DownloadToSink:
+					path = sinkPath;
+					break;
+				}
+
+				cameraThreadTimings.add(downloadDuration);
+				onDiskTimings.add(onDiskDuration);
+				bytesWritten += getFileSize(path);
+				ofFile::removeFile(path, false);
+			}
+
+			auto seconds = onDiskTimings.getTotal() / 1000.0f;
+			table.addRow({ mode.name
+				, toString(seconds > 0.0f ? (float) bytesWritten / 1e6f / seconds : 0.0f, 1)
+				, toString(cameraThreadTimings.getMean())
+				, toString(onDiskTimings.getMean())
+				, toString(onDiskTimings.getPercentile(0.99f))
+				, to_string(failedCount) });
+		}
+		table.print();
+
+		device->close();
+	}
+}
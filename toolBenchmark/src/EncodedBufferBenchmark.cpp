@@ -0,0 +1,137 @@
+#include "Benchmark.h"
+
+#include "ofxCanon.h"
+#include "ofxCanon/Utils.h"
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+using namespace std;
+
+namespace Benchmark {
+	namespace {
+		// Stands in for EdsDownload, which fills the stream in chunks
+		void downloadStandIn(EdsStreamRef stream, const vector<char> & photo) {
+			const size_t chunkSize = 1024 * 1024;
+			for (size_t offset = 0; offset < photo.size(); offset += chunkSize) {
+				EdsUInt64 written = 0;
+				auto size = min(chunkSize, photo.size() - offset);
+				if (EdsWrite(stream, size, photo.data() + offset, &written) != EDS_ERR_OK) {
+					throw(runtime_error("Couldn't write to memory stream"));
+				}
+			}
+		}
+
+		EdsStreamRef createMemoryStream() {
+			EdsStreamRef stream = NULL;
+			if (EdsCreateMemoryStream(0, &stream) != EDS_ERR_OK) {
+				throw(runtime_error("Couldn't create memory stream"));
+			}
+			return stream;
+		}
+
+		// Stands in for a decoder or disk writer reading the whole photo
+		uint64_t consume(const char * data, size_t size) {
+			uint64_t sum = 0;
+			for (size_t i = 0; i < size; i += 64) {
+				sum += (uint8_t) data[i];
+			}
+			return sum;
+		}
+
+		volatile uint64_t checksum = 0;
+
+		struct Path {
+			string name;
+
+			// Downloads the photo and reads it from wherever this path leaves it, calling whilstHeld
+			// at the point where the most memory is in use. Returns the number of bytes copied.
+			function<size_t(const vector<char> & photo, const function<void()> & whilstHeld)> capture;
+		};
+	}
+
+	//----------
+	void encodedBuffer(const Options & options) {
+		auto captureCount = max(options.getInt("count", 20), 1);
+		auto photoSize = (size_t) options.getInt("size", 60) * 1024 * 1024;
+
+		ofxCanon::Initializer::X();
+
+		vector<char> photo(photoSize);
+		for (size_t i = 0; i < photoSize; i++) {
+			photo[i] = (char) (i * 31);
+		}
+
+		auto downloadPool = make_shared<ofxCanon::BufferPool>();
+
+		vector<Path> paths = {
+			{ "EncodedBuffer over a BufferPool block (Device::download)"
+				, [&](const vector<char> & photo, const function<void()> & whilstHeld) {
+					auto block = downloadPool->acquire(photo.size());
+					EdsStreamRef stream = NULL;
+					if (EdsCreateMemoryStreamFromPointer(block.data.get(), photo.size(), &stream) != EDS_ERR_OK) {
+						throw(runtime_error("Couldn't create memory stream over block"));
+					}
+					auto encodedBuffer = make_shared<ofxCanon::EncodedBuffer>(stream, move(block), downloadPool);
+					downloadStandIn(stream, photo);
+
+					whilstHeld();
+					checksum = checksum + consume(encodedBuffer->getData(), encodedBuffer->size());
+					return (size_t) 0;
+				} }
+			, { "EncodedBuffer over a growing stream"
+				, [](const vector<char> & photo, const function<void()> & whilstHeld) {
+					auto encodedBuffer = make_shared<ofxCanon::EncodedBuffer>(createMemoryStream());
+					downloadStandIn(encodedBuffer->getStream(), photo);
+
+					whilstHeld();
+					checksum = checksum + consume(encodedBuffer->getData(), encodedBuffer->size());
+					return (size_t) 0;
+				} }
+			, { "getBuffer copy (before EncodedBuffer)"
+				, [](const vector<char> & photo, const function<void()> & whilstHeld) {
+					auto stream = createMemoryStream();
+					downloadStandIn(stream, photo);
+					auto buffer = ofxCanon::getBuffer(stream);
+
+					whilstHeld();
+					EdsRelease(stream);
+
+					checksum = checksum + consume(buffer->getData(), buffer->size());
+					return buffer->size();
+				} }
+		};
+
+		cout << "Downloading " << captureCount << " photos of " << toMegabytes(photoSize) << " into a stand-in stream and reading them once" << endl;
+		cout << "Peak extra memory is measured from the start of each capture (so the pool's first block is included)" << endl << endl;
+
+		Table table({ "Path", "Bytes copied / capture", "Peak extra memory", "Mean ms", "p99 ms" });
+		for (const auto & path : paths) {
+			Timings timings;
+			size_t bytesCopied = 0;
+			size_t peakMemory = 0;
+
+			for (int i = 0; i < captureCount; i++) {
+				auto memoryBefore = getMemoryUsage();
+				auto whilstHeld = [&]() {
+					auto memoryNow = getMemoryUsage();
+					if (memoryNow > memoryBefore) {
+						peakMemory = max(peakMemory, memoryNow - memoryBefore);
+					}
+				};
+
+				auto start = Clock::now();
+				bytesCopied += path.capture(photo, whilstHeld);
+				timings.add(Clock::now() - start);
+			}
+
+			table.addRow({ path.name
+				, to_string(bytesCopied / captureCount)
+				, toMegabytes(peakMemory)
+				, toString(timings.getMean())
+				, toString(timings.getPercentile(0.99f)) });
+		}
+		table.print();
+	}
+}
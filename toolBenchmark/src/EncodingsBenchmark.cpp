@@ -0,0 +1,155 @@
+#include "Benchmark.h"
+
+#include "ofxCanon/Utils.h"
+
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+namespace Benchmark {
+	namespace {
+		// The lookups which Utils.cpp used before the compile-time tables : find to decode, linear scan to encode
+		template<typename RawType>
+		RawType mapDecode(const map<EdsUInt32, RawType> & encodings, EdsUInt32 encoded) {
+			auto findIterator = encodings.find(encoded);
+			return findIterator != encodings.end()
+				? findIterator->second
+				: 0;
+		}
+
+		template<typename RawType>
+		EdsUInt32 mapEncode(const map<EdsUInt32, RawType> & encodings, RawType value) {
+			for (auto & encodedIterator : encodings) {
+				if (encodedIterator.second == value) {
+					return encodedIterator.first;
+				}
+			}
+			return 0xffffffff;
+		}
+
+		volatile uint64_t checksum = 0;
+
+		// Calls the function on every input, repeats times over. Returns nanoseconds per call.
+		template<typename InputType, typename Function>
+		float timePerCall(const vector<InputType> & inputs, int repeats, Function && function) {
+			uint64_t sum = 0;
+			auto start = Clock::now();
+			for (int i = 0; i < repeats; i++) {
+				for (const auto & input : inputs) {
+					sum += (uint64_t) function(input);
+				}
+			}
+			auto duration = Clock::now() - start;
+			checksum = checksum + sum;
+			return (float) chrono::duration_cast<chrono::nanoseconds>(duration).count() / (float) (inputs.size() * repeats);
+		}
+
+		template<typename RawType>
+		struct Setting {
+			string name;
+			const map<EdsUInt32, RawType> & encodings;
+			function<RawType(EdsUInt32)> decode;
+			function<EdsUInt32(RawType, bool)> encode;
+		};
+
+		template<typename RawType>
+		void addRows(Table & table, const Setting<RawType> & setting, int repeats) {
+			vector<EdsUInt32> encodedValues;
+			vector<RawType> values;
+			vector<RawType> betweenValues; // not in the table, for the nearest value search
+			for (const auto & encoding : setting.encodings) {
+				encodedValues.push_back(encoding.first);
+				values.push_back(encoding.second);
+				betweenValues.push_back((RawType) ((double) encoding.second * 1.07 + 1.0));
+			}
+
+			// Both sides are called through std::function so that neither is inlined into the loop
+			function<RawType(EdsUInt32)> previousDecode = [&](EdsUInt32 encoded) {
+				return mapDecode(setting.encodings, encoded);
+			};
+			function<EdsUInt32(RawType)> previousEncode = [&](RawType value) {
+				return mapEncode(setting.encodings, value);
+			};
+
+			auto mapDecodeTime = timePerCall(encodedValues, repeats, [&](EdsUInt32 encoded) {
+				return previousDecode(encoded);
+			});
+			auto tableDecodeTime = timePerCall(encodedValues, repeats, [&](EdsUInt32 encoded) {
+				return setting.decode(encoded);
+			});
+			auto mapEncodeTime = timePerCall(values, repeats, [&](RawType value) {
+				return previousEncode(value);
+			});
+			auto tableEncodeTime = timePerCall(values, repeats, [&](RawType value) {
+				return setting.encode(value, false);
+			});
+			auto tableClosestTime = timePerCall(betweenValues, repeats, [&](RawType value) {
+				return setting.encode(value, true);
+			});
+
+			table.addRow({ setting.name + " decode", toString(mapDecodeTime), toString(tableDecodeTime), toString(mapDecodeTime / tableDecodeTime) + "x" });
+			table.addRow({ setting.name + " encode", toString(mapEncodeTime), toString(tableEncodeTime), toString(mapEncodeTime / tableEncodeTime) + "x" });
+			table.addRow({ setting.name + " encode closest", "-", toString(tableClosestTime), "" });
+		}
+	}
+
+	//----------
+	void encodings(const Options & options) {
+		auto repeats = max(options.getInt("repeats", 20000), 1);
+		auto threadCount = max(options.getInt("threads", (int) thread::hardware_concurrency()), 1);
+
+		Setting<int> iso{ "ISO"
+			, ofxCanon::getISOEncodings()
+			, [](EdsUInt32 encoded) { return ofxCanon::decodeISO(encoded); }
+			, [](int value, bool findClosest) { return ofxCanon::encodeISO(value, findClosest); } };
+		Setting<float> aperture{ "Aperture"
+			, ofxCanon::getApertureEncodings()
+			, [](EdsUInt32 encoded) { return ofxCanon::decodeAperture(encoded); }
+			, [](float value, bool findClosest) { return ofxCanon::encodeAperture(value, findClosest); } };
+		Setting<float> shutterSpeed{ "Shutter speed"
+			, ofxCanon::getShutterSpeedEncodings()
+			, [](EdsUInt32 encoded) { return ofxCanon::decodeShutterSpeed(encoded); }
+			, [](float value, bool findClosest) { return ofxCanon::encodeShutterSpeed(value, findClosest); } };
+
+		cout << "Each lookup is repeated " << repeats << " times over every entry in the table" << endl << endl;
+
+		{
+			Table table({ "Lookup", "std::map ns/call", "Tables ns/call", "Speed-up" });
+			addRows(table, iso, repeats);
+			addRows(table, aperture, repeats);
+			addRows(table, shutterSpeed, repeats);
+			table.print();
+		}
+
+		// The tables have no lazy initialisation, so they can be used from many threads at once
+		{
+			vector<EdsUInt32> encodedValues;
+			for (const auto & encoding : shutterSpeed.encodings) {
+				encodedValues.push_back(encoding.first);
+			}
+
+			vector<float> nanosecondsPerCall(threadCount);
+			vector<thread> threads;
+			for (int i = 0; i < threadCount; i++) {
+				threads.emplace_back([&, i]() {
+					nanosecondsPerCall[i] = timePerCall(encodedValues, repeats, [&](EdsUInt32 encoded) {
+						return shutterSpeed.encode(shutterSpeed.decode(encoded), true);
+					});
+				});
+			}
+			for (auto & thread : threads) {
+				thread.join();
+			}
+
+			float mean = 0.0f;
+			for (auto value : nanosecondsPerCall) {
+				mean += value / (float) threadCount;
+			}
+
+			Table table({ "Threads", "Shutter speed decode + encode closest ns/call (per thread)" });
+			table.addRow({ to_string(threadCount), toString(mean) });
+			table.print();
+		}
+	}
+}
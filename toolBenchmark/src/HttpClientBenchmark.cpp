@@ -0,0 +1,81 @@
+#include "Benchmark.h"
+
+#include "ofMain.h"
+#include "ofxCanon/HttpClient.h"
+#include "ofxCanon/CustomRequest.h"
+
+#include <iostream>
+#include <stdexcept>
+
+using namespace std;
+
+namespace Benchmark {
+	namespace {
+		struct Path {
+			string name;
+			function<ofHttpResponse()> request;
+			ofxCanon::HttpClient * client; // for the connection count (nullptr if the path opens a connection per request)
+		};
+	}
+
+	//----------
+	void httpClient(const Options & options) {
+		auto requestCount = max(options.getInt("count", 500), 1);
+		auto baseURL = options.getString("url", "http://127.0.0.1:8080/ccapi/ver100/");
+		auto settingURL = baseURL + "shooting/settings/iso";
+
+		nlohmann::json putBody;
+		putBody["value"] = "100";
+
+		{
+			auto response = ofLoadURL(baseURL + "deviceinformation");
+			if (response.status != 200) {
+				throw(runtime_error("Couldn't reach a CCAPI server at " + baseURL + " (start toolCCAPIStub/ccapiStub.py, or pass --url=http://camera:8080/ccapi/ver100/)"));
+			}
+		}
+
+		ofxCanon::HttpClient getClient;
+		ofxCanon::HttpClient putClient;
+
+		vector<Path> paths = {
+			{ "ofLoadURL GET (before HttpClient)"
+				, [&]() { return ofLoadURL(settingURL); }
+				, nullptr }
+			, { "HttpClient GET"
+				, [&]() { return getClient.get(settingURL); }
+				, &getClient }
+			, { "sendCustomRequest PUT (before HttpClient)"
+				, [&]() { return sendCustomRequest(settingURL, putBody, 5, "PUT"); }
+				, nullptr }
+			, { "HttpClient PUT"
+				, [&]() { return putClient.put(settingURL, putBody.dump()); }
+				, &putClient }
+		};
+
+		cout << "Sending " << requestCount << " requests one after another to " << settingURL << endl << endl;
+
+		Table table({ "Path", "Requests/s", "Mean ms", "p99 ms", "Connections opened", "Failed" });
+		for (const auto & path : paths) {
+			Timings timings;
+			int failedCount = 0;
+
+			for (int i = 0; i < requestCount; i++) {
+				auto start = Clock::now();
+				auto response = path.request();
+				timings.add(Clock::now() - start);
+				if (response.status != 200) {
+					failedCount++;
+				}
+			}
+
+			auto seconds = timings.getTotal() / 1000.0f;
+			table.addRow({ path.name
+				, toString(seconds > 0.0f ? (float) requestCount / seconds : 0.0f, 0)
+				, toString(timings.getMean(), 3)
+				, toString(timings.getPercentile(0.99f), 3)
+				, path.client ? to_string(path.client->getStats().connectionsOpened) : to_string(requestCount)
+				, to_string(failedCount) });
+		}
+		table.print();
+	}
+}
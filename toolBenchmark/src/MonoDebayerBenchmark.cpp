@@ -0,0 +1,217 @@
+#include "Benchmark.h"
+
+#include "ofxMachineVision/Device/Canon.h"
+
+#include <future>
+#include <iostream>
+
+using namespace std;
+
+// Same test as Canon.cpp uses to pick the SSE path of the kernel
+#if defined(__SSE4_1__) || defined(__AVX__) || (defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64)))
+#	define KERNEL_PATH "SSE4.1"
+#else
+#	define KERNEL_PATH "scalar"
+#endif
+
+namespace Benchmark {
+	namespace {
+		enum class BayerColor {
+			Green = 0
+			, Red = 1
+			, Blue = 2
+		};
+
+		BayerColor getBayerColor(int x, int y) {
+			if ((x % 2 == 1 && y % 2 == 0)
+				|| (x % 2 == 0 && y % 2 == 1)) {
+				return BayerColor::Green;
+			}
+			else if (x % 2 == 1) {
+				return BayerColor::Blue;
+			}
+			else {
+				return BayerColor::Red;
+			}
+		}
+
+		// Canon::processRawMono before the fused kernel : every step is a full frame pass with its own temporaries
+		void previousProcessRawMono(const cv::Mat & image, int dilateIterations) {
+			auto width = image.cols;
+			auto height = image.rows;
+
+			//create masks for red, green, blue planes
+			cv::Mat redMask(height, width, CV_8U, cv::Scalar(0));
+			cv::Mat greenMask(height, width, CV_8U, cv::Scalar(0));
+			cv::Mat blueMask(height, width, CV_8U, cv::Scalar(0));
+			{
+				auto redOut = redMask.data;
+				auto greenOut = greenMask.data;
+				auto blueOut = blueMask.data;
+
+				for (int y = 0; y < height; ++y) {
+					for (int x = 0; x < width; ++x) {
+						switch (getBayerColor(x, y)) {
+						case BayerColor::Red:
+							*redOut = 255;
+							break;
+						case BayerColor::Green:
+							*greenOut = 255;
+							break;
+						case BayerColor::Blue:
+							*blueOut = 255;
+							break;
+						}
+
+						redOut++;
+						greenOut++;
+						blueOut++;
+					}
+				}
+			}
+
+			//extract red, green, blue planes
+			cv::Mat redPlane(height, width, CV_16U, cv::Scalar(0));
+			cv::Mat greenPlane(height, width, CV_16U, cv::Scalar(0));
+			cv::Mat bluePlane(height, width, CV_16U, cv::Scalar(0));
+			cv::copyTo(image, redPlane, redMask);
+			cv::copyTo(image, greenPlane, greenMask);
+			cv::copyTo(image, bluePlane, blueMask);
+
+			//dilate the planes
+			{
+				auto crossKernel = cv::getStructuringElement(cv::MORPH_CROSS, cv::Size(3, 3));
+				auto boxKernel = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(3, 3));
+				auto doRed = std::async(std::launch::async, [&]() {
+					cv::dilate(redPlane, redPlane, boxKernel);
+				});
+				auto doGreen = std::async(std::launch::async, [&]() {
+					cv::dilate(greenPlane, greenPlane, crossKernel);
+				});
+				auto doBlue = std::async(std::launch::async, [&]() {
+					cv::dilate(bluePlane, bluePlane, boxKernel);
+				});
+				doRed.wait();
+				doGreen.wait();
+				doBlue.wait();
+			}
+
+			//take local maxima for the color planes
+			for (int i = 0; i < dilateIterations; i++) {
+				auto kernelSize = cv::Size(3, 3);
+				auto doRed = std::async(std::launch::async, [&]() {
+					cv::blur(redPlane, redPlane, kernelSize);
+				});
+				auto doGreen = std::async(std::launch::async, [&]() {
+					cv::blur(greenPlane, greenPlane, kernelSize);
+				});
+				auto doBlue = std::async(std::launch::async, [&]() {
+					cv::blur(bluePlane, bluePlane, kernelSize);
+				});
+				doRed.wait();
+				doGreen.wait();
+				doBlue.wait();
+			}
+
+			//promote resolution to float for each plane
+			cv::Mat redPlaneFloat, greenPlaneFloat, bluePlaneFloat;
+			{
+				auto doRed = std::async(std::launch::async, [&]() {
+					redPlane.convertTo(redPlaneFloat, CV_32F);
+				});
+				auto doGreen = std::async(std::launch::async, [&]() {
+					greenPlane.convertTo(greenPlaneFloat, CV_32F);
+				});
+				auto doBlue = std::async(std::launch::async, [&]() {
+					bluePlane.convertTo(bluePlaneFloat, CV_32F);
+				});
+				doRed.wait();
+				doGreen.wait();
+				doBlue.wait();
+			}
+
+			//create factors as planes
+			cv::Mat redFactor = greenPlaneFloat / redPlaneFloat;
+			cv::Mat blueFactor = greenPlaneFloat / bluePlaneFloat;
+
+			//mask copy the factors back into a combined factor plane
+			cv::Mat factor(height, width, CV_32F, cv::Scalar(1.0f));
+			cv::copyTo(redFactor, factor, redMask);
+			cv::copyTo(blueFactor, factor, blueMask);
+
+			//apply the factor plane and copy back into the original image
+			cv::Mat resultFloat;
+			image.convertTo(resultFloat, CV_32F);
+			resultFloat = resultFloat.mul(factor);
+			resultFloat.convertTo(image, CV_16U);
+		}
+
+		struct Path {
+			string name;
+			function<void(const cv::Mat &)> process;
+		};
+	}
+
+	//----------
+	void monoDebayer(const Options & options) {
+		auto width = max(options.getInt("width", 6000), 2);
+		auto height = max(options.getInt("height", 4000), 2);
+		auto dilateIterations = max(options.getInt("iterations", 2), 0);
+		auto count = max(options.getInt("count", 5), 1);
+		auto threadCount = options.getInt("threads", 0);
+
+		cv::Mat mosaic(height, width, CV_16U);
+		fillMosaic((uint16_t *) mosaic.data, width, height);
+
+		auto previousThreadCount = cv::getNumThreads();
+		if (threadCount > 0) {
+			cv::setNumThreads(threadCount);
+		}
+
+		vector<Path> paths = {
+			{ "Canon::processRawMono (fused " KERNEL_PATH " kernel)"
+				, [&](const cv::Mat & image) {
+					ofxMachineVision::Device::Canon::processRawMono(image, dilateIterations);
+				} }
+			, { "Mask and plane pipeline (before)"
+				, [&](const cv::Mat & image) {
+					previousProcessRawMono(image, dilateIterations);
+				} }
+		};
+
+		cout << "Mono debayering a synthetic " << width << "x" << height << " mosaic with " << dilateIterations << " blur iterations"
+			<< " on " << cv::getNumThreads() << " OpenCV threads, " << count << " times" << endl;
+		cout << "Max difference is against the first path's output (0 means identical)" << endl << endl;
+
+		Table table({ "Path", "Mean ms", "Min ms", "Megapixels/s", "Max difference" });
+		cv::Mat firstResult;
+		for (const auto & path : paths) {
+			Timings timings;
+			cv::Mat result;
+			for (int i = 0; i < count; i++) {
+				result = mosaic.clone();
+				auto start = Clock::now();
+				path.process(result);
+				timings.add(Clock::now() - start);
+			}
+
+			double maxDifference = 0.0;
+			if (firstResult.empty()) {
+				firstResult = result;
+			}
+			else {
+				maxDifference = cv::norm(result, firstResult, cv::NORM_INF);
+			}
+
+			auto mean = timings.getMean();
+			table.addRow({ path.name
+				, toString(mean)
+				, toString(timings.getPercentile(0.0f))
+				, toString(mean > 0.0f ? (float) width * (float) height / 1000.0f / mean : 0.0f, 1)
+				, toString((float) maxDifference, 0) });
+		}
+		table.print();
+
+		cv::setNumThreads(previousThreadCount);
+	}
+}
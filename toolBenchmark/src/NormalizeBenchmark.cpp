@@ -0,0 +1,117 @@
+#include "Benchmark.h"
+
+#include "ofxMachineVision/Device/Canon.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+
+using namespace std;
+
+namespace Benchmark {
+	namespace {
+		typedef ofxMachineVision::Device::Canon::NormalizeMethod NormalizeMethod;
+
+		// Canon::normalize before the histogram : sort every 16th pixel, then multiply every pixel
+		template<typename PixelsType>
+		void previousNormalize(ofPixels_<PixelsType> & pixels, float percentile, float ignoreTop, float normalizeTo) {
+			auto data = pixels.getData();
+
+			std::vector<PixelsType> values;
+			for (size_t i = ignoreTop * (float)pixels.size(); i < pixels.size(); i += 16) {
+				values.push_back(data[i]);
+			}
+
+			std::sort(values.begin(), values.end());
+
+			auto maxValue = values.at(((float)values.size() - 1) * percentile);
+
+			float normFactor = (float)std::numeric_limits<PixelsType>::max() / (float)maxValue * normalizeTo;
+			for (size_t i = 0; i < pixels.size(); i++) {
+				data[i] = (PixelsType)(min((float)data[i] * normFactor, (float)std::numeric_limits<PixelsType>::max()));
+			}
+		}
+
+		template<typename PixelsType>
+		size_t countDifferences(const ofPixels_<PixelsType> & a, const ofPixels_<PixelsType> & b) {
+			size_t count = 0;
+			for (size_t i = 0; i < a.size(); i++) {
+				if (a.getData()[i] != b.getData()[i]) {
+					count++;
+				}
+			}
+			return count;
+		}
+
+		struct Path {
+			string name;
+			bool previous;
+			NormalizeMethod method;
+		};
+
+		template<typename PixelsType>
+		void addRows(Table & table, const string & bitDepth, const ofPixels_<PixelsType> & frame, float percentile, float ignoreTop, int count) {
+			vector<Path> paths = {
+				{ "Sort every 16th pixel (before)", true, NormalizeMethod::Sampled }
+				, { "Histogram (default)", false, NormalizeMethod::Histogram }
+				, { "Exact", false, NormalizeMethod::Exact }
+				, { "Sampled", false, NormalizeMethod::Sampled }
+			};
+
+			ofPixels_<PixelsType> previousResult;
+			for (const auto & path : paths) {
+				Timings timings;
+				ofPixels_<PixelsType> result;
+				for (int i = 0; i < count; i++) {
+					result = frame;
+					auto start = Clock::now();
+					if (path.previous) {
+						previousNormalize(result, percentile, ignoreTop, 1.0f);
+					}
+					else {
+						ofxMachineVision::Device::Canon::normalize(result, percentile, ignoreTop, 1.0f, path.method);
+					}
+					timings.add(Clock::now() - start);
+				}
+
+				if (path.previous) {
+					previousResult = result;
+				}
+
+				table.addRow({ bitDepth
+					, path.name
+					, toString(timings.getMean())
+					, toString(timings.getPercentile(0.0f))
+					, to_string(countDifferences(result, previousResult)) });
+			}
+		}
+	}
+
+	//----------
+	void normalize(const Options & options) {
+		auto width = max(options.getInt("width", 6000), 1);
+		auto height = max(options.getInt("height", 4000), 1);
+		auto count = max(options.getInt("count", 5), 1);
+		auto percentile = ofClamp(options.getFloat("percentile", 0.99f), 0.0f, 0.999f);
+		auto ignoreTop = ofClamp(options.getFloat("ignoreTop", 0.0f), 0.0f, 0.99f);
+
+		ofShortPixels shortPixels;
+		shortPixels.allocate(width, height, 1);
+		fillMosaic(shortPixels.getData(), width, height);
+
+		ofPixels pixels;
+		pixels.allocate(width, height, 1);
+		for (size_t i = 0; i < pixels.size(); i++) {
+			pixels.getData()[i] = (uint8_t)(shortPixels.getData()[i] >> 6); // 14 to 8 bit
+		}
+
+		cout << "Normalizing a " << width << "x" << height << " frame to its " << percentile * 100.0f << "th percentile"
+			<< " on " << cv::getNumThreads() << " OpenCV threads, " << count << " times" << endl;
+		cout << "Pixels different is against the previous sort (Exact uses every pixel, so it can pick a slightly different value)" << endl << endl;
+
+		Table table({ "Pixels", "Method", "Mean ms", "Min ms", "Pixels different" });
+		addRows(table, "8 bit", pixels, percentile, ignoreTop, count);
+		addRows(table, "16 bit", shortPixels, percentile, ignoreTop, count);
+		table.print();
+	}
+}
@@ -0,0 +1,127 @@
+#include "Benchmark.h"
+
+#include "ofxCanon.h"
+#include "ofxCanon/RawDecoder.h"
+#include "FreeImage.h"
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+using namespace std;
+
+namespace Benchmark {
+	namespace {
+		// e.g. "1,4,8"
+		vector<int> parseThreadCounts(const string & text) {
+			vector<int> threadCounts;
+			stringstream stream(text);
+			string item;
+			while (getline(stream, item, ',')) {
+				auto threadCount = atoi(item.c_str());
+				if (threadCount > 0) {
+					threadCounts.push_back(threadCount);
+				}
+			}
+			return threadCounts;
+		}
+
+		string compare(const ofShortPixels & pixels, const ofShortPixels & reference) {
+			if (reference.size() == 0) {
+				return "-";
+			}
+			if (pixels.getWidth() != reference.getWidth() || pixels.getHeight() != reference.getHeight()) {
+				return "size differs (" + to_string(reference.getWidth()) + "x" + to_string(reference.getHeight()) + ")";
+			}
+			size_t differences = 0;
+			for (size_t i = 0; i < pixels.size(); i++) {
+				if (pixels.getData()[i] != reference.getData()[i]) {
+					differences++;
+				}
+			}
+			return differences == 0
+				? "identical"
+				: to_string(differences) + " pixels differ";
+		}
+	}
+
+	//----------
+	void rawDecoder(const Options & options) {
+		const auto & files = options.getFiles();
+		if (files.empty()) {
+			throw(runtime_error("Pass one or more CR2 files, e.g. toolBenchmark rawDecoder IMG_0001.CR2"));
+		}
+
+		auto count = max(options.getInt("count", 5), 1);
+		auto threadCounts = parseThreadCounts(options.getString("threads", "1," + to_string(max(thread::hardware_concurrency(), 1u))));
+		if (threadCounts.empty()) {
+			throw(runtime_error("--threads should be a list of thread counts, e.g. --threads=1,4,8"));
+		}
+		auto useFreeImage = options.getInt("freeImage", 1) != 0;
+
+		cout << "Reading the sensor mosaic from each file " << count << " times, RawDecoder (after one untimed decode to allocate its buffers)"
+			<< (useFreeImage ? " vs loadImage with RAW_UNPROCESSED (FreeImage), comparing the outputs" : "") << endl << endl;
+
+		Table table({ "File", "Decoder", "Threads", "Mean ms", "Min ms", "Megapixels/s", "Output" });
+		for (const auto & file : files) {
+			auto buffer = ofBufferFromFile(file, true);
+			if (buffer.size() == 0) {
+				throw(runtime_error("Couldn't read " + file));
+			}
+			auto name = ofFilePath::getFileName(file);
+
+			// FreeImage first, as the reference
+			ofShortPixels reference;
+			if (useFreeImage) {
+				ofImageLoadSettings imageLoadSettings;
+				imageLoadSettings.freeImageFlags = RAW_UNPROCESSED;
+
+				Timings timings;
+				for (int i = 0; i < count; i++) {
+					auto start = Clock::now();
+					if (!ofxCanon::loadImage(reference, buffer.getData(), buffer.size(), imageLoadSettings)) {
+						throw(runtime_error("FreeImage couldn't load " + file));
+					}
+					timings.add(Clock::now() - start);
+				}
+
+				auto mean = timings.getMean();
+				table.addRow({ name
+					, "loadImage RAW_UNPROCESSED"
+					, "1"
+					, toString(mean)
+					, toString(timings.getPercentile(0.0f))
+					, toString(mean > 0.0f ? (float) reference.size() / 1000.0f / mean : 0.0f, 1)
+					, to_string(reference.getWidth()) + "x" + to_string(reference.getHeight()) });
+			}
+
+			for (auto threadCount : threadCounts) {
+				ofxCanon::RawDecoder decoder(threadCount);
+				if (!decoder.decode(buffer.getData(), buffer.size())) {
+					// e.g. CR3, which falls back to loadImage
+					table.addRow({ name, "RawDecoder", to_string(threadCount), "-", "-", "-", "not supported" });
+					continue;
+				}
+
+				Timings timings;
+				for (int i = 0; i < count; i++) {
+					auto start = Clock::now();
+					decoder.decode(buffer.getData(), buffer.size());
+					timings.add(Clock::now() - start);
+				}
+
+				auto & pixels = decoder.getPixels();
+				auto mean = timings.getMean();
+				table.addRow({ name
+					, "RawDecoder"
+					, to_string(threadCount)
+					, toString(mean)
+					, toString(timings.getPercentile(0.0f))
+					, toString(mean > 0.0f ? (float) pixels.size() / 1000.0f / mean : 0.0f, 1)
+					, compare(pixels, reference) });
+			}
+		}
+		table.print();
+	}
+}
@@ -0,0 +1,77 @@
+#include "Benchmark.h"
+
+#include "ofxMachineVision/Device/Canon.h"
+
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+namespace Benchmark {
+	//----------
+	void threadScaling(const Options & options) {
+		auto width = max(options.getInt("width", 6000), 2);
+		auto height = max(options.getInt("height", 4000), 2);
+		auto dilateIterations = max(options.getInt("iterations", 2), 0);
+		auto count = max(options.getInt("count", 3), 1);
+		auto maxThreadCount = max(options.getInt("threads", (int) thread::hardware_concurrency()), 1);
+
+		cv::Mat mosaic(height, width, CV_16U);
+		fillMosaic((uint16_t *) mosaic.data, width, height);
+
+		ofShortPixels pixels;
+		pixels.allocate(width, height, 1);
+		memcpy(pixels.getData(), mosaic.data, pixels.size() * sizeof(uint16_t));
+
+		// 1, 2, 4 ... up to (and including) the most threads
+		vector<int> threadCounts;
+		for (int threadCount = 1; threadCount < maxThreadCount; threadCount *= 2) {
+			threadCounts.push_back(threadCount);
+		}
+		threadCounts.push_back(maxThreadCount);
+
+		cout << "Mono debayer (" << dilateIterations << " blur iterations) and 16 bit normalize of a synthetic " << width << "x" << height
+			<< " mosaic on OpenCV's thread pool, mean of " << count << " runs" << endl;
+		cout << "Speed-up is against 1 thread (this machine reports " << thread::hardware_concurrency() << " hardware threads)" << endl << endl;
+
+		auto previousThreadCount = cv::getNumThreads();
+
+		Table table({ "Threads", "processRawMono ms", "Speed-up", "normalize ms", "Speed-up" });
+		float singleThreadDebayer = 0.0f;
+		float singleThreadNormalize = 0.0f;
+		for (auto threadCount : threadCounts) {
+			cv::setNumThreads(threadCount);
+
+			Timings debayerTimings;
+			Timings normalizeTimings;
+			for (int i = 0; i < count; i++) {
+				auto image = mosaic.clone();
+				auto start = Clock::now();
+				ofxMachineVision::Device::Canon::processRawMono(image, dilateIterations);
+				debayerTimings.add(Clock::now() - start);
+
+				auto normalizePixels = pixels;
+				start = Clock::now();
+				ofxMachineVision::Device::Canon::normalize(normalizePixels, 0.99f, 0.0f, 1.0f);
+				normalizeTimings.add(Clock::now() - start);
+			}
+
+			auto debayer = debayerTimings.getMean();
+			auto normalize = normalizeTimings.getMean();
+			if (threadCount == 1) {
+				singleThreadDebayer = debayer;
+				singleThreadNormalize = normalize;
+			}
+
+			table.addRow({ to_string(threadCount)
+				, toString(debayer)
+				, toString(debayer > 0.0f ? singleThreadDebayer / debayer : 0.0f) + "x"
+				, toString(normalize)
+				, toString(normalize > 0.0f ? singleThreadNormalize / normalize : 0.0f) + "x" });
+		}
+		table.print();
+
+		cv::setNumThreads(previousThreadCount);
+	}
+}
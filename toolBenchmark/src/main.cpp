@@ -0,0 +1,11 @@
+#include "ofMain.h"
+#include "ofAppNoWindow.h"
+#include "ofApp.h"
+
+//========================================================================
+int main(int argc, char * argv[]) {
+	// No window, the results are printed to the console
+	auto window = make_shared<ofAppNoWindow>();
+	ofRunApp(window, make_shared<ofApp>(vector<string>(argv + 1, argv + argc)));
+	return ofRunMainLoop();
+}
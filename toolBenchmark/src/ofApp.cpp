@@ -0,0 +1,77 @@
+#include "ofApp.h"
+
+//--------------------------------------------------------------
+ofApp::ofApp(const vector<string> & arguments)
+: arguments(arguments) {
+	this->benchmarks = {
+		{ "encodedBuffer"
+			, "Bytes copied and peak memory per capture, EncodedBuffer vs getBuffer. Options : --count=20 --size=60 (MB)"
+			, Benchmark::encodedBuffer }
+		, { "download"
+			, "MB/s to disk for each Device::DownloadMode with a simulated directory item. Options : --count=10 --size=60 (MB) --link=0 (MB/s, 0 for unlimited) --samples=folder"
+			, Benchmark::download }
+		, { "encodings"
+			, "ISO, aperture and shutter speed encode / decode, compile-time tables vs the previous std::map lookups. Options : --repeats=20000 --threads=(all)"
+			, Benchmark::encodings }
+		, { "httpClient"
+			, "Requests/s and latency of CCAPI requests, HttpClient (one kept-alive connection) vs ofLoadURL / sendCustomRequest. Needs a CCAPI server such as toolCCAPIStub. Options : --count=500 --url=http://127.0.0.1:8080/ccapi/ver100/"
+			, Benchmark::httpClient }
+		, { "monoDebayer"
+			, "Canon::processRawMono on a synthetic mosaic, fused kernel vs the previous mask and plane pipeline. Options : --width=6000 --height=4000 --iterations=2 --count=5 --threads=0 (OpenCV's default)"
+			, Benchmark::monoDebayer }
+		, { "threadScaling"
+			, "Time per OpenCV thread count for Canon::processRawMono and Canon::normalize (16 bit), with speed-up against 1 thread. Options : --width=6000 --height=4000 --iterations=2 --count=3 --threads=(all)"
+			, Benchmark::threadScaling }
+		, { "normalize"
+			, "Canon::normalize on 8 and 16 bit frames, each NormalizeMethod vs the previous sort. Options : --width=6000 --height=4000 --count=5 --percentile=0.99 --ignoreTop=0"
+			, Benchmark::normalize }
+		, { "rawDecoder"
+			, "Sensor mosaic from CR2 files, RawDecoder at each thread count vs loadImage with RAW_UNPROCESSED. Options : --count=5 --threads=1,(all) --freeImage=1 files..."
+			, Benchmark::rawDecoder }
+	};
+}
+
+//--------------------------------------------------------------
+void ofApp::setup() {
+	if (this->arguments.empty()) {
+		this->printUsage();
+		ofExit();
+		return;
+	}
+
+	auto name = this->arguments.front();
+	Benchmark::Options options(vector<string>(this->arguments.begin() + 1, this->arguments.end()));
+
+	bool found = false;
+	for (const auto & benchmark : this->benchmarks) {
+		if (name == "all" || name == benchmark.name) {
+			cout << "# " << benchmark.name << endl;
+			try {
+				benchmark.run(options);
+			}
+			catch (const std::exception & e) {
+				cout << "Failed : " << e.what() << endl << endl;
+			}
+			catch (...) {
+				cout << "Failed" << endl << endl;
+			}
+			found = true;
+		}
+	}
+
+	if (!found) {
+		cout << "Unknown benchmark '" << name << "'" << endl << endl;
+		this->printUsage();
+	}
+
+	ofExit();
+}
+
+//--------------------------------------------------------------
+void ofApp::printUsage() const {
+	cout << "Usage : toolBenchmark <name | all> [--option=value ...] [files ...]" << endl << endl;
+	for (const auto & benchmark : this->benchmarks) {
+		cout << benchmark.name << endl
+			<< "\t" << benchmark.description << endl;
+	}
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "ofMain.h"
+#include "Benchmark.h"
+
+/*
+	Runs the benchmarks named on the command line and prints their results, e.g. :
+
+		toolBenchmark encodedBuffer --count=20 --size=60
+
+	Run with no arguments to list the benchmarks and their options.
+	ofxCanon is built against the simulated EDSDK (OFXCANON_SIMULATOR), so no camera is needed.
+*/
+class ofApp : public ofBaseApp {
+public:
+	ofApp(const vector<string> & arguments);
+
+	void setup() override;
+protected:
+	void printUsage() const;
+
+	vector<string> arguments;
+	vector<Benchmark::Entry> benchmarks;
+};
@@ -0,0 +1,414 @@
+#!/usr/bin/env python3
+"""
+Stands in for a camera's CCAPI server so that ofxCanon::RemoteDevice can be tested without a camera.
+
+	serve : answers the requests RemoteDevice makes (device information, settings, shutter, event polling,
+		content download / delete) and replays recorded live view frames on shooting/liveview/scroll.
+		The live view stream can be damaged on purpose to check the parser's resync and RemoteDevice's reconnect :
+			--cut-every=N : every Nth frame is cut short (its end marker never arrives)
+			--drop-every=N : the connection is closed after every N frames
+
+	record : saves the scroll stream of a real camera as a fixture
+
+	synthesize : writes a fixture of numbered test frames (needs the opencv-python package)
+
+A fixture is the scroll stream as the camera sends it (without the HTTP chunking) :
+	0xFF 0x00, type (0x00 = JPEG, 0x01 = info JSON), 4 byte big endian size, data, 0xFF 0xFF
+"""
+
+import argparse
+import http.server
+import json
+import random
+import socketserver
+import struct
+import sys
+import threading
+import time
+import urllib.request
+
+FRAME_START = b"\xff\x00"
+FRAME_END = b"\xff\xff"
+IMAGE_FRAME = 0x00
+INFO_FRAME = 0x01
+
+CCAPI_ROOT = "/ccapi/ver100/"
+CONTENTS_ROOT = "/ccapi/ver100/contents/sd/100CANON/"
+
+
+#----------
+def encode_frame(frame_type, data):
+	return FRAME_START + bytes([frame_type]) + struct.pack(">I", len(data)) + data + FRAME_END
+
+
+#----------
+def decode_frames(stream):
+	"""Splits a fixture into (type, data) pairs, skipping anything which isn't a whole frame."""
+	frames = []
+	position = 0
+	while True:
+		start = stream.find(FRAME_START, position)
+		if start < 0 or start + 7 > len(stream):
+			break
+		frame_type = stream[start + 2]
+		size = struct.unpack(">I", stream[start + 3:start + 7])[0]
+		end = start + 7 + size
+		if stream[end:end + 2] != FRAME_END:
+			position = start + 1
+			continue
+		frames.append((frame_type, stream[start + 7:end]))
+		position = end + 2
+	return frames
+
+
+#--
+# Camera state
+#--
+class Camera:
+	def __init__(self, fixture_frames):
+		self.lock = threading.Condition()
+		self.settings = {
+			"shootingmode": {"value": "m", "ability": ["p", "tv", "av", "m"]},
+			"iso": {"value": "100", "ability": ["auto", "100", "200", "400", "800", "1600", "3200", "6400"]},
+			"av": {"value": "f5.6", "ability": ["f2.8", "f4.0", "f5.6", "f8.0", "f11", "f16"]},
+			"tv": {"value": "1/125", "ability": ["1\"", "0\"5", "1/4", "1/15", "1/30", "1/60", "1/125", "1/250", "1/500", "1/1000"]},
+		}
+		self.pending_events = dict(self.settings) # the first poll reports every setting
+		self.contents = {}
+		self.photo_index = 0
+		self.live_view_size = "off"
+
+		# photos are the first recorded JPEG frame
+		self.photo = next((data for frame_type, data in fixture_frames if frame_type == IMAGE_FRAME), b"")
+
+	#----------
+	def add_event(self, name, value):
+		with self.lock:
+			self.pending_events[name] = value
+			self.lock.notify_all()
+
+	#----------
+	def wait_for_events(self, timeout):
+		with self.lock:
+			self.lock.wait_for(lambda: self.pending_events, timeout)
+			events = self.pending_events
+			self.pending_events = {}
+			return events
+
+	#----------
+	def take_photo(self):
+		with self.lock:
+			self.photo_index += 1
+			name = "IMG_%04d.JPG" % self.photo_index
+			self.contents[name] = self.photo
+		self.add_event("addedcontents", [CONTENTS_ROOT + name])
+
+
+#--
+# HTTP
+#--
+class Handler(http.server.BaseHTTPRequestHandler):
+	protocol_version = "HTTP/1.1"
+	disable_nagle_algorithm = True
+
+	#----------
+	def send_json(self, status, value):
+		body = json.dumps(value).encode()
+		self.send_response(status)
+		self.send_header("Content-Type", "application/json")
+		self.send_header("Content-Length", str(len(body)))
+		self.end_headers()
+		self.wfile.write(body)
+
+	#----------
+	def read_json(self):
+		size = int(self.headers.get("Content-Length") or 0)
+		body = self.rfile.read(size) if size > 0 else b""
+		try:
+			return json.loads(body) if body else {}
+		except ValueError:
+			return None
+
+	#----------
+	def get_setting_name(self):
+		prefix = CCAPI_ROOT + "shooting/settings/"
+		if self.path.startswith(prefix):
+			name = self.path[len(prefix):]
+			if name in self.server.camera.settings:
+				return name
+		return None
+
+	#----------
+	def do_GET(self):
+		camera = self.server.camera
+		path = self.path.split("?")[0]
+
+		if path == CCAPI_ROOT + "deviceinformation":
+			self.send_json(200, {
+				"manufacturer": "Canon Inc.",
+				"productname": "ofxCanon CCAPI stub",
+				"guid": "00000000-0000-0000-0000-000000000000",
+				"serialnumber": "000000000000",
+				"macaddress": "00:00:00:00:00:00",
+				"firmwareversion": "1.0.0",
+			})
+		elif path == CCAPI_ROOT + "event/polling":
+			timeout = self.server.options.poll_timeout if "timeout=long" in self.path else 0.0
+			self.send_json(200, camera.wait_for_events(timeout))
+		elif path == CCAPI_ROOT + "shooting/liveview/scroll":
+			self.send_scroll()
+		elif self.get_setting_name():
+			with camera.lock:
+				self.send_json(200, camera.settings[self.get_setting_name()])
+		elif path.startswith(CONTENTS_ROOT):
+			self.send_content(path[len(CONTENTS_ROOT):])
+		else:
+			self.send_json(404, {"message": "Not found"})
+
+	#----------
+	def do_PUT(self):
+		camera = self.server.camera
+		request = self.read_json()
+		name = self.get_setting_name()
+		if name is None:
+			self.send_json(404, {"message": "Not found"})
+			return
+		with camera.lock:
+			setting = camera.settings[name]
+			if request is None or request.get("value") not in setting["ability"]:
+				self.send_json(400, {"message": "Invalid parameter"})
+				return
+			setting["value"] = request["value"]
+			result = dict(setting)
+		camera.add_event(name, result)
+		self.send_json(200, {"value": result["value"]})
+
+	#----------
+	def do_POST(self):
+		camera = self.server.camera
+		request = self.read_json()
+		if request is None:
+			self.send_json(400, {"message": "Invalid parameter"})
+		elif self.path == CCAPI_ROOT + "shooting/control/shutterbutton":
+			camera.take_photo()
+			self.send_json(200, {})
+		elif self.path == CCAPI_ROOT + "shooting/liveview":
+			camera.live_view_size = request.get("liveviewsize", "off")
+			self.send_json(200, {})
+		else:
+			self.send_json(404, {"message": "Not found"})
+
+	#----------
+	def do_DELETE(self):
+		camera = self.server.camera
+		path = self.path.split("?")[0]
+		name = path[len(CONTENTS_ROOT):] if path.startswith(CONTENTS_ROOT) else None
+		with camera.lock:
+			found = name in camera.contents
+			if found:
+				del camera.contents[name]
+		if found:
+			self.send_json(200, {})
+		else:
+			self.send_json(404, {"message": "Not found"})
+
+	#----------
+	def send_content(self, name):
+		with self.server.camera.lock:
+			data = self.server.camera.contents.get(name)
+		if data is None:
+			self.send_json(404, {"message": "Not found"})
+			return
+
+		# DownloadManager resumes dropped transfers with a Range request
+		start = 0
+		range_header = self.headers.get("Range", "")
+		if range_header.startswith("bytes=") and range_header.endswith("-"):
+			start = min(int(range_header[6:-1]), len(data))
+		self.send_response(206 if start > 0 else 200)
+		self.send_header("Content-Type", "image/jpeg")
+		self.send_header("Content-Length", str(len(data) - start))
+		if start > 0:
+			self.send_header("Content-Range", "bytes %d-%d/%d" % (start, len(data) - 1, len(data)))
+		self.end_headers()
+		self.wfile.write(data[start:])
+
+	#----------
+	def send_scroll(self):
+		camera = self.server.camera
+		options = self.server.options
+		if camera.live_view_size == "off":
+			self.send_json(503, {"message": "Live view not started"})
+			return
+
+		# the camera's response never ends whilst live view is running, so it's sent chunked
+		self.send_response(200)
+		self.send_header("Content-Type", "application/octet-stream")
+		self.send_header("Transfer-Encoding", "chunked")
+		self.end_headers()
+
+		frames = self.server.frames
+		interval = 1.0 / options.fps if options.fps > 0 else 0.0
+		sent = 0
+		index = 0
+		next_time = time.monotonic()
+		try:
+			while camera.live_view_size != "off":
+				frame_type, data = frames[index % len(frames)]
+				index += 1
+				frame = encode_frame(frame_type, data)
+				if frame_type == IMAGE_FRAME:
+					sent += 1
+					if options.cut_every > 0 and sent % options.cut_every == 0:
+						frame = frame[:len(frame) // 2]
+
+				# the camera's chunks don't line up with frames
+				position = 0
+				while position < len(frame):
+					size = random.randint(1, options.max_chunk)
+					chunk = frame[position:position + size]
+					position += size
+					self.wfile.write(b"%x\r\n" % len(chunk) + chunk + b"\r\n")
+				self.wfile.flush()
+
+				if frame_type == IMAGE_FRAME:
+					if options.drop_every > 0 and sent % options.drop_every == 0:
+						self.close_connection = True
+						return # no terminating chunk, so the client sees the stream end early
+					next_time += interval
+					time.sleep(max(next_time - time.monotonic(), 0.0))
+			self.wfile.write(b"0\r\n\r\n")
+		except (BrokenPipeError, ConnectionResetError):
+			self.close_connection = True
+
+	#----------
+	def log_message(self, format, *args):
+		if self.server.options.verbose:
+			super().log_message(format, *args)
+
+
+#----------
+class Server(socketserver.ThreadingMixIn, http.server.HTTPServer):
+	daemon_threads = True
+	allow_reuse_address = True
+
+
+#--
+# Commands
+#--
+#----------
+def serve(options):
+	with open(options.fixture, "rb") as file:
+		frames = decode_frames(file.read())
+	if not any(frame_type == IMAGE_FRAME for frame_type, data in frames):
+		sys.exit("No JPEG frames in " + options.fixture)
+
+	server = Server((options.host, options.port), Handler)
+	server.options = options
+	server.frames = frames
+	server.camera = Camera(frames)
+	print("Serving CCAPI on http://%s:%d%s with %d recorded frames from %s" % (options.host, options.port, CCAPI_ROOT, len(frames), options.fixture), flush=True)
+	try:
+		server.serve_forever()
+	except KeyboardInterrupt:
+		pass
+
+
+#----------
+def record(options):
+	base_url = "http://%s:8080%s" % (options.camera, CCAPI_ROOT)
+
+	request = urllib.request.Request(base_url + "shooting/liveview"
+		, data=json.dumps({"liveviewsize": options.size, "cameradisplay": "on"}).encode()
+		, method="POST")
+	urllib.request.urlopen(request, timeout=5).read()
+
+	stream = bytearray()
+	end_time = time.monotonic() + options.seconds
+	with urllib.request.urlopen(base_url + "shooting/liveview/scroll", timeout=5) as response:
+		while time.monotonic() < end_time:
+			chunk = response.read1(65536)
+			if not chunk:
+				break
+			stream += chunk
+
+	# keep whole frames only (the recording starts and stops mid-frame)
+	frames = decode_frames(bytes(stream))
+	with open(options.fixture, "wb") as file:
+		for frame_type, data in frames:
+			file.write(encode_frame(frame_type, data))
+	print("Recorded %d frames (%d bytes) to %s" % (len(frames), sum(len(data) for _, data in frames), options.fixture))
+
+
+#----------
+def synthesize(options):
+	import cv2
+	import numpy
+
+	width, height = options.width, options.height
+	x = numpy.linspace(0, 255, width, dtype=numpy.float32)
+	y = numpy.linspace(0, 255, height, dtype=numpy.float32)[:, None]
+
+	with open(options.fixture, "wb") as file:
+		for index in range(options.count):
+			# a gradient which moves each frame, with the frame number written on it
+			phase = index * 255.0 / options.count
+			image = numpy.dstack([
+				(x + phase + 0 * y) % 256,
+				(y + phase + 0 * x) % 256,
+				((x + y) / 2 + 2 * phase) % 256,
+			]).astype(numpy.uint8)
+			cv2.putText(image, "%03d" % index, (width // 8, height * 2 // 3), cv2.FONT_HERSHEY_SIMPLEX, height / 80.0, (255, 255, 255), max(height // 40, 1))
+			success, jpeg = cv2.imencode(".jpg", image, [cv2.IMWRITE_JPEG_QUALITY, options.quality])
+			if not success:
+				sys.exit("Couldn't encode frame %d" % index)
+			file.write(encode_frame(IMAGE_FRAME, jpeg.tobytes()))
+
+			if index % 10 == 0:
+				info = {"liveviewdata": {"image": {"width": width, "height": height}}, "frame": index}
+				file.write(encode_frame(INFO_FRAME, json.dumps(info).encode()))
+	print("Wrote %d frames to %s" % (options.count, options.fixture))
+
+
+#----------
+def main():
+	parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+	commands = parser.add_subparsers(dest="command")
+
+	serve_parser = commands.add_parser("serve", help="replay a fixture as a CCAPI camera")
+	serve_parser.add_argument("--host", default="127.0.0.1")
+	serve_parser.add_argument("--port", type=int, default=8080)
+	serve_parser.add_argument("--fps", type=float, default=30.0, help="live view frames per second (0 = as fast as possible)")
+	serve_parser.add_argument("--cut-every", type=int, default=0, help="cut every Nth live view frame short (0 = never)")
+	serve_parser.add_argument("--drop-every", type=int, default=0, help="close the live view connection after every N frames (0 = never)")
+	serve_parser.add_argument("--max-chunk", type=int, default=9000, help="largest HTTP chunk in the live view stream")
+	serve_parser.add_argument("--poll-timeout", type=float, default=2.0, help="seconds a long event poll waits for a change")
+	serve_parser.add_argument("--verbose", action="store_true", help="log every request")
+
+	record_parser = commands.add_parser("record", help="record a fixture from a real camera")
+	record_parser.add_argument("camera", help="hostname or IP address of the camera")
+	record_parser.add_argument("--seconds", type=float, default=5.0)
+	record_parser.add_argument("--size", default="small", help="liveviewsize (small or medium)")
+
+	synthesize_parser = commands.add_parser("synthesize", help="write a fixture of numbered test frames")
+	synthesize_parser.add_argument("--count", type=int, default=30)
+	synthesize_parser.add_argument("--width", type=int, default=320)
+	synthesize_parser.add_argument("--height", type=int, default=212)
+	synthesize_parser.add_argument("--quality", type=int, default=70)
+
+	for command_parser in [serve_parser, record_parser, synthesize_parser]:
+		command_parser.add_argument("--fixture", default=sys.path[0] + "/data/liveview.scroll")
+
+	options = parser.parse_args()
+	if options.command == "record":
+		record(options)
+	elif options.command == "synthesize":
+		synthesize(options)
+	else:
+		if options.command is None:
+			options = serve_parser.parse_args([])
+		serve(options)
+
+
+if __name__ == "__main__":
+	main()
@@ -116,14 +116,20 @@ void ofApp::takePhoto() {
 
 	auto result = future.get();
 	if (result) {
-		ofImageLoadSettings imageLoadSettings;
-		{
-			imageLoadSettings.freeImageFlags = RAW_UNPROCESSED;
+		// Take the sensor mosaic straight from a CR2 where we can, otherwise go through FreeImage
+		if (this->rawDecoder.decode(*result.encodedBuffer)) {
+			this->raw.setFromPixels(this->rawDecoder.getPixels());
 		}
-		ofLoadImage(this->raw.getPixels()
-			, *result.encodedBuffer
-			, imageLoadSettings);
-		ofLoadImage(this->standardProcess
+		else {
+			ofImageLoadSettings imageLoadSettings;
+			{
+				imageLoadSettings.freeImageFlags = RAW_UNPROCESSED;
+			}
+			ofxCanon::loadImage(this->raw.getPixels()
+				, *result.encodedBuffer
+				, imageLoadSettings);
+		}
+		ofxCanon::loadImage(this->standardProcess.getPixels()
 			, *result.encodedBuffer);
 		this->standardProcess.update();
 
@@ -197,14 +203,20 @@ void ofApp::processFile(const string& filename) {
 		return;
 	}
 
-	ofImageLoadSettings imageLoadSettings;
-	{
-		imageLoadSettings.freeImageFlags = RAW_UNPROCESSED;
+	auto fileBuffer = ofBufferFromFile(filename, true);
+	if (this->rawDecoder.decode(fileBuffer.getData(), fileBuffer.size())) {
+		this->raw.setFromPixels(this->rawDecoder.getPixels());
 	}
+	else {
+		ofImageLoadSettings imageLoadSettings;
+		{
+			imageLoadSettings.freeImageFlags = RAW_UNPROCESSED;
+		}
 
-	ofLoadImage(this->raw.getPixels()
-		, filename
-		, imageLoadSettings);
+		ofLoadImage(this->raw.getPixels()
+			, fileBuffer
+			, imageLoadSettings);
+	}
 	ofLoadImage(this->standardProcess
 		, filename);
 
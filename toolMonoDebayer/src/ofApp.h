@@ -24,6 +24,7 @@ public:
 	shared_ptr<ofxCvGui::Panels::Image> standardProcessPanel;
 
 	shared_ptr<ofxCanon::Device> device;
+	ofxCanon::RawDecoder rawDecoder;
 
 	ofxCvGui::Builder gui;
 